@@ -25,8 +25,7 @@ Texture2D tex_material 					: register(t1);
 Texture2D tex_depth 					: register(t2);
 Texture2D tex_ssao 						: register(t3);
 Texture2DArray light_depth_directional 	: register(t4);
-TextureCube light_depth_point 			: register(t5);
-Texture2D light_depth_spot 				: register(t6);
+Texture2D light_depth_atlas 			: register(t5); // point and spot lights
 //=====================================================
 
 //= SAMPLERS ==============================================
@@ -37,9 +36,11 @@ SamplerState samplerLinear_clamp 			: register(s2);
 
 //= BUFFERS =====================================
 #define cascade_count 4
+#define shadow_slice_count 6
 cbuffer LightBuffer : register(b1)
 {
-	matrix 	light_view_projection[cascade_count];
+	matrix 	light_view_projection[shadow_slice_count];	// cascades, cube faces, or just the spot light's
+	float4	shadow_atlas_rect[shadow_slice_count];		// offset and scale of each slice's tile in the shadow atlas
 	float3	color;
 	float	intensity;
 	float3	position;
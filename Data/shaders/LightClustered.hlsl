@@ -0,0 +1,170 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= TEXTURES ===============================
+Texture2D tex_normal 		: register(t0);
+Texture2D tex_material 		: register(t1);
+Texture2D tex_depth 		: register(t2);
+Texture2D tex_ssao 			: register(t3);
+//==========================================
+
+//= SAMPLERS ======================================
+SamplerState sampler_point_clamp 	: register(s0);
+//=================================================
+
+//= BUFFERS ==================================================
+// Has to match Renderer::ClusterLight
+struct ClusterLight
+{
+	float3	color;
+	float	intensity;
+	float3	position;
+	float	range;
+	float3	direction;
+	float	angle;
+	float	is_spot;
+	float3	padding;
+};
+
+StructuredBuffer<uint2> cluster_grid 			: register(t4);	// offset and count into cluster_indices
+StructuredBuffer<uint> cluster_indices 			: register(t5);
+StructuredBuffer<ClusterLight> cluster_lights 	: register(t6);
+
+cbuffer ClusterBuffer : register(b1)
+{
+	uint	cluster_count_x;
+	uint	cluster_count_y;
+	uint	cluster_count_z;
+	uint	cluster_light_count;
+	float	cluster_slice_scale;
+	float	cluster_slice_bias;
+	float2	cluster_padding;
+};
+//============================================================
+
+//= INCLUDES ======
+#include "BRDF.hlsl"
+//=================
+
+struct PixelOutputType
+{
+	float4 diffuse		: SV_Target0;
+	float4 specular		: SV_Target1;
+	float4 volumetric	: SV_Target2;
+};
+
+// Shades all the shadowless point and spot lights that the pixel's cluster (see LightClusters) contains, in a single pass
+PixelOutputType mainPS(Pixel_PosUv input)
+{
+	PixelOutputType light_out;
+	light_out.diffuse 		= float4(0.0f, 0.0f, 0.0f, 0.0f);
+	light_out.specular 		= float4(0.0f, 0.0f, 0.0f, 0.0f);
+	light_out.volumetric 	= float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float2 uv 				= input.uv;
+
+	// Sample textures
+	float4 normal_sample 	= tex_normal.Sample(sampler_point_clamp, uv);
+	float4 material_sample  = tex_material.Sample(sampler_point_clamp, uv);
+	float depth_sample   	= tex_depth.Sample(sampler_point_clamp, uv).r;
+	float ssao_sample 		= tex_ssao.Sample(sampler_point_clamp, uv).r;
+
+	// Ignore sky
+	if (material_sample.a == 0.0f)
+		return light_out;
+
+	float3 normal			= normal_decode(normal_sample.xyz);
+	float occlusion 		= min(normal_sample.w, ssao_sample);
+	float3 position_world 	= get_world_position_from_depth(depth_sample, g_viewProjectionInv, uv);
+	float3 camera_to_pixel  = normalize(position_world - g_camera_position.xyz);
+
+	// Find the cluster
+	float depth_view	= mul(float4(position_world, 1.0f), g_view).z;
+	uint slice			= (uint)clamp(floor(log(depth_view) * cluster_slice_scale + cluster_slice_bias), 0.0f, cluster_count_z - 1.0f);
+	uint tile_x			= min((uint)(uv.x * cluster_count_x), cluster_count_x - 1);
+	uint tile_y			= min((uint)(uv.y * cluster_count_y), cluster_count_y - 1);
+	uint2 cluster		= cluster_grid[(slice * cluster_count_y + tile_y) * cluster_count_x + tile_x];
+
+	// Create material
+	float3 diffuse_color	= float3(1,1,1);
+	Material material;
+	material.roughness		= material_sample.r;
+	material.metallic		= material_sample.g;
+	material.emissive		= material_sample.b;
+	material.F0				= lerp(0.04f, diffuse_color, material.metallic);
+
+	for (uint i = 0; i < cluster.y; i++)
+	{
+		ClusterLight cluster_light = cluster_lights[cluster_indices[cluster.x + i]];
+
+		Light light;
+		light.color 	= cluster_light.color;
+		light.position 	= cluster_light.position;
+		light.direction	= normalize(position_world - light.position);
+		light.intensity = cluster_light.intensity * occlusion;
+		light.range 	= cluster_light.range;
+		light.angle 	= cluster_light.angle;
+
+		// Attenuate, same as Light.hlsl
+		float dist			= length(position_world - light.position);
+		float attenuation	= saturate(1.0f - dist / light.range);
+		if (cluster_light.is_spot)
+		{
+			float cutoff_angle	= 1.0f - light.angle;
+			float theta			= dot(cluster_light.direction, light.direction);
+			float epsilon		= cutoff_angle - cutoff_angle * 0.9f;
+			attenuation			*= saturate((theta - cutoff_angle) / epsilon);
+			light.intensity		*= attenuation * attenuation * step(theta, cutoff_angle);
+		}
+		else
+		{
+			light.intensity *= attenuation * attenuation * step(dist, light.range);
+		}
+
+		// Accumulate total light amount hitting that pixel (used to modulate ssr later)
+		light_out.specular.a += light.intensity;
+
+		if (light.intensity <= 0.0f)
+			continue;
+
+		// Reflectance equation
+		float3 l		= -light.direction;
+		float3 v 		= -camera_to_pixel;
+		float3 h 		= normalize(v + l);
+		float v_dot_h 	= saturate(dot(v, h));
+		float n_dot_v 	= saturate(dot(normal, v));
+		float n_dot_l 	= saturate(dot(normal, l));
+		float n_dot_h 	= saturate(dot(normal, h));
+		float3 radiance	= light.color * light.intensity * n_dot_l;
+
+		// BRDF components
+		float3 F 			= 0.0f;
+		float3 cDiffuse 	= BRDF_Diffuse(diffuse_color, material, n_dot_v, n_dot_l, v_dot_h);
+		float3 cSpecular 	= BRDF_Specular(material, n_dot_v, n_dot_l, n_dot_h, v_dot_h, F);
+
+		// Ensure energy conservation
+		float3 kD = (1.0f - F) * (1.0f - material.metallic);
+
+		light_out.diffuse.rgb	+= kD * cDiffuse * radiance;
+		light_out.specular.rgb	+= cSpecular * radiance;
+	}
+
+	return light_out;
+}
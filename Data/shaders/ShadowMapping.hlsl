@@ -34,14 +34,16 @@ float DepthTest_Directional(float slice, float2 uv, float compare)
 	return light_depth_directional.SampleCmpLevelZero(sampler_cmp_depth, float3(uv, slice), compare).r;
 }
 
-float DepthTest_Point(float3 direction, float compare)
+float DepthTest_Atlas(int slice, float2 uv, float compare)
 {
-	return light_depth_point.SampleCmp(sampler_cmp_depth, direction, compare).r;
-}
-
-float DepthTest_Spot(float2 uv, float compare)
-{
-	return light_depth_spot.SampleCmp(sampler_cmp_depth, uv, compare).r;
+	// Stay half a texel inside the slice's tile, so filtering never reads a neighbouring tile
+	float2 atlas_size;
+	light_depth_atlas.GetDimensions(atlas_size.x, atlas_size.y);
+	float4 rect		= shadow_atlas_rect[slice];
+	float2 inset	= 0.5f / (rect.zw * atlas_size);
+	uv				= rect.xy + clamp(uv, inset, 1.0f - inset) * rect.zw;
+	
+	return light_depth_atlas.SampleCmpLevelZero(sampler_cmp_depth, uv, compare).r;
 }
 
 float random(float2 seed2) 
@@ -75,10 +77,8 @@ float Technique_Poisson(int cascade, float3 uv, float compare, float2 dither)
 
 		#if DIRECTIONAL
 		amountLit 	+= DepthTest_Directional(cascade, uv.xy + (poissonDisk[index] / packing), compare);
-		#elif POINT
-		amountLit 	+= DepthTest_Point(uv, compare);
-		#elif SPOT
-		amountLit 	+= DepthTest_Spot(uv.xy + (poissonDisk[index] / packing), compare);
+		#else
+		amountLit 	+= DepthTest_Atlas(cascade, uv.xy + (poissonDisk[index] / packing), compare);
 		#endif
 	}	
 
@@ -102,8 +102,8 @@ float Technique_PCF_2d(int cascade, float texel, float2 uv, float compare, float
 			
 			#if DIRECTIONAL
 			amountLit 	+= DepthTest_Directional(cascade, uv + offset, compare);
-			#elif SPOT
-			amountLit 	+= DepthTest_Spot(uv + offset, compare);
+			#else
+			amountLit 	+= DepthTest_Atlas(cascade, uv + offset, compare);
 			#endif
 			
 			count++;			
@@ -125,16 +125,25 @@ float ShadowMap_Directional(int cascade, float4 positionCS, float texel, float b
 	return Technique_PCF_2d(cascade, texel, tex_coord, compare_depth, dither);
 }
 
-float ShadowMap_Spot(float4 positionCS, float texel, float3 sample_direction, float bias, float2 dither)
-{	
-	// If the cascade is not covering this pixel, don't sample anything
+float ShadowMap_Atlas(int slice, float4 positionCS, float bias, float2 dither)
+{
+	// Perspective projections, unlike the cascades
+	positionCS.xyz /= positionCS.w;
+
+	// If the slice is not covering this pixel, don't sample anything
 	if( positionCS.x < -1.0f || positionCS.x > 1.0f || 
 		positionCS.y < -1.0f || positionCS.y > 1.0f || 
 		positionCS.z < 0.0f || positionCS.z > 1.0f ) return 1.0f;
-		
+
+	// Texels of the tile, not of the whole atlas
+	float2 atlas_size;
+	light_depth_atlas.GetDimensions(atlas_size.x, atlas_size.y);
+	float texel = 1.0f / (shadow_atlas_rect[slice].z * atlas_size.x);
+
+	float2 tex_coord 	= positionCS.xy * float2(0.5f, -0.5f) + 0.5f;
 	float compare_depth	= positionCS.z + bias;
-	
-	return Technique_PCF_2d(0, texel, sample_direction.xy, compare_depth, dither);
+
+	return Technique_PCF_2d(slice, texel, tex_coord, compare_depth, dither);
 }
 
 float Shadow_Map(float2 uv, float3 normal, float depth, float3 world_pos, float bias, float normal_bias, Light light)
@@ -183,23 +192,24 @@ float Shadow_Map(float2 uv, float3 normal, float depth, float3 world_pos, float
 	}
 	#elif POINT
 	{
-		float3 light_to_pixel_direction	= position_world.xyz - light.position;
-		float light_to_pixel_distance = length(light_to_pixel_direction);
-		light_to_pixel_direction = normalize(light_to_pixel_direction);
+		float3 light_to_pixel = position_world.xyz - light.position;
 		
 		[branch]
-		if (light_to_pixel_distance < light.range)
+		if (length(light_to_pixel) < light.range)
 		{
-			///float depth = light_depth_point.Sample(samplerLinear_clamp, light_to_pixel_direction).r;
-			//shadow = depth < (light_to_pixel_distance / light.range) ? 1.0f : 0.0f;
-
-			float compare = (light_to_pixel_distance / light.range) + bias;
-			return light_depth_point.SampleCmpLevelZero(sampler_cmp_depth, light_to_pixel_direction, compare).r;
+			// The cube face is picked by the major axis, in the order the faces were rendered in (x+, x-, y+, y-, z+, z-)
+			float3 axis = abs(light_to_pixel);
+			int face 	= 0;
+			if (axis.x >= axis.y && axis.x >= axis.z)	face = light_to_pixel.x >= 0.0f ? 0 : 1;
+			else if (axis.y >= axis.z)					face = light_to_pixel.y >= 0.0f ? 2 : 3;
+			else										face = light_to_pixel.z >= 0.0f ? 4 : 5;
+
+			shadow = ShadowMap_Atlas(face, mul(position_world, light_view_projection[face]), bias, dither);
 		}
 	}
 	#elif SPOT
 	{
-		shadow = 1.0f;
+		shadow = ShadowMap_Atlas(0, mul(position_world, light_view_projection[0]), bias, dither);
 	}
 	#endif
 
@@ -93,7 +93,7 @@ namespace ComponentProperty
 			{
 				if (g_copied && g_copied->GetType() == component->GetType())
 				{
-					component->SetAttributes(g_copied->GetAttributes());
+					component->CopyAttributes(g_copied.get());
 				}
 			}
 
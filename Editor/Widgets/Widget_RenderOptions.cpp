@@ -93,6 +93,7 @@ void Widget_RenderOptions::Tick()
         auto do_sharperning             = m_renderer->FlagEnabled(Render_PostProcess_Sharpening);
         auto do_chromatic_aberration    = m_renderer->FlagEnabled(Render_PostProcess_ChromaticAberration);
         auto do_dithering               = m_renderer->FlagEnabled(Render_PostProcess_Dithering);
+        auto do_occlusion_culling       = m_renderer->FlagEnabled(Render_OcclusionCulling);
         auto resolution_shadow          = static_cast<int>(m_renderer->GetShadowResolution());
 
         // Display
@@ -175,6 +176,10 @@ void Widget_RenderOptions::Tick()
 
             // Shadow resolution
             ImGui::InputInt("Shadow Resolution", &resolution_shadow, 1);
+            ImGui::Separator();
+
+            // Occlusion culling
+            ImGui::Checkbox("Occlusion culling", &do_occlusion_culling); tooltip("Skips objects hidden behind large occluders, tested on the CPU");
         }
 
         // Filter input
@@ -202,6 +207,7 @@ void Widget_RenderOptions::Tick()
         set_flag_if(Render_PostProcess_Sharpening,          do_sharperning);
         set_flag_if(Render_PostProcess_ChromaticAberration, do_chromatic_aberration);
         set_flag_if(Render_PostProcess_Dithering,           do_dithering);
+        set_flag_if(Render_OcclusionCulling,                do_occlusion_culling);
     }
 
     if (ImGui::CollapsingHeader("Debug", ImGuiTreeNodeFlags_None))
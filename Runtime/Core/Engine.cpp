@@ -34,6 +34,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Threading/Threading.h"
 #include "../World/World.h"
 #include "../Math/MathHelper.h"
+#include "../IO/FileStream.h"
 //====================================
 
 //= NAMESPACES ===============
@@ -79,6 +80,10 @@ namespace Spartan
 	Engine::~Engine()
 	{
 		EventSystem::Get().Clear(); // this must become a subsystem
+
+		// Subsystems can save on their way out, let those writes reach the disk
+		m_context.reset();
+		FileStream::WaitForWrites();
 	}
 
 	void Engine::Tick()
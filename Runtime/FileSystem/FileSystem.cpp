@@ -284,6 +284,19 @@ namespace Spartan
 		}
 	}
 
+	uint64_t FileSystem::GetFileSize(const string& file_path)
+	{
+		try
+		{
+			return file_size(file_path);
+		}
+		catch (filesystem_error& e)
+		{
+			LOGF_ERROR("%s, %s", e.what(), file_path.c_str());
+			return 0;
+		}
+	}
+
 	string FileSystem::GetFileNameFromFilePath(const string& path)
 	{
 		auto lastindex	= path.find_last_of("\\/");
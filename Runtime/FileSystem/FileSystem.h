@@ -34,6 +34,8 @@ static const char* METADATA_TYPE_TEXTURE	= "Texture";
 static const char* METADATA_TYPE_AUDIOCLIP	= "Audio_Clip";
 // Engine file extensions
 static const char* EXTENSION_WORLD			= ".world";
+static const char* EXTENSION_WORLD_CELL		= ".cell";
+static const char* EXTENSION_WORLD_CELLS	= ".cells";
 static const char* EXTENSION_MATERIAL		= ".mat";
 static const char* EXTENSION_MODEL			= ".model";
 static const char* EXTENSION_PREFAB			= ".prefab";
@@ -61,6 +63,7 @@ namespace Spartan
 		static bool FileExists(const std::string& filePath);
 		static bool DeleteFile_(const std::string& filePath);
 		static bool CopyFileFromTo(const std::string& source, const std::string& destination);
+		static uint64_t GetFileSize(const std::string& filePath);
 		//====================================================================================
 
 		//= DIRECTORY PARSING  =================================================================
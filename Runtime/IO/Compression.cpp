@@ -0,0 +1,272 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========
+#include <cstring>
+#include "Compression.h"
+//=====================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+	static const size_t g_match_length_min	= 4;		// Shorter matches cost more than the literals they replace
+	static const size_t g_literals_last		= 5;		// A block always ends with at least this many literals
+	static const size_t g_match_start_limit	= 12;		// Matches can't start closer than this to the end of a block
+	static const size_t g_offset_max		= 65535;	// Offsets are stored in two bytes
+	static const uint32_t g_hash_bits		= 14;
+	static const size_t g_copy_slack		= 32;		// Room needed past a copy before the decoder can over-copy in fixed steps
+
+	static uint32_t Read32(const uint8_t* p)
+	{
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	static uint32_t Hash(const uint32_t value)
+	{
+		return (value * 2654435761u) >> (32 - g_hash_bits);
+	}
+
+	static bool WriteLength(uint8_t*& destination, const uint8_t* destination_end, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+		{
+			if (destination == destination_end)
+				return false;
+
+			*destination++ = 255;
+		}
+
+		if (destination == destination_end)
+			return false;
+
+		*destination++ = static_cast<uint8_t>(length);
+		return true;
+	}
+
+	// A sequence is a run of literals followed by a match, the last sequence of a block has no match
+	static bool WriteSequence(uint8_t*& destination, const uint8_t* destination_end, const uint8_t* literals, const size_t literal_count, const size_t offset, const size_t match_length)
+	{
+		if (destination == destination_end)
+			return false;
+
+		auto token = destination++;
+		*token = static_cast<uint8_t>((literal_count < 15 ? literal_count : 15) << 4);
+		if (literal_count >= 15 && !WriteLength(destination, destination_end, literal_count - 15))
+			return false;
+
+		if (literal_count > static_cast<size_t>(destination_end - destination))
+			return false;
+
+		memcpy(destination, literals, literal_count);
+		destination += literal_count;
+
+		if (match_length == 0)
+			return true;
+
+		if (destination_end - destination < 2)
+			return false;
+
+		*destination++ = static_cast<uint8_t>(offset);
+		*destination++ = static_cast<uint8_t>(offset >> 8);
+
+		const auto match_code = match_length - g_match_length_min;
+		*token |= static_cast<uint8_t>(match_code < 15 ? match_code : 15);
+		return match_code < 15 || WriteLength(destination, destination_end, match_code - 15);
+	}
+
+	size_t Compression::Compress(const void* source, const size_t source_size, void* destination, const size_t destination_capacity)
+	{
+		if (!source || !destination || source_size == 0)
+			return 0;
+
+		const auto src		= static_cast<const uint8_t*>(source);
+		const auto src_end	= src + source_size;
+		auto dst			= static_cast<uint8_t*>(destination);
+		const auto dst_end	= dst + destination_capacity;
+		auto anchor			= src;
+
+		if (source_size > g_match_start_limit)
+		{
+			const auto match_end	= src_end - g_literals_last;
+			const auto match_start	= src_end - g_match_start_limit;
+			uint32_t table[1 << g_hash_bits] = {}; // Last position of every 4 byte hash
+
+			auto ip = src;
+			while (ip < match_start)
+			{
+				const auto sequence	= Read32(ip);
+				const auto hash		= Hash(sequence);
+				auto ref			= src + table[hash];
+				table[hash]			= static_cast<uint32_t>(ip - src);
+
+				if (ref >= ip || static_cast<size_t>(ip - ref) > g_offset_max || Read32(ref) != sequence)
+				{
+					// The longer nothing matches, the bigger the steps (incompressible data goes by quickly)
+					ip += 1 + ((ip - anchor) >> 6);
+					continue;
+				}
+
+				// Extend the match backwards over the pending literals, and then forwards
+				while (ip > anchor && ref > src && ip[-1] == ref[-1])
+				{
+					ip--;
+					ref--;
+				}
+
+				auto match = ip + g_match_length_min;
+				auto match_ref = ref + g_match_length_min;
+				while (match < match_end && *match == *match_ref)
+				{
+					match++;
+					match_ref++;
+				}
+
+				if (!WriteSequence(dst, dst_end, anchor, ip - anchor, ip - ref, match - ip))
+					return 0;
+
+				ip		= match;
+				anchor	= ip;
+
+				// Positions inside of the match were skipped, remember at least the one before the next
+				table[Hash(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+			}
+		}
+
+		if (!WriteSequence(dst, dst_end, anchor, src_end - anchor, 0, 0))
+			return 0;
+
+		return dst - static_cast<uint8_t*>(destination);
+	}
+
+	bool Compression::Decompress(const void* source, const size_t source_size, void* destination, const size_t destination_size)
+	{
+		if (!source || !destination)
+			return false;
+
+		auto ip				= static_cast<const uint8_t*>(source);
+		const auto ip_end	= ip + source_size;
+		const auto dst		= static_cast<uint8_t*>(destination);
+		auto op				= dst;
+		const auto op_end	= dst + destination_size;
+
+		// Reads the extra bytes of a length which didn't fit in the token
+		const auto read_length = [&ip, ip_end](size_t& length)
+		{
+			uint8_t value = 255;
+			while (value == 255)
+			{
+				if (ip == ip_end)
+					return false;
+
+				value	= *ip++;
+				length	+= value;
+			}
+			return true;
+		};
+
+		while (ip < ip_end)
+		{
+			const uint32_t token = *ip++;
+
+			// Literals
+			size_t literal_count = token >> 4;
+			if (literal_count == 15 && !read_length(literal_count))
+				return false;
+
+			if (literal_count > static_cast<size_t>(ip_end - ip) || literal_count > static_cast<size_t>(op_end - op))
+				return false;
+
+			// Most literal runs are short, when both buffers have room they are over-copied in fixed steps instead
+			if (static_cast<size_t>(ip_end - ip) - literal_count >= g_copy_slack && static_cast<size_t>(op_end - op) - literal_count >= g_copy_slack)
+			{
+				for (size_t i = 0; i < literal_count; i += 16)
+				{
+					memcpy(op + i, ip + i, 16);
+				}
+			}
+			else
+			{
+				memcpy(op, ip, literal_count);
+			}
+			op += literal_count;
+			ip += literal_count;
+
+			// The last sequence has no match
+			if (ip == ip_end)
+				break;
+
+			// Match
+			if (ip_end - ip < 2)
+				return false;
+
+			const size_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > static_cast<size_t>(op - dst))
+				return false;
+
+			size_t match_length = token & 15;
+			if (match_length == 15 && !read_length(match_length))
+				return false;
+
+			match_length += g_match_length_min;
+			if (match_length > static_cast<size_t>(op_end - op))
+				return false;
+
+			// Matches can overlap the bytes they produce (that's how runs are encoded), so those are copied in steps
+			const auto match = op - offset;
+			if (offset >= 16 && static_cast<size_t>(op_end - op) - match_length >= g_copy_slack)
+			{
+				for (size_t i = 0; i < match_length; i += 16)
+				{
+					memcpy(op + i, match + i, 16);
+				}
+			}
+			else if (offset >= match_length)
+			{
+				memcpy(op, match, match_length);
+			}
+			else
+			{
+				size_t i = 0;
+				if (offset >= 8)
+				{
+					for (; i + 8 <= match_length; i += 8)
+					{
+						memcpy(op + i, match + i, 8);
+					}
+				}
+
+				for (; i < match_length; i++)
+				{
+					op[i] = match[i];
+				}
+			}
+			op += match_length;
+		}
+
+		return op == op_end;
+	}
+}
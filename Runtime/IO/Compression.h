@@ -0,0 +1,46 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <cstddef>
+#include <cstdint>
+#include "../Core/EngineDefs.h"
+//=============================
+
+namespace Spartan
+{
+	// A fast LZ77 codec (LZ4 block format) for engine files. Blocks are compressed independently,
+	// so they can be decompressed in any order (and in parallel), matches never reach outside a block.
+	class SPARTAN_CLASS Compression
+	{
+	public:
+		// The largest a block of the given size can get when compressed
+		static size_t GetBound(size_t size) { return size + size / 255 + 16; }
+
+		// Returns the compressed size, or 0 if it didn't fit into the destination (e.g. incompressible data)
+		static size_t Compress(const void* source, size_t source_size, void* destination, size_t destination_capacity);
+
+		// Returns false if the data is corrupt or doesn't decompress to exactly destination_size bytes
+		static bool Decompress(const void* source, size_t source_size, void* destination, size_t destination_size);
+	};
+}
@@ -20,8 +20,26 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 //= INCLUDES ==============
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <condition_variable>
 #include "FileStream.h"
+#include "Compression.h"
 #include "../Logging/Log.h"
+#include "../Threading/Threading.h"
+#ifdef _WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 //=========================
 
 //= NAMESPACES =====
@@ -30,6 +48,206 @@ using namespace std;
 
 namespace Spartan
 {
+	static constexpr size_t g_staging_chunk_size	= 4 * 1024 * 1024;	// Staged bytes are handed to the I/O thread in chunks of this size
+	static constexpr size_t g_queued_bytes_max	= 256 * 1024 * 1024;	// Writers wait for the I/O thread once this much is queued
+	static constexpr uint32_t g_block_size		= 64 * 1024;			// Raw bytes per compressed block, matches can reach back this far anyway
+	static constexpr uint32_t g_block_stored	= 1u << 31;				// Marks blocks which didn't compress and are stored as they are
+
+	// A file which is being written by the I/O thread
+	struct FileWriteTarget
+	{
+		FILE* file			= nullptr;
+		string path;
+		uint64_t position	= 0;
+		bool append			= false;
+		bool truncate		= false;
+		bool sync			= false;
+		bool failed			= false;
+		promise<bool> completion;
+	};
+
+	struct FileWriteCommand
+	{
+		shared_ptr<FileWriteTarget> target;
+		vector<char> data;
+		uint64_t offset	= 0;
+		bool close		= false; // Once the data is written, flush/sync/truncate the file and signal completion
+	};
+
+	// Owns the I/O thread which performs all file writes, in the order they were submitted
+	class FileWriter
+	{
+	public:
+		static FileWriter& Get()
+		{
+			static FileWriter instance;
+			return instance;
+		}
+
+		~FileWriter()
+		{
+			{
+				lock_guard<mutex> lock(m_mutex);
+				m_stopping = true;
+			}
+			m_condition_work.notify_one();
+			m_thread.join();
+		}
+
+		void Submit(FileWriteCommand&& command)
+		{
+			unique_lock<mutex> lock(m_mutex);
+
+			// Don't let a fast producer queue up unbounded amounts of memory
+			m_condition_space.wait(lock, [this] { return m_queued_bytes < g_queued_bytes_max || m_commands.empty(); });
+
+			m_queued_bytes += command.data.size();
+			m_commands.push(move(command));
+			lock.unlock();
+
+			m_condition_work.notify_one();
+		}
+
+		void AddPending(const string& path, const shared_future<bool>& completion)
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_pending[path] = completion;
+		}
+
+		void WaitForIdle()
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_condition_space.wait(lock, [this] { return m_commands.empty() && !m_busy; });
+		}
+
+		// Opening a file while the I/O thread is still writing it would see (or truncate) partial data
+		void WaitForPending(const string& path)
+		{
+			shared_future<bool> completion;
+			{
+				lock_guard<mutex> lock(m_mutex);
+				const auto it = m_pending.find(path);
+				if (it == m_pending.end())
+					return;
+
+				completion = it->second;
+			}
+			completion.wait();
+		}
+
+		bool IsPending(const string& path)
+		{
+			lock_guard<mutex> lock(m_mutex);
+			const auto it = m_pending.find(path);
+			return it != m_pending.end() && it->second.wait_for(chrono::seconds(0)) != future_status::ready;
+		}
+
+	private:
+		FileWriter()
+		{
+			m_thread = thread(&FileWriter::Run, this);
+		}
+
+		void Run()
+		{
+			while (true)
+			{
+				unique_lock<mutex> lock(m_mutex);
+				m_condition_work.wait(lock, [this] { return m_stopping || !m_commands.empty(); });
+
+				// Drain everything before stopping, the files must be complete
+				if (m_commands.empty())
+					return;
+
+				auto command = move(m_commands.front());
+				m_commands.pop();
+				m_busy = true;
+				lock.unlock();
+
+				Execute(command);
+
+				lock.lock();
+				m_busy = false;
+				m_queued_bytes -= command.data.size();
+				if (command.close)
+				{
+					const auto it = m_pending.find(command.target->path);
+					if (it != m_pending.end() && it->second.wait_for(chrono::seconds(0)) == future_status::ready)
+					{
+						m_pending.erase(it);
+					}
+				}
+				lock.unlock();
+
+				m_condition_space.notify_all();
+			}
+		}
+
+		static void Execute(FileWriteCommand& command)
+		{
+			auto& target = *command.target;
+
+			if (!command.data.empty() && !target.failed)
+			{
+				if (!target.append && target.position != command.offset)
+				{
+#ifdef _WIN32
+					target.failed |= _fseeki64(target.file, static_cast<int64_t>(command.offset), SEEK_SET) != 0;
+#else
+					target.failed |= fseeko(target.file, static_cast<off_t>(command.offset), SEEK_SET) != 0;
+#endif
+				}
+
+				target.failed	|= fwrite(command.data.data(), 1, command.data.size(), target.file) != command.data.size();
+				target.position	= command.offset + command.data.size();
+			}
+
+			if (!command.close)
+				return;
+
+			target.failed |= fflush(target.file) != 0;
+
+			// Skipped bytes were kept, but anything past the last write is stale
+			if (target.truncate)
+			{
+#ifdef _WIN32
+				target.failed |= _chsize_s(_fileno(target.file), static_cast<int64_t>(command.offset + command.data.size())) != 0;
+#else
+				target.failed |= ftruncate(fileno(target.file), static_cast<off_t>(command.offset + command.data.size())) != 0;
+#endif
+			}
+
+			if (target.sync)
+			{
+#ifdef _WIN32
+				target.failed |= _commit(_fileno(target.file)) != 0;
+#else
+				target.failed |= fsync(fileno(target.file)) != 0;
+#endif
+			}
+
+			target.failed |= fclose(target.file) != 0;
+			target.file = nullptr;
+
+			if (target.failed)
+			{
+				LOGF_ERROR("Failed to write \"%s\"", target.path.c_str());
+			}
+
+			target.completion.set_value(!target.failed);
+		}
+
+		thread m_thread;
+		mutex m_mutex;
+		condition_variable m_condition_work;
+		condition_variable m_condition_space;
+		queue<FileWriteCommand> m_commands;
+		unordered_map<string, shared_future<bool>> m_pending;
+		size_t m_queued_bytes	= 0;
+		bool m_busy				= false;
+		bool m_stopping			= false;
+	};
+
 	FileStream::FileStream(const string& path, uint32_t flags)
 	{
 		m_is_open	= false;
@@ -37,15 +255,46 @@ namespace Spartan
 
 		int ios_flags	= ios::binary;
 		ios_flags		|= (flags & FileStream_Read)	? ios::in	: 0;
-		ios_flags		|= (flags & FileStream_Write)	? ios::out	: 0;
-		ios_flags		|= (flags & FileStream_Append)	? ios::app	: 0;
+
+		// Pending writes to this file have to land first
+		FileWriter::Get().WaitForPending(path);
 
 		if (m_flags & FileStream_Write)
 		{
-			out.open(path, ios_flags);
-			if (out.fail())
+			auto target			= make_shared<FileWriteTarget>();
+			target->path		= path;
+			target->append		= (m_flags & FileStream_Append) != 0;
+			target->truncate	= (m_flags & FileStream_Update) != 0;
+			target->sync		= (m_flags & FileStream_Sync) != 0;
+
+			// Updating a file which doesn't exist yet is just writing it
+			if (target->truncate)
+			{
+				target->file = fopen(path.c_str(), "r+b");
+			}
+			if (!target->file)
+			{
+				target->file = fopen(path.c_str(), target->append ? "ab" : "wb");
+			}
+
+			m_completion = target->completion.get_future().share();
+
+			if (!target->file)
 			{
 				LOGF_ERROR("Failed to open \"%s\" for writing", path.c_str());
+				target->completion.set_value(false);
+				return;
+			}
+
+			m_target = target;
+			m_staging.resize(g_staging_chunk_size);
+			FileWriter::Get().AddPending(path, m_completion);
+		}
+		else if ((m_flags & FileStream_Read) && (m_flags & FileStream_Mapped))
+		{
+			if (!Map(path))
+			{
+				LOGF_ERROR("Failed to map \"%s\" for reading", path.c_str());
 				return;
 			}
 		}
@@ -57,6 +306,19 @@ namespace Spartan
 				LOGF_ERROR("Failed to open \"%s\" for reading", path.c_str());
 				return;
 			}
+
+			// Read everything in one go and let go of the file
+			if (m_flags & FileStream_Preload)
+			{
+				in.seekg(0, ios::end);
+				m_buffer.resize(static_cast<size_t>(in.tellg()));
+				in.seekg(0, ios::beg);
+				in.read(m_buffer.data(), m_buffer.size());
+				in.close();
+
+				m_data = m_buffer.data();
+				m_size = m_buffer.size();
+			}
 		}
 
 		m_is_open = true;
@@ -71,22 +333,54 @@ namespace Spartan
 	{
 		if (m_flags & FileStream_Write)
 		{
-			out.flush();
-			out.close();
+			if (!m_target)
+				return;
+
+			// Hand over what's left and let the I/O thread finish the file
+			m_staging.resize(m_staging_size);
+			FileWriteCommand command;
+			command.target	= move(m_target);
+			command.data	= move(m_staging);
+			command.offset	= m_staging_offset;
+			command.close	= true;
+			m_staging_offset += command.data.size();
+			m_staging_size	= 0;
+			FileWriter::Get().Submit(move(command));
+
+			if (!(m_flags & FileStream_Async))
+			{
+				m_completion.wait();
+			}
 		}
 		else if (m_flags & FileStream_Read)
 		{
 			in.clear();
 			in.close();
+			Unmap();
+			m_buffer.clear();
+			m_buffer.shrink_to_fit();
+			m_data		= nullptr;
+			m_size		= 0;
+			m_position	= 0;
 		}
 	}
 
+	void FileStream::WaitForWrites()
+	{
+		FileWriter::Get().WaitForIdle();
+	}
+
+	bool FileStream::IsWritePending(const string& path)
+	{
+		return FileWriter::Get().IsPending(path);
+	}
+
 	void FileStream::Write(const string& value)
 	{
 		const auto length = static_cast<uint32_t>(value.length());
 		Write(length);
 
-		out.write(const_cast<char*>(value.c_str()), length);
+		WriteBytes(value.c_str(), length);
 	}
 
 	void FileStream::Write(const vector<string>& value)
@@ -104,28 +398,115 @@ namespace Spartan
 	{
 		const auto length = static_cast<uint32_t>(value.size());
 		Write(length);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
+		WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
 	}
 
 	void FileStream::Write(const vector<uint32_t>& value)
 	{
 		const auto length = static_cast<uint32_t>(value.size());
 		Write(length);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
+		WriteBytes(value.data(), sizeof(uint32_t) * length);
 	}
 
 	void FileStream::Write(const vector<unsigned char>& value)
 	{
 		const auto size = static_cast<uint32_t>(value.size());
 		Write(size);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+		WriteBytes(value.data(), sizeof(unsigned char) * size);
 	}
 
 	void FileStream::Write(const vector<std::byte>& value)
 	{
 		const auto size = static_cast<uint32_t>(value.size());
 		Write(size);
-		out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+		WriteBytes(value.data(), sizeof(std::byte) * size);
+	}
+
+	void FileStream::WriteBlocks(const vector<RHI_Vertex_PosTexNorTan>& value, const bool compress, Threading* threading)
+	{
+		const auto length = static_cast<uint32_t>(value.size());
+		Write(length);
+		WriteBlocks(value.data(), sizeof(RHI_Vertex_PosTexNorTan) * length, compress, threading);
+	}
+
+	void FileStream::WriteBlocks(const vector<uint32_t>& value, const bool compress, Threading* threading)
+	{
+		const auto length = static_cast<uint32_t>(value.size());
+		Write(length);
+		WriteBlocks(value.data(), sizeof(uint32_t) * length, compress, threading);
+	}
+
+	void FileStream::WriteBlocks(const vector<std::byte>& value, const bool compress, Threading* threading)
+	{
+		const auto size = static_cast<uint32_t>(value.size());
+		Write(size);
+		WriteBlocks(value.data(), sizeof(std::byte) * size, compress, threading);
+	}
+
+	void FileStream::WriteBlocks(const void* source, const size_t size, const bool compress, Threading* threading)
+	{
+		// A block size of zero means that the bytes follow as they are
+		if (!compress || size == 0)
+		{
+			Write(static_cast<uint32_t>(0));
+			WriteBytes(source, size);
+			return;
+		}
+
+		const auto bytes		= static_cast<const char*>(source);
+		const auto block_count	= static_cast<uint32_t>((size + g_block_size - 1) / g_block_size);
+		vector<vector<char>> blocks(block_count);
+		vector<uint32_t> block_sizes(block_count);
+
+		const auto compress_blocks = [&](const uint32_t start, const uint32_t end)
+		{
+			for (auto i = start; i < end; i++)
+			{
+				const auto offset	= static_cast<size_t>(i) * g_block_size;
+				const auto size_raw	= static_cast<uint32_t>(Math::Min(static_cast<size_t>(g_block_size), size - offset));
+
+				auto& block = blocks[i];
+				block.resize(Compression::GetBound(size_raw));
+				const auto size_compressed = Compression::Compress(bytes + offset, size_raw, block.data(), block.size());
+
+				// Blocks which don't get any smaller are written from the source
+				if (size_compressed == 0 || size_compressed >= size_raw)
+				{
+					block.clear();
+					block_sizes[i] = size_raw | g_block_stored;
+				}
+				else
+				{
+					block.resize(size_compressed);
+					block_sizes[i] = static_cast<uint32_t>(size_compressed);
+				}
+			}
+		};
+
+		if (threading)
+		{
+			threading->AddTaskLoop(compress_blocks, block_count);
+		}
+		else
+		{
+			compress_blocks(0, block_count);
+		}
+
+		// Block size, count and table, then the blocks
+		Write(g_block_size);
+		Write(block_count);
+		WriteBytes(block_sizes.data(), sizeof(uint32_t) * block_count);
+		for (uint32_t i = 0; i < block_count; i++)
+		{
+			if (block_sizes[i] & g_block_stored)
+			{
+				WriteBytes(bytes + static_cast<size_t>(i) * g_block_size, block_sizes[i] & ~g_block_stored);
+			}
+			else
+			{
+				WriteBytes(blocks[i].data(), blocks[i].size());
+			}
+		}
 	}
 
 	void FileStream::Skip(uint32_t n)
@@ -133,7 +514,12 @@ namespace Spartan
 		// Set the seek cursor to offset n from the current position
 		if (m_flags & FileStream_Write)
 		{
-			out.seekp(n, ios::cur);
+			Submit();
+			m_staging_offset += n;
+		}
+		else if (m_flags & (FileStream_Preload | FileStream_Mapped))
+		{
+			m_position = Math::Min(m_position + n, m_size);
 		}
 		else if (m_flags & FileStream_Read)
 		{
@@ -141,13 +527,40 @@ namespace Spartan
 		}
 	}
 
+	uint64_t FileStream::GetPosition()
+	{
+		if (m_flags & FileStream_Write)
+			return m_staging_offset + m_staging_size;
+
+		if (m_flags & (FileStream_Preload | FileStream_Mapped))
+			return m_position;
+
+		return static_cast<uint64_t>(in.tellg());
+	}
+
+	void FileStream::Seek(const uint64_t position)
+	{
+		if (m_flags & FileStream_Write)
+		{
+			LOG_ERROR("Seeking is only supported when reading");
+		}
+		else if (m_flags & (FileStream_Preload | FileStream_Mapped))
+		{
+			m_position = static_cast<size_t>(Math::Min(position, static_cast<uint64_t>(m_size)));
+		}
+		else if (m_flags & FileStream_Read)
+		{
+			in.seekg(position, ios::beg);
+		}
+	}
+
 	void FileStream::Read(string* value)
 	{
 		uint32_t length = 0;
 		Read(&length);
 
 		value->resize(length);
-		in.read(const_cast<char*>(value->c_str()), length);
+		ReadBytes(const_cast<char*>(value->c_str()), length);
 	}
 
 	void FileStream::Read(vector<string>* vec)
@@ -182,7 +595,7 @@ namespace Spartan
 		vec->reserve(length);
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosTexNorTan) * length);
+		ReadBytes(vec->data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
 	}
 
 	void FileStream::Read(vector<uint32_t>* vec)
@@ -198,7 +611,7 @@ namespace Spartan
 		vec->reserve(length);
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
+		ReadBytes(vec->data(), sizeof(uint32_t) * length);
 	}
 
 	void FileStream::Read(vector<unsigned char>* vec)
@@ -214,7 +627,7 @@ namespace Spartan
 		vec->reserve(length);
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+		ReadBytes(vec->data(), sizeof(unsigned char) * length);
 	}
 
 	void FileStream::Read(vector<std::byte>* vec)
@@ -230,6 +643,325 @@ namespace Spartan
 		vec->reserve(length);
 		vec->resize(length);
 
-		in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+		ReadBytes(vec->data(), sizeof(std::byte) * length);
+	}
+
+	void FileStream::ReadBlocks(vector<RHI_Vertex_PosTexNorTan>* vec, Threading* threading)
+	{
+		if (!vec)
+			return;
+
+		vec->clear();
+		vec->shrink_to_fit();
+		vec->resize(ReadAs<uint32_t>());
+
+		ReadBlocks(vec->data(), sizeof(RHI_Vertex_PosTexNorTan) * vec->size(), threading);
+	}
+
+	void FileStream::ReadBlocks(vector<uint32_t>* vec, Threading* threading)
+	{
+		if (!vec)
+			return;
+
+		vec->clear();
+		vec->shrink_to_fit();
+		vec->resize(ReadAs<uint32_t>());
+
+		ReadBlocks(vec->data(), sizeof(uint32_t) * vec->size(), threading);
+	}
+
+	void FileStream::ReadBlocks(vector<std::byte>* vec, Threading* threading)
+	{
+		if (!vec)
+			return;
+
+		vec->clear();
+		vec->shrink_to_fit();
+		vec->resize(ReadAs<uint32_t>());
+
+		ReadBlocks(vec->data(), sizeof(std::byte) * vec->size(), threading);
+	}
+
+	void FileStream::SkipBlocks(const size_t element_size)
+	{
+		const auto count		= ReadAs<uint32_t>();
+		const auto block_size	= ReadAs<uint32_t>();
+
+		// Stored as they are
+		if (block_size == 0)
+		{
+			Seek(GetPosition() + static_cast<uint64_t>(count) * element_size);
+			return;
+		}
+
+		// The block table says how big the compressed blocks are
+		const auto block_count = ReadAs<uint32_t>();
+		vector<uint32_t> block_sizes(block_count);
+		ReadBytes(block_sizes.data(), sizeof(uint32_t) * block_count);
+
+		uint64_t blocks_size = 0;
+		for (const auto block : block_sizes)
+		{
+			blocks_size += block & ~g_block_stored;
+		}
+
+		Seek(GetPosition() + blocks_size);
+	}
+
+	void FileStream::ReadBlocks(void* destination, const size_t size, Threading* threading)
+	{
+		const auto block_size = ReadAs<uint32_t>();
+		if (block_size == 0)
+		{
+			ReadBytes(destination, size);
+			return;
+		}
+
+		const auto block_count = ReadAs<uint32_t>();
+		if (static_cast<uint64_t>(block_count) * block_size < size || static_cast<uint64_t>(block_count - 1) * block_size >= size)
+		{
+			LOG_ERROR("The block table doesn't match the size of the data");
+			return;
+		}
+
+		// Where each block starts
+		vector<uint32_t> block_sizes(block_count);
+		vector<size_t> block_offsets(block_count);
+		ReadBytes(block_sizes.data(), sizeof(uint32_t) * block_count);
+		size_t blocks_size = 0;
+		for (uint32_t i = 0; i < block_count; i++)
+		{
+			block_offsets[i]	= blocks_size;
+			blocks_size			+= block_sizes[i] & ~g_block_stored;
+		}
+
+		// Preloaded and mapped files are decompressed in place, otherwise the blocks are read first
+		vector<char> buffer;
+		const char* blocks = nullptr;
+		if (m_data)
+		{
+			blocks = ReadView(blocks_size);
+		}
+		else
+		{
+			buffer.resize(blocks_size);
+			ReadBytes(buffer.data(), blocks_size);
+			blocks = buffer.data();
+		}
+
+		if (!blocks)
+			return;
+
+		const auto bytes = static_cast<char*>(destination);
+		atomic<bool> failed = false;
+		const auto decompress_blocks = [&](const uint32_t start, const uint32_t end)
+		{
+			for (auto i = start; i < end; i++)
+			{
+				const auto offset	= static_cast<size_t>(i) * block_size;
+				const auto size_raw	= Math::Min(static_cast<size_t>(block_size), size - offset);
+				const auto block	= blocks + block_offsets[i];
+
+				if (block_sizes[i] & g_block_stored)
+				{
+					if ((block_sizes[i] & ~g_block_stored) == size_raw)
+					{
+						memcpy(bytes + offset, block, size_raw);
+					}
+					else
+					{
+						failed = true;
+					}
+				}
+				else if (!Compression::Decompress(block, block_sizes[i], bytes + offset, size_raw))
+				{
+					failed = true;
+				}
+			}
+		};
+
+		if (threading)
+		{
+			threading->AddTaskLoop(decompress_blocks, block_count);
+		}
+		else
+		{
+			decompress_blocks(0, block_count);
+		}
+
+		if (failed)
+		{
+			LOG_ERROR("Failed to decompress, the data is corrupt");
+		}
+	}
+
+	void FileStream::WriteBytes(const void* source, const size_t size)
+	{
+		if (!m_target)
+			return;
+
+		const auto bytes = static_cast<const char*>(source);
+
+		// Large arrays are copied once, straight into a chunk of their own
+		if (size >= g_staging_chunk_size)
+		{
+			Submit();
+
+			FileWriteCommand command;
+			command.target	= m_target;
+			command.data.assign(bytes, bytes + size);
+			command.offset	= m_staging_offset;
+			m_staging_offset += size;
+			FileWriter::Get().Submit(move(command));
+			return;
+		}
+
+		if (m_staging_size + size > m_staging.size())
+		{
+			Submit();
+		}
+
+		memcpy(m_staging.data() + m_staging_size, bytes, size);
+		m_staging_size += size;
+	}
+
+	void FileStream::Submit()
+	{
+		if (!m_target || m_staging_size == 0)
+			return;
+
+		m_staging.resize(m_staging_size);
+		FileWriteCommand command;
+		command.target	= m_target;
+		command.data	= move(m_staging);
+		command.offset	= m_staging_offset;
+		m_staging_offset += m_staging_size;
+		m_staging_size	= 0;
+		FileWriter::Get().Submit(move(command));
+
+		m_staging = vector<char>(g_staging_chunk_size);
+	}
+
+	void FileStream::ReadBytes(void* destination, const size_t size)
+	{
+		if (m_flags & (FileStream_Preload | FileStream_Mapped))
+		{
+			if (const auto source = ReadView(size))
+			{
+				memcpy(destination, source, size);
+			}
+			return;
+		}
+
+		in.read(reinterpret_cast<char*>(destination), size);
+	}
+
+	const char* FileStream::ReadView(const size_t size)
+	{
+		if (!(m_flags & (FileStream_Preload | FileStream_Mapped)))
+		{
+			LOG_ERROR("Only preloaded or mapped streams can be read in place");
+			return nullptr;
+		}
+
+		if (size > m_size - m_position)
+		{
+			LOG_ERROR("Attempted to read past the end of the file");
+			return nullptr;
+		}
+
+		const auto view = m_data + m_position;
+		m_position += size;
+		return view;
+	}
+
+	bool FileStream::Map(const string& path)
+	{
+#ifdef _WIN32
+		const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+		m_map_file	= file;
+		m_size		= static_cast<size_t>(size.QuadPart);
+
+		// Empty files can't be mapped, there is nothing to read anyway
+		if (m_size == 0)
+			return true;
+
+		const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			Unmap();
+			return false;
+		}
+
+		// The view keeps the mapping alive, so the mapping handle can go
+		m_map_view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+#else
+		const auto file = open(path.c_str(), O_RDONLY);
+		if (file == -1)
+			return false;
+
+		struct stat info;
+		if (fstat(file, &info) != 0)
+		{
+			close(file);
+			return false;
+		}
+		m_size = static_cast<size_t>(info.st_size);
+
+		// The mapping outlives the descriptor
+		if (m_size != 0)
+		{
+			const auto view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+			m_map_view		= view != MAP_FAILED ? view : nullptr;
+			if (m_map_view)
+			{
+				madvise(m_map_view, m_size, MADV_SEQUENTIAL);
+			}
+		}
+		close(file);
+#endif
+
+		if (m_size != 0 && !m_map_view)
+		{
+			Unmap();
+			return false;
+		}
+
+		m_data = static_cast<const char*>(m_map_view);
+		return true;
+	}
+
+	void FileStream::Unmap()
+	{
+#ifdef _WIN32
+		if (m_map_view)
+		{
+			UnmapViewOfFile(m_map_view);
+		}
+
+		if (m_map_file)
+		{
+			CloseHandle(m_map_file);
+		}
+#else
+		if (m_map_view)
+		{
+			munmap(m_map_view, m_size);
+		}
+#endif
+		m_map_view	= nullptr;
+		m_map_file	= nullptr;
+		m_data		= nullptr;
+		m_size		= 0;
 	}
 }
@@ -24,6 +24,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===================
 #include <vector>
 #include <fstream>
+#include <cstring>
+#include <memory>
+#include <future>
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Vector4.h"
@@ -40,6 +43,30 @@ namespace Spartan
 		FileStream_Read		= 1 << 0,
 		FileStream_Write	= 1 << 1,
 		FileStream_Append	= 1 << 2,
+		FileStream_Preload	= 1 << 3, // Read the whole file into memory when opening, subsequent reads don't touch the disk
+		FileStream_Mapped	= 1 << 4, // Map the file into the address space, reads are pointer bumps and arrays can be viewed in place with ReadSpan()
+		FileStream_Async	= 1 << 5, // Close() doesn't wait for the I/O thread to finish writing, use GetCompletion() if you need to know
+		FileStream_Sync		= 1 << 6, // Force the written bytes to the physical disk (fsync) before the writes are reported complete
+		FileStream_Update	= 1 << 7, // Write into an existing file without truncating it first, Skip() steps over bytes which should be kept
+	};
+
+	struct FileWriteTarget;
+	class Threading;
+
+	// A view into the bytes of a preloaded or mapped stream, nothing is copied.
+	// It's only valid while the stream is open and, since the file is tightly packed,
+	// the data is not guaranteed to be aligned to T (fine for the float/uint types we store).
+	template <typename T>
+	struct FileSpan
+	{
+		const T* data	= nullptr;
+		uint32_t count	= 0;
+
+		const T* begin()	const { return data; }
+		const T* end()		const { return data + count; }
+		bool empty()		const { return count == 0; }
+		size_t size()		const { return count; }
+		size_t GetByteCount()	const { return sizeof(T) * count; }
 	};
 
 	class SPARTAN_CLASS FileStream
@@ -51,6 +78,26 @@ namespace Spartan
 		auto IsOpen() const { return m_is_open; }
 		void Close();
 
+		// Becomes ready once everything written has reached the file (true) or failed to (false), only valid for writing
+		const auto& GetCompletion() const { return m_completion; }
+
+		// Blocks until the I/O thread has written everything submitted so far, by any stream
+		static void WaitForWrites();
+
+		// Returns true while the I/O thread is still writing the file, opening it meanwhile would block until it's done
+		static bool IsWritePending(const std::string& path);
+
+		// Offset of the cursor from the start of the file, it can only be moved around when reading
+		uint64_t GetPosition();
+		void Seek(uint64_t position);
+
+		// Size of a preloaded or mapped file
+		auto GetSize() const { return m_size; }
+
+		// Version of the format being read, whoever reads the header sets it so that what follows can depend on it (0 means none)
+		void SetFormatVersion(const uint32_t version)	{ m_format_version = version; }
+		auto GetFormatVersion() const					{ return m_format_version; }
+
 		//= WRITING ==================================================
 		template <class T, class = typename std::enable_if<
 			std::is_same<T, bool>::value				||
@@ -73,7 +120,15 @@ namespace Spartan
 		>::type>
 		void Write(T value)
 		{
-			out.write(reinterpret_cast<char*>(&value), sizeof(value));
+			// Most writes are small and simply go into the staging buffer
+			if (m_staging_size + sizeof(T) <= m_staging.size())
+			{
+				memcpy(m_staging.data() + m_staging_size, &value, sizeof(T));
+				m_staging_size += sizeof(T);
+				return;
+			}
+
+			WriteBytes(&value, sizeof(T));
 		}
 
 		void Write(const std::string& value);
@@ -83,6 +138,12 @@ namespace Spartan
 		void Write(const std::vector<unsigned char>& value);
 		void Write(const std::vector<std::byte>& value);
 		void Skip(uint32_t n);
+
+		// Block encoded arrays, the blocks are LZ compressed independently (unless compress is false) and
+		// they get compressed in parallel when a Threading subsystem is given. Read with ReadBlocks().
+		void WriteBlocks(const std::vector<RHI_Vertex_PosTexNorTan>& value, bool compress, Threading* threading = nullptr);
+		void WriteBlocks(const std::vector<uint32_t>& value, bool compress, Threading* threading = nullptr);
+		void WriteBlocks(const std::vector<std::byte>& value, bool compress, Threading* threading = nullptr);
 		//===========================================================
 		
 		//= READING ===========================================
@@ -108,7 +169,15 @@ namespace Spartan
 		>::type>
 		void Read(T* value)
 		{
-			in.read(reinterpret_cast<char*>(value), sizeof(T));
+			// In memory, a typed read is a copy and a pointer bump
+			if (m_data && m_position + sizeof(T) <= m_size)
+			{
+				memcpy(value, m_data + m_position, sizeof(T));
+				m_position += sizeof(T);
+				return;
+			}
+
+			ReadBytes(value, sizeof(T));
 		}
 		void Read(std::string* value);
 		void Read(std::vector<std::string>* vec);
@@ -117,6 +186,25 @@ namespace Spartan
 		void Read(std::vector<unsigned char>* vec);
 		void Read(std::vector<std::byte>* vec);
 
+		// Reads an array written by WriteBlocks(), the blocks are decompressed in parallel when a Threading subsystem is given
+		void ReadBlocks(std::vector<RHI_Vertex_PosTexNorTan>* vec, Threading* threading = nullptr);
+		void ReadBlocks(std::vector<uint32_t>* vec, Threading* threading = nullptr);
+		void ReadBlocks(std::vector<std::byte>* vec, Threading* threading = nullptr);
+		// Steps over an array written by WriteBlocks() without decoding it
+		void SkipBlocks(size_t element_size);
+
+		// Reads a length prefixed array (as written by the vector overloads of Write) without copying it,
+		// requires FileStream_Mapped or FileStream_Preload, otherwise an empty span is returned.
+		template <typename T>
+		FileSpan<T> ReadSpan()
+		{
+			FileSpan<T> span;
+			const auto count	= ReadAs<uint32_t>();
+			span.data			= reinterpret_cast<const T*>(ReadView(sizeof(T) * count));
+			span.count			= span.data ? count : 0;
+			return span;
+		}
+
 		// Reading with explicit type definition
 		template <class T, class = typename std::enable_if
 		<
@@ -143,9 +231,35 @@ namespace Spartan
 		//=====================================================
 
 	private:
-		std::ofstream out;
+		void WriteBytes(const void* source, size_t size);
+		void WriteBlocks(const void* source, size_t size, bool compress, Threading* threading);
+		void Submit();
+		void ReadBytes(void* destination, size_t size);
+		void ReadBlocks(void* destination, size_t size, Threading* threading);
+		const char* ReadView(size_t size);
+		bool Map(const std::string& path);
+		void Unmap();
+
 		std::ifstream in;
 		uint32_t m_flags;
 		bool m_is_open;
+		uint32_t m_format_version = 0;
+
+		// Writes are staged here and handed over to the I/O thread in large chunks
+		std::vector<char> m_staging;
+		size_t m_staging_size		= 0;
+		uint64_t m_staging_offset	= 0;
+		std::shared_ptr<FileWriteTarget> m_target;
+		std::shared_future<bool> m_completion;
+
+		// Preloaded or mapped file
+		const char* m_data	= nullptr;
+		size_t m_size		= 0;
+		size_t m_position	= 0;
+		std::vector<char> m_buffer;
+
+		// Mapping handles
+		void* m_map_file	= nullptr;
+		void* m_map_view	= nullptr;
 	};
 }
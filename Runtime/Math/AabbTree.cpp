@@ -0,0 +1,374 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==============
+#include "AabbTree.h"
+#include "../Logging/Log.h"
+//=========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::Math
+{
+	int32_t AabbTree::Insert(const BoundingBox& box, void* user_data)
+	{
+		const int32_t leaf	= NodeAllocate();
+		Node& node			= m_nodes[leaf];
+		node.box			= box;
+		node.box_fat		= BoundingBox(box.GetMin() - Vector3(m_margin), box.GetMax() + Vector3(m_margin));
+		node.user_data		= user_data;
+		node.height			= 0;
+
+		LeafInsert(leaf);
+		m_leaf_count++;
+
+		return leaf;
+	}
+
+	void AabbTree::Remove(const int32_t proxy)
+	{
+		if (proxy < 0 || proxy >= static_cast<int32_t>(m_nodes.size()) || !m_nodes[proxy].IsLeaf() || m_nodes[proxy].height != 0)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		LeafRemove(proxy);
+		NodeFree(proxy);
+		m_leaf_count--;
+	}
+
+	bool AabbTree::Move(const int32_t proxy, const BoundingBox& box)
+	{
+		Node& node	= m_nodes[proxy];
+		node.box	= box;
+
+		// Still within the fat box, the tree doesn't change
+		if (Contains(node.box_fat, box))
+			return false;
+
+		LeafRemove(proxy);
+		m_nodes[proxy].box_fat = BoundingBox(box.GetMin() - Vector3(m_margin), box.GetMax() + Vector3(m_margin));
+		LeafInsert(proxy);
+
+		return true;
+	}
+
+	void AabbTree::Clear()
+	{
+		m_nodes.clear();
+		m_root			= null_node;
+		m_free_list		= null_node;
+		m_leaf_count	= 0;
+	}
+
+	int32_t AabbTree::NodeAllocate()
+	{
+		// Grow
+		if (m_free_list == null_node)
+		{
+			m_nodes.emplace_back();
+			return static_cast<int32_t>(m_nodes.size()) - 1;
+		}
+
+		// Re-use a free node
+		const int32_t index	= m_free_list;
+		m_free_list			= m_nodes[index].parent;
+		m_nodes[index]		= Node();
+
+		return index;
+	}
+
+	void AabbTree::NodeFree(const int32_t index)
+	{
+		Node& node		= m_nodes[index];
+		node			= Node();
+		node.parent		= m_free_list;
+		m_free_list		= index;
+	}
+
+	void AabbTree::LeafInsert(const int32_t leaf)
+	{
+		if (m_root == null_node)
+		{
+			m_root					= leaf;
+			m_nodes[leaf].parent	= null_node;
+			return;
+		}
+
+		// Find the best sibling, by descending towards the child with the lowest cost in surface area
+		const BoundingBox box_leaf = m_nodes[leaf].box_fat;
+		int32_t index = m_root;
+		while (!m_nodes[index].IsLeaf())
+		{
+			const Node& node		= m_nodes[index];
+			const float area		= SurfaceArea(node.box_fat);
+			const float area_merged	= SurfaceArea(Merge(node.box_fat, box_leaf));
+
+			// Cost of creating a new parent for this node and the leaf
+			const float cost = 2.0f * area_merged;
+
+			// Minimum cost of pushing the leaf further down the tree
+			const float cost_inheritance = 2.0f * (area_merged - area);
+
+			auto cost_descend = [this, &box_leaf, cost_inheritance](const int32_t child)
+			{
+				const Node& node_child	= m_nodes[child];
+				const float area_child	= SurfaceArea(Merge(node_child.box_fat, box_leaf));
+				return (node_child.IsLeaf() ? area_child : area_child - SurfaceArea(node_child.box_fat)) + cost_inheritance;
+			};
+			const float cost_left	= cost_descend(node.child_left);
+			const float cost_right	= cost_descend(node.child_right);
+
+			if (cost < cost_left && cost < cost_right)
+				break;
+
+			index = cost_left < cost_right ? node.child_left : node.child_right;
+		}
+		const int32_t sibling = index;
+
+		// Create a new parent for the sibling and the leaf (allocating may move the nodes, so indices only)
+		const int32_t parent_old	= m_nodes[sibling].parent;
+		const int32_t parent_new	= NodeAllocate();
+		m_nodes[parent_new].parent		= parent_old;
+		m_nodes[parent_new].box_fat		= Merge(box_leaf, m_nodes[sibling].box_fat);
+		m_nodes[parent_new].height		= m_nodes[sibling].height + 1;
+		m_nodes[parent_new].child_left	= sibling;
+		m_nodes[parent_new].child_right	= leaf;
+		m_nodes[sibling].parent			= parent_new;
+		m_nodes[leaf].parent			= parent_new;
+
+		if (parent_old != null_node)
+		{
+			if (m_nodes[parent_old].child_left == sibling)
+			{
+				m_nodes[parent_old].child_left = parent_new;
+			}
+			else
+			{
+				m_nodes[parent_old].child_right = parent_new;
+			}
+		}
+		else
+		{
+			m_root = parent_new;
+		}
+
+		// Walk back up, fixing the heights and the boxes
+		Refit(m_nodes[leaf].parent);
+	}
+
+	void AabbTree::LeafRemove(const int32_t leaf)
+	{
+		if (leaf == m_root)
+		{
+			m_root = null_node;
+			return;
+		}
+
+		const int32_t parent		= m_nodes[leaf].parent;
+		const int32_t grandparent	= m_nodes[parent].parent;
+		const int32_t sibling		= m_nodes[parent].child_left == leaf ? m_nodes[parent].child_right : m_nodes[parent].child_left;
+
+		// The sibling takes the place of the parent
+		m_nodes[sibling].parent = grandparent;
+		NodeFree(parent);
+
+		if (grandparent == null_node)
+		{
+			m_root = sibling;
+			return;
+		}
+
+		if (m_nodes[grandparent].child_left == parent)
+		{
+			m_nodes[grandparent].child_left = sibling;
+		}
+		else
+		{
+			m_nodes[grandparent].child_right = sibling;
+		}
+
+		Refit(grandparent);
+	}
+
+	void AabbTree::Refit(int32_t index)
+	{
+		while (index != null_node)
+		{
+			index = Balance(index);
+
+			Node& node			= m_nodes[index];
+			const Node& left	= m_nodes[node.child_left];
+			const Node& right	= m_nodes[node.child_right];
+			node.height			= 1 + Max(left.height, right.height);
+			node.box_fat		= Merge(left.box_fat, right.box_fat);
+
+			index = node.parent;
+		}
+	}
+
+	int32_t AabbTree::Balance(const int32_t index_a)
+	{
+		Node& a = m_nodes[index_a];
+		if (a.IsLeaf() || a.height < 2)
+			return index_a;
+
+		const int32_t index_b	= a.child_left;
+		const int32_t index_c	= a.child_right;
+		Node& b					= m_nodes[index_b];
+		Node& c					= m_nodes[index_c];
+		const int32_t balance	= c.height - b.height;
+
+		// Makes a child take the place of a in the parent of a
+		auto replace_in_parent = [this, index_a](Node& child, const int32_t index_child)
+		{
+			if (child.parent == null_node)
+			{
+				m_root = index_child;
+			}
+			else if (m_nodes[child.parent].child_left == index_a)
+			{
+				m_nodes[child.parent].child_left = index_child;
+			}
+			else
+			{
+				m_nodes[child.parent].child_right = index_child;
+			}
+		};
+
+		// Rotate c up
+		if (balance > 1)
+		{
+			const int32_t index_f	= c.child_left;
+			const int32_t index_g	= c.child_right;
+			Node& f					= m_nodes[index_f];
+			Node& g					= m_nodes[index_g];
+
+			c.child_left	= index_a;
+			c.parent		= a.parent;
+			a.parent		= index_c;
+			replace_in_parent(c, index_c);
+
+			if (f.height > g.height)
+			{
+				c.child_right	= index_f;
+				a.child_right	= index_g;
+				g.parent		= index_a;
+				a.box_fat		= Merge(b.box_fat, g.box_fat);
+				c.box_fat		= Merge(a.box_fat, f.box_fat);
+				a.height		= 1 + Max(b.height, g.height);
+				c.height		= 1 + Max(a.height, f.height);
+			}
+			else
+			{
+				c.child_right	= index_g;
+				a.child_right	= index_f;
+				f.parent		= index_a;
+				a.box_fat		= Merge(b.box_fat, f.box_fat);
+				c.box_fat		= Merge(a.box_fat, g.box_fat);
+				a.height		= 1 + Max(b.height, f.height);
+				c.height		= 1 + Max(a.height, g.height);
+			}
+
+			return index_c;
+		}
+
+		// Rotate b up
+		if (balance < -1)
+		{
+			const int32_t index_d	= b.child_left;
+			const int32_t index_e	= b.child_right;
+			Node& d					= m_nodes[index_d];
+			Node& e					= m_nodes[index_e];
+
+			b.child_left	= index_a;
+			b.parent		= a.parent;
+			a.parent		= index_b;
+			replace_in_parent(b, index_b);
+
+			if (d.height > e.height)
+			{
+				b.child_right	= index_d;
+				a.child_left	= index_e;
+				e.parent		= index_a;
+				a.box_fat		= Merge(c.box_fat, e.box_fat);
+				b.box_fat		= Merge(a.box_fat, d.box_fat);
+				a.height		= 1 + Max(c.height, e.height);
+				b.height		= 1 + Max(a.height, d.height);
+			}
+			else
+			{
+				b.child_right	= index_e;
+				a.child_left	= index_d;
+				d.parent		= index_a;
+				a.box_fat		= Merge(c.box_fat, d.box_fat);
+				b.box_fat		= Merge(a.box_fat, e.box_fat);
+				a.height		= 1 + Max(c.height, d.height);
+				b.height		= 1 + Max(a.height, e.height);
+			}
+
+			return index_b;
+		}
+
+		return index_a;
+	}
+
+	BoundingBox AabbTree::Merge(const BoundingBox& a, const BoundingBox& b)
+	{
+		return BoundingBox
+		(
+			Vector3(Min(a.GetMin().x, b.GetMin().x), Min(a.GetMin().y, b.GetMin().y), Min(a.GetMin().z, b.GetMin().z)),
+			Vector3(Max(a.GetMax().x, b.GetMax().x), Max(a.GetMax().y, b.GetMax().y), Max(a.GetMax().z, b.GetMax().z))
+		);
+	}
+
+	float AabbTree::SurfaceArea(const BoundingBox& box)
+	{
+		const Vector3 size = box.GetSize();
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	bool AabbTree::Contains(const BoundingBox& outer, const BoundingBox& inner)
+	{
+		return
+			inner.GetMin().x >= outer.GetMin().x && inner.GetMin().y >= outer.GetMin().y && inner.GetMin().z >= outer.GetMin().z &&
+			inner.GetMax().x <= outer.GetMax().x && inner.GetMax().y <= outer.GetMax().y && inner.GetMax().z <= outer.GetMax().z;
+	}
+
+	bool AabbTree::Overlaps(const BoundingBox& a, const BoundingBox& b)
+	{
+		return
+			a.GetMin().x <= b.GetMax().x && a.GetMax().x >= b.GetMin().x &&
+			a.GetMin().y <= b.GetMax().y && a.GetMax().y >= b.GetMin().y &&
+			a.GetMin().z <= b.GetMax().z && a.GetMax().z >= b.GetMin().z;
+	}
+
+	float AabbTree::DistanceSquared(const BoundingBox& box, const Vector3& point)
+	{
+		const float x = Max(Max(box.GetMin().x - point.x, 0.0f), point.x - box.GetMax().x);
+		const float y = Max(Max(box.GetMin().y - point.y, 0.0f), point.y - box.GetMax().y);
+		const float z = Max(Max(box.GetMin().z - point.z, 0.0f), point.z - box.GetMax().z);
+		return x * x + y * y + z * z;
+	}
+}
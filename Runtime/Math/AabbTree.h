@@ -0,0 +1,182 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =================
+#include <vector>
+#include "../Core/EngineDefs.h"
+#include "BoundingBox.h"
+#include "Frustum.h"
+#include "Ray.h"
+//============================
+
+namespace Spartan::Math
+{
+	// A dynamic bounding volume tree. Leaves are stored with an enlarged (fat) box so that small movements
+	// don't change the tree, and the tree is kept balanced with AVL style rotations as leaves come and go.
+	class SPARTAN_CLASS AabbTree
+	{
+	public:
+		AabbTree() = default;
+		~AabbTree() = default;
+
+		// Adds a leaf and returns it's proxy
+		int32_t Insert(const BoundingBox& box, void* user_data);
+
+		// Removes a leaf
+		void Remove(int32_t proxy);
+
+		// Updates the box of a leaf, it's only re-inserted if it escaped it's fat box (returns true if so)
+		bool Move(int32_t proxy, const BoundingBox& box);
+
+		// Removes everything
+		void Clear();
+
+		void* GetUserData(const int32_t proxy) const			{ return m_nodes[proxy].user_data; }
+		const BoundingBox& GetBox(const int32_t proxy) const	{ return m_nodes[proxy].box; }
+		uint32_t GetHeight() const								{ return m_root == null_node ? 0 : m_nodes[m_root].height; }
+		uint32_t GetLeafCount() const							{ return m_leaf_count; }
+
+		// How much the leaves are enlarged by, in world units
+		void SetMargin(const float margin)	{ m_margin = margin; }
+		float GetMargin() const				{ return m_margin; }
+
+		//= QUERIES ===========================================================================================
+		// The callback receives the user data of every leaf which passes the test, it returns false to stop.
+		template <typename Callback>
+		void Query(const Frustum& frustum, Callback&& callback) const
+		{
+			Traverse([&frustum](const BoundingBox& box) { return frustum.CheckCube(box.GetCenter(), box.GetExtents()) != Outside; }, callback);
+		}
+
+		template <typename Callback>
+		void Query(const BoundingBox& box, Callback&& callback) const
+		{
+			Traverse([&box](const BoundingBox& node_box) { return Overlaps(box, node_box); }, callback);
+		}
+
+		template <typename Callback>
+		void Query(const Vector3& center, const float radius, Callback&& callback) const
+		{
+			Traverse([&center, radius](const BoundingBox& box) { return DistanceSquared(box, center) <= radius * radius; }, callback);
+		}
+
+		// The callback also receives the distance along the ray at which the leaf was hit
+		template <typename Callback>
+		void Query(const Ray& ray, Callback&& callback) const
+		{
+			float distance = INFINITY;
+			Traverse
+			(
+				[&ray, &distance](const BoundingBox& box) { distance = ray.HitDistance(box); return distance != INFINITY; },
+				[&callback, &distance](void* user_data) { return callback(user_data, distance); }
+			);
+		}
+		//=====================================================================================================
+
+	private:
+		static const int32_t null_node = -1;
+
+		struct Node
+		{
+			bool IsLeaf() const { return child_left == null_node; }
+
+			BoundingBox box_fat;			// contains the children, or the enlarged box of a leaf
+			BoundingBox box;				// the actual box of a leaf
+			void* user_data		= nullptr;
+			int32_t parent		= null_node; // the next free node, when the node is on the free list
+			int32_t child_left	= null_node;
+			int32_t child_right	= null_node;
+			int32_t height		= -1;		// 0 for leaves, -1 for free nodes
+		};
+
+		// Visits the nodes whose fat box passes the test, and then hands the leaves whose actual box passes it to the callback
+		template <typename Test, typename Callback>
+		void Traverse(Test&& test, Callback&& callback) const
+		{
+			if (m_root == null_node)
+				return;
+
+			int32_t stack[64];
+			std::vector<int32_t> stack_overflow; // only used by badly unbalanced trees
+			uint32_t stack_size = 0;
+			stack[stack_size++] = m_root;
+
+			while (stack_size != 0 || !stack_overflow.empty())
+			{
+				int32_t index;
+				if (!stack_overflow.empty())
+				{
+					index = stack_overflow.back();
+					stack_overflow.pop_back();
+				}
+				else
+				{
+					index = stack[--stack_size];
+				}
+
+				const Node& node = m_nodes[index];
+				if (!test(node.box_fat))
+					continue;
+
+				if (node.IsLeaf())
+				{
+					if (test(node.box) && !callback(node.user_data))
+						return;
+
+					continue;
+				}
+
+				for (const int32_t child : { node.child_left, node.child_right })
+				{
+					if (stack_size < 64)
+					{
+						stack[stack_size++] = child;
+					}
+					else
+					{
+						stack_overflow.emplace_back(child);
+					}
+				}
+			}
+		}
+
+		int32_t NodeAllocate();
+		void NodeFree(int32_t index);
+		void LeafInsert(int32_t leaf);
+		void LeafRemove(int32_t leaf);
+		int32_t Balance(int32_t index);
+		void Refit(int32_t index);
+
+		static BoundingBox Merge(const BoundingBox& a, const BoundingBox& b);
+		static float SurfaceArea(const BoundingBox& box);
+		static bool Contains(const BoundingBox& outer, const BoundingBox& inner);
+		static bool Overlaps(const BoundingBox& a, const BoundingBox& b);
+		static float DistanceSquared(const BoundingBox& box, const Vector3& point);
+
+		std::vector<Node> m_nodes;
+		int32_t m_root			= null_node;
+		int32_t m_free_list		= null_node;
+		uint32_t m_leaf_count	= 0;
+		float m_margin			= 0.1f;
+	};
+}
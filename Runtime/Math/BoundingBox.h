@@ -49,13 +49,8 @@ namespace Spartan
 
             ~BoundingBox() = default;
 
-			// Assign from bounding box
-			BoundingBox& operator =(const BoundingBox& rhs)
-			{
-				m_min = rhs.m_min;
-				m_max = rhs.m_max;
-				return *this;
-			}
+			bool operator ==(const BoundingBox& rhs) const { return m_min == rhs.m_min && m_max == rhs.m_max; }
+			bool operator !=(const BoundingBox& rhs) const { return !(*this == rhs); }
 
 			// Returns the center
 			Vector3 GetCenter() const	{ return (m_max + m_min) * 0.5f; }
@@ -81,7 +81,7 @@ namespace Spartan::Math
 		m_planes[5].Normalize();
 	}
 
-	Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent)
+	Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent) const
 	{
 		// Check if any one point of the cube is in the view frustum.
 		Intersection result = Inside;
@@ -110,7 +110,81 @@ namespace Spartan::Math
 		return result;
 	}
 
-	Intersection Frustum::CheckSphere(const Vector3& center, float radius)
+	void Frustum::CheckCubes(
+		const float* center_x, const float* center_y, const float* center_z,
+		const float* extent_x, const float* extent_y, const float* extent_z,
+		const uint32_t count,
+		uint32_t* visibility
+	) const
+	{
+		// Absolute normals are needed for the projected extents, compute them once for the whole batch
+		Vector3 normals_absolute[6];
+		for (uint32_t i = 0; i < 6; i++)
+		{
+			normals_absolute[i] = m_planes[i].normal.Absolute();
+		}
+
+		for (uint32_t i = 0; i < (count + 31) / 32; i++)
+		{
+			visibility[i] = 0;
+		}
+
+		uint32_t i = 0;
+
+#if defined(SPARTAN_MATH_SSE)
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 cx = _mm_loadu_ps(center_x + i);
+			const __m128 cy = _mm_loadu_ps(center_y + i);
+			const __m128 cz = _mm_loadu_ps(center_z + i);
+			const __m128 ex = _mm_loadu_ps(extent_x + i);
+			const __m128 ey = _mm_loadu_ps(extent_y + i);
+			const __m128 ez = _mm_loadu_ps(extent_z + i);
+
+			// A box is outside if it's fully behind any one of the planes
+			__m128 outside = _mm_setzero_ps();
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				const Plane& plane		= m_planes[p];
+				const Vector3& absolute	= normals_absolute[p];
+
+				__m128 d = _mm_mul_ps(cx, _mm_set1_ps(plane.normal.x));
+				d = _mm_add_ps(d, _mm_mul_ps(cy, _mm_set1_ps(plane.normal.y)));
+				d = _mm_add_ps(d, _mm_mul_ps(cz, _mm_set1_ps(plane.normal.z)));
+
+				__m128 r = _mm_mul_ps(ex, _mm_set1_ps(absolute.x));
+				r = _mm_add_ps(r, _mm_mul_ps(ey, _mm_set1_ps(absolute.y)));
+				r = _mm_add_ps(r, _mm_mul_ps(ez, _mm_set1_ps(absolute.z)));
+
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), _mm_set1_ps(-plane.d)));
+			}
+
+			const uint32_t visible = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xF;
+			visibility[i / 32] |= visible << (i % 32);
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			bool outside = false;
+			for (uint32_t p = 0; p < 6 && !outside; p++)
+			{
+				const Plane& plane		= m_planes[p];
+				const Vector3& absolute	= normals_absolute[p];
+
+				const float d = center_x[i] * plane.normal.x + center_y[i] * plane.normal.y + center_z[i] * plane.normal.z;
+				const float r = extent_x[i] * absolute.x + extent_y[i] * absolute.y + extent_z[i] * absolute.z;
+				outside = d + r < -plane.d;
+			}
+
+			if (!outside)
+			{
+				visibility[i / 32] |= 1u << (i % 32);
+			}
+		}
+	}
+
+	Intersection Frustum::CheckSphere(const Vector3& center, float radius) const
 	{
 		// calculate our distances to each of the planes
 		for (const auto& plane : m_planes)
@@ -36,8 +36,18 @@ namespace Spartan::Math
         Frustum(const Matrix& mView, const Matrix& mProjection, float screenDepth);
 		~Frustum() = default;
 
-		Intersection CheckCube(const Vector3& center, const Vector3& extent);
-		Intersection CheckSphere(const Vector3& center, float radius);
+		Intersection CheckCube(const Vector3& center, const Vector3& extent) const;
+		Intersection CheckSphere(const Vector3& center, float radius) const;
+
+		// Tests count boxes, given as structure of arrays, against all six planes. For every box that isn't
+		// outside of the frustum, the matching bit of visibility is set (box i maps to bit i % 32 of word i / 32).
+		// The boxes are tested 4 at a time when SIMD is available, the caller owns (count + 31) / 32 words.
+		void CheckCubes(
+			const float* center_x, const float* center_y, const float* center_z,
+			const float* extent_x, const float* extent_y, const float* extent_z,
+			uint32_t count,
+			uint32_t* visibility
+		) const;
 
 	private:
 		Plane m_planes[6];
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Quaternion.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "Simd.h"
 //=====================
 
 namespace Spartan::Math
@@ -37,13 +38,7 @@ namespace Spartan::Math
 			SetIdentity();
 		}
 
-		Matrix (const Matrix& rhs)
-		{
-			m00 = rhs.m00; m01 = rhs.m01; m02 = rhs.m02; m03 = rhs.m03;
-			m10 = rhs.m10; m11 = rhs.m11; m12 = rhs.m12; m13 = rhs.m13;
-			m20 = rhs.m20; m21 = rhs.m21; m22 = rhs.m22; m23 = rhs.m23;
-			m30 = rhs.m30; m31 = rhs.m31; m32 = rhs.m32; m33 = rhs.m33;
-		}
+		Matrix(const Matrix& rhs) = default;
 
 		Matrix(
 			float m00, float m01, float m02, float m03,
@@ -67,7 +62,7 @@ namespace Spartan::Math
 			m30 = translation.x;            m31 = translation.y;            m32 = translation.z;            m33 = 1.0f;
 		}
 
-		~Matrix() {}
+		~Matrix() = default;
 
 		//= TRANSLATION ===========================================
 		Vector3 GetTranslation() { return Vector3(m30, m31, m32); }
@@ -286,6 +281,18 @@ namespace Spartan::Math
 		Matrix Inverted() const { return Invert(*this); }
 		static Matrix Invert(const Matrix& matrix)
 		{
+#if defined(SPARTAN_MATH_SSE)
+			Matrix result;
+			Simd::MatrixInvert(matrix.Data(), result.Data());
+			return result;
+#else
+			return InvertScalar(matrix);
+#endif
+		}
+
+		// Reference implementation
+		static Matrix InvertScalar(const Matrix& matrix)
+		{
 			float v0 = matrix.m20 * matrix.m31 - matrix.m21 * matrix.m30;
 			float v1 = matrix.m20 * matrix.m32 - matrix.m22 * matrix.m30;
 			float v2 = matrix.m20 * matrix.m33 - matrix.m23 *matrix.m30;
@@ -360,23 +367,35 @@ namespace Spartan::Math
 		//= MULTIPLICATION ================================================================================================================
 		Matrix operator*(const Matrix& rhs) const
 		{
+#if defined(SPARTAN_MATH_SIMD)
+			Matrix result;
+			Simd::MatrixMultiply(Data(), rhs.Data(), result.Data());
+			return result;
+#else
+			return MultiplyScalar(*this, rhs);
+#endif
+		}
+
+		// Reference implementation
+		static Matrix MultiplyScalar(const Matrix& lhs, const Matrix& rhs)
+		{
 			return Matrix(
-				m00 * rhs.m00 + m01 * rhs.m10 + m02 * rhs.m20 + m03 * rhs.m30,
-				m00 * rhs.m01 + m01 * rhs.m11 + m02 * rhs.m21 + m03 * rhs.m31,
-				m00 * rhs.m02 + m01 * rhs.m12 + m02 * rhs.m22 + m03 * rhs.m32,
-				m00 * rhs.m03 + m01 * rhs.m13 + m02 * rhs.m23 + m03 * rhs.m33,
-				m10 * rhs.m00 + m11 * rhs.m10 + m12 * rhs.m20 + m13 * rhs.m30,
-				m10 * rhs.m01 + m11 * rhs.m11 + m12 * rhs.m21 + m13 * rhs.m31,
-				m10 * rhs.m02 + m11 * rhs.m12 + m12 * rhs.m22 + m13 * rhs.m32,
-				m10 * rhs.m03 + m11 * rhs.m13 + m12 * rhs.m23 + m13 * rhs.m33,
-				m20 * rhs.m00 + m21 * rhs.m10 + m22 * rhs.m20 + m23 * rhs.m30,
-				m20 * rhs.m01 + m21 * rhs.m11 + m22 * rhs.m21 + m23 * rhs.m31,
-				m20 * rhs.m02 + m21 * rhs.m12 + m22 * rhs.m22 + m23 * rhs.m32,
-				m20 * rhs.m03 + m21 * rhs.m13 + m22 * rhs.m23 + m23 * rhs.m33,
-				m30 * rhs.m00 + m31 * rhs.m10 + m32 * rhs.m20 + m33 * rhs.m30,
-				m30 * rhs.m01 + m31 * rhs.m11 + m32 * rhs.m21 + m33 * rhs.m31,
-				m30 * rhs.m02 + m31 * rhs.m12 + m32 * rhs.m22 + m33 * rhs.m32,
-				m30 * rhs.m03 + m31 * rhs.m13 + m32 * rhs.m23 + m33 * rhs.m33
+				lhs.m00 * rhs.m00 + lhs.m01 * rhs.m10 + lhs.m02 * rhs.m20 + lhs.m03 * rhs.m30,
+				lhs.m00 * rhs.m01 + lhs.m01 * rhs.m11 + lhs.m02 * rhs.m21 + lhs.m03 * rhs.m31,
+				lhs.m00 * rhs.m02 + lhs.m01 * rhs.m12 + lhs.m02 * rhs.m22 + lhs.m03 * rhs.m32,
+				lhs.m00 * rhs.m03 + lhs.m01 * rhs.m13 + lhs.m02 * rhs.m23 + lhs.m03 * rhs.m33,
+				lhs.m10 * rhs.m00 + lhs.m11 * rhs.m10 + lhs.m12 * rhs.m20 + lhs.m13 * rhs.m30,
+				lhs.m10 * rhs.m01 + lhs.m11 * rhs.m11 + lhs.m12 * rhs.m21 + lhs.m13 * rhs.m31,
+				lhs.m10 * rhs.m02 + lhs.m11 * rhs.m12 + lhs.m12 * rhs.m22 + lhs.m13 * rhs.m32,
+				lhs.m10 * rhs.m03 + lhs.m11 * rhs.m13 + lhs.m12 * rhs.m23 + lhs.m13 * rhs.m33,
+				lhs.m20 * rhs.m00 + lhs.m21 * rhs.m10 + lhs.m22 * rhs.m20 + lhs.m23 * rhs.m30,
+				lhs.m20 * rhs.m01 + lhs.m21 * rhs.m11 + lhs.m22 * rhs.m21 + lhs.m23 * rhs.m31,
+				lhs.m20 * rhs.m02 + lhs.m21 * rhs.m12 + lhs.m22 * rhs.m22 + lhs.m23 * rhs.m32,
+				lhs.m20 * rhs.m03 + lhs.m21 * rhs.m13 + lhs.m22 * rhs.m23 + lhs.m23 * rhs.m33,
+				lhs.m30 * rhs.m00 + lhs.m31 * rhs.m10 + lhs.m32 * rhs.m20 + lhs.m33 * rhs.m30,
+				lhs.m30 * rhs.m01 + lhs.m31 * rhs.m11 + lhs.m32 * rhs.m21 + lhs.m33 * rhs.m31,
+				lhs.m30 * rhs.m02 + lhs.m31 * rhs.m12 + lhs.m32 * rhs.m22 + lhs.m33 * rhs.m32,
+				lhs.m30 * rhs.m03 + lhs.m31 * rhs.m13 + lhs.m32 * rhs.m23 + lhs.m33 * rhs.m33
 			);
 		}
 
@@ -384,6 +403,13 @@ namespace Spartan::Math
 
 		Vector3 operator*(const Vector3& rhs) const
 		{
+#if defined(SPARTAN_MATH_SIMD)
+			const float v[4] = { rhs.x, rhs.y, rhs.z, 1.0f };
+			float result[4];
+			Simd::MatrixTransform(Data(), v, result);
+			const float w_inverted = 1.0f / result[3];
+			return Vector3(result[0] * w_inverted, result[1] * w_inverted, result[2] * w_inverted);
+#else
 			Vector4 vWorking;
 
 			vWorking.x = (rhs.x * m00) + (rhs.y * m10) + (rhs.z * m20) + m30;
@@ -392,10 +418,16 @@ namespace Spartan::Math
 			vWorking.w = 1 / ((rhs.x * m03) + (rhs.y * m13) + (rhs.z * m23) + m33);
 
 			return Vector3(vWorking.x * vWorking.w, vWorking.y * vWorking.w, vWorking.z * vWorking.w);
+#endif
 		}
 
         Vector4 operator*(const Vector4& rhs) const
         {
+#if defined(SPARTAN_MATH_SIMD)
+            Vector4 result;
+            Simd::MatrixTransform(Data(), &rhs.x, &result.x);
+            return result;
+#else
             return Vector4
             (
                 (rhs.x * m00) + (rhs.y * m10) + (rhs.z * m20) + (rhs.w * m30),
@@ -403,6 +435,7 @@ namespace Spartan::Math
                 (rhs.x * m02) + (rhs.y * m12) + (rhs.z * m22) + (rhs.w * m32),
                 (rhs.x * m03) + (rhs.y * m13) + (rhs.z * m23) + (rhs.w * m33)
             );
+#endif
         }
 		//=================================================================================================================================
 
@@ -424,7 +457,8 @@ namespace Spartan::Math
 		bool operator!=(const Matrix& b) const { return !(*this == b); }
 		//==============================================================
 
-		const float* Data() const { return &m00; }
+		const float* Data() const	{ return &m00; }
+		float* Data()				{ return &m00; }
 		std::string ToString() const;
 
 		// Column-major memory representation 
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =======
 #include "Vector3.h"
+#include "Simd.h"
 //==================
 
 namespace Spartan::Math
@@ -47,7 +48,7 @@ namespace Spartan::Math
 			this->z = z;
 			this->w = w;
 		}
-		~Quaternion() {}
+		~Quaternion() = default;
 
 		// Creates a new Quaternion from the specified axis and angle.	
 		// The angle in radians.
@@ -227,17 +228,21 @@ namespace Spartan::Math
                 return Identity;
 		}
 
-		Quaternion& operator =(const Quaternion& rhs)
-		{			
-			x = rhs.x;
-			y = rhs.y;
-			z = rhs.z;
-            w = rhs.w;
-
-			return *this;
-		}
+		Quaternion& operator =(const Quaternion& rhs) = default;
 
         static Quaternion Multiply(const Quaternion& Qa, const Quaternion& Qb)
+        {
+#if defined(SPARTAN_MATH_SSE)
+            Quaternion result;
+            Simd::QuaternionMultiply(&Qa.x, &Qb.x, &result.x);
+            return result;
+#else
+            return MultiplyScalar(Qa, Qb);
+#endif
+        }
+
+        // Reference implementation
+        static Quaternion MultiplyScalar(const Quaternion& Qa, const Quaternion& Qb)
         {       
             float x = Qa.x;
             float y = Qa.y;
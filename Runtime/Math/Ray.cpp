@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Ray.h"
 #include <algorithm>
 #include "RayHit.h"
+#include "AabbTree.h"
 #include "../Core/Context.h"
 #include "../World/World.h"
 #include "../World/Entity.h"
@@ -47,33 +48,20 @@ namespace Spartan::Math
 
 	vector<RayHit> Ray::Trace(Context* context) const
 	{
-		// Find all the entities that the ray hits
+		// Find all the entities that the ray hits, through the world's spatial tree
 		vector<RayHit> hits;
-		const auto& entities = context->GetSubsystem<World>()->EntityGetAll();
-		for (const auto& entity : entities)
+		context->GetSubsystem<World>()->GetSpatialTree()->Query(*this, [this, &hits](void* user_data, const float distance)
 		{
-			// Make sure there entity has renderable
-			if (!entity->HasComponent<Renderable>())
-				continue;
-
-			// Get object oriented bounding box
-			const auto& aabb = entity->GetComponent<Renderable>()->GetAabb();
-
-			// Compute hit distance
-			auto distance = HitDistance(aabb);
-
-			// Don't store hit data if there was no hit
-			if (distance == INFINITY)
-				continue;
-
-            auto& hit_position = m_start + distance * m_direction;
+			const auto entity		= static_cast<Entity*>(user_data);
+			const auto hit_position	= m_start + distance * m_direction;
 			hits.emplace_back(
-                entity,          // Entity
-                hit_position,    // Position
-                distance,        // Distance
-                distance == 0.0f // Inside
+                entity->GetPtrShared(), // Entity
+                hit_position,           // Position
+                distance,               // Distance
+                distance == 0.0f        // Inside
             );
-		}
+			return true;
+		});
 
 		// Sort by distance (ascending)
 		sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b)
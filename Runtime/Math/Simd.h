@@ -0,0 +1,202 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+// The math types keep their scalar code as the reference implementation, the hot routines
+// (matrix multiplication, inversion, vector transformation and quaternion multiplication)
+// are routed through the functions below when the target supports SSE2 or NEON.
+// Define SPARTAN_MATH_SCALAR to force the scalar path.
+#if !defined(SPARTAN_MATH_SCALAR)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define SPARTAN_MATH_SSE
+	#elif defined(__ARM_NEON) || defined(_M_ARM64)
+		#define SPARTAN_MATH_NEON
+	#endif
+#endif
+
+#if defined(SPARTAN_MATH_SSE) || defined(SPARTAN_MATH_NEON)
+	#define SPARTAN_MATH_SIMD
+#endif
+
+//= INCLUDES ==============
+#if defined(SPARTAN_MATH_SSE)
+	#include <xmmintrin.h>
+	#include <emmintrin.h>
+#elif defined(SPARTAN_MATH_NEON)
+	#include <arm_neon.h>
+#endif
+//=========================
+
+#if defined(SPARTAN_MATH_SIMD)
+namespace Spartan::Math::Simd
+{
+	// All the functions operate on raw floats, matrices are 16 floats laid out column after column (see Matrix).
+	// Loads and stores are unaligned, so the math types don't need any extra alignment.
+
+#if defined(SPARTAN_MATH_SSE)
+	#define SPARTAN_SHUFFLE(v0, v1, x, y, z, w) _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(w, z, y, x))
+	#define SPARTAN_SWIZZLE(v, x, y, z, w)      _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x))
+
+	// out = a * b
+	inline void MatrixMultiply(const float* a, const float* b, float* out)
+	{
+		const __m128 a0 = _mm_loadu_ps(a + 0);
+		const __m128 a1 = _mm_loadu_ps(a + 4);
+		const __m128 a2 = _mm_loadu_ps(a + 8);
+		const __m128 a3 = _mm_loadu_ps(a + 12);
+
+		// Every column of the result is a linear combination of the columns of a
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 column = _mm_mul_ps(a0, _mm_set1_ps(b[i + 0]));
+			column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b[i + 1])));
+			column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b[i + 2])));
+			column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(b[i + 3])));
+			_mm_storeu_ps(out + i, column);
+		}
+	}
+
+	// out = v * m, where v and out are 4 floats
+	inline void MatrixTransform(const float* m, const float* v, float* out)
+	{
+		__m128 c0 = _mm_loadu_ps(m + 0);
+		__m128 c1 = _mm_loadu_ps(m + 4);
+		__m128 c2 = _mm_loadu_ps(m + 8);
+		__m128 c3 = _mm_loadu_ps(m + 12);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+		__m128 result = _mm_mul_ps(c0, _mm_set1_ps(v[0]));
+		result = _mm_add_ps(result, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+		result = _mm_add_ps(result, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+		result = _mm_add_ps(result, _mm_mul_ps(c3, _mm_set1_ps(v[3])));
+		_mm_storeu_ps(out, result);
+	}
+
+	// 2x2 block helpers for the inversion, a 2x2 matrix is stored as (x0, x1, x2, x3)
+	inline __m128 Mat2Mul(const __m128 a, const __m128 b)		{ return _mm_add_ps(_mm_mul_ps(a, SPARTAN_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SPARTAN_SWIZZLE(a, 1, 0, 3, 2), SPARTAN_SWIZZLE(b, 2, 1, 2, 1))); }
+	inline __m128 Mat2AdjMul(const __m128 a, const __m128 b)	{ return _mm_sub_ps(_mm_mul_ps(SPARTAN_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SPARTAN_SWIZZLE(a, 1, 1, 2, 2), SPARTAN_SWIZZLE(b, 2, 3, 0, 1))); }
+	inline __m128 Mat2MulAdj(const __m128 a, const __m128 b)	{ return _mm_sub_ps(_mm_mul_ps(a, SPARTAN_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SPARTAN_SWIZZLE(a, 1, 0, 3, 2), SPARTAN_SWIZZLE(b, 2, 1, 2, 1))); }
+
+	// out = inverse(m), uses the 2x2 block decomposition, so it works for any layout
+	inline void MatrixInvert(const float* m, float* out)
+	{
+		const __m128 r0 = _mm_loadu_ps(m + 0);
+		const __m128 r1 = _mm_loadu_ps(m + 4);
+		const __m128 r2 = _mm_loadu_ps(m + 8);
+		const __m128 r3 = _mm_loadu_ps(m + 12);
+
+		// Sub matrices
+		const __m128 A = _mm_movelh_ps(r0, r1);
+		const __m128 B = _mm_movehl_ps(r1, r0);
+		const __m128 C = _mm_movelh_ps(r2, r3);
+		const __m128 D = _mm_movehl_ps(r3, r2);
+
+		// Determinants of the sub matrices as (|A|, |B|, |C|, |D|)
+		const __m128 det_sub = _mm_sub_ps
+		(
+			_mm_mul_ps(SPARTAN_SHUFFLE(r0, r2, 0, 2, 0, 2), SPARTAN_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+			_mm_mul_ps(SPARTAN_SHUFFLE(r0, r2, 1, 3, 1, 3), SPARTAN_SHUFFLE(r1, r3, 0, 2, 0, 2))
+		);
+		const __m128 det_a = SPARTAN_SWIZZLE(det_sub, 0, 0, 0, 0);
+		const __m128 det_b = SPARTAN_SWIZZLE(det_sub, 1, 1, 1, 1);
+		const __m128 det_c = SPARTAN_SWIZZLE(det_sub, 2, 2, 2, 2);
+		const __m128 det_d = SPARTAN_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+		const __m128 d_c = Mat2AdjMul(D, C);
+		const __m128 a_b = Mat2AdjMul(A, B);
+		__m128 x = _mm_sub_ps(_mm_mul_ps(det_d, A), Mat2Mul(B, d_c));
+		__m128 w = _mm_sub_ps(_mm_mul_ps(det_a, D), Mat2Mul(C, a_b));
+		__m128 y = _mm_sub_ps(_mm_mul_ps(det_b, C), Mat2MulAdj(D, a_b));
+		__m128 z = _mm_sub_ps(_mm_mul_ps(det_c, B), Mat2MulAdj(A, d_c));
+
+		// |M| = |A|*|D| + |B|*|C| - tr((A#B)(D#C))
+		__m128 trace = _mm_mul_ps(a_b, SPARTAN_SWIZZLE(d_c, 0, 2, 1, 3));
+		trace = _mm_add_ps(trace, SPARTAN_SWIZZLE(trace, 1, 0, 3, 2));
+		trace = _mm_add_ps(trace, SPARTAN_SWIZZLE(trace, 2, 3, 0, 1));
+		const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+
+		const __m128 det_inverted = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+		x = _mm_mul_ps(x, det_inverted);
+		y = _mm_mul_ps(y, det_inverted);
+		z = _mm_mul_ps(z, det_inverted);
+		w = _mm_mul_ps(w, det_inverted);
+
+		// Apply the adjugate and store
+		_mm_storeu_ps(out + 0,  SPARTAN_SHUFFLE(x, y, 3, 1, 3, 1));
+		_mm_storeu_ps(out + 4,  SPARTAN_SHUFFLE(x, y, 2, 0, 2, 0));
+		_mm_storeu_ps(out + 8,  SPARTAN_SHUFFLE(z, w, 3, 1, 3, 1));
+		_mm_storeu_ps(out + 12, SPARTAN_SHUFFLE(z, w, 2, 0, 2, 0));
+	}
+
+	// out = a * b, quaternions are stored as (x, y, z, w)
+	inline void QuaternionMultiply(const float* a, const float* b, float* out)
+	{
+		const __m128 qa		= _mm_loadu_ps(a);
+		const __m128 qb		= _mm_loadu_ps(b);
+		const __m128 sign	= _mm_setr_ps(0.0f, 0.0f, 0.0f, -0.0f);
+
+		const __m128 t0 = _mm_mul_ps(SPARTAN_SWIZZLE(qa, 3, 3, 3, 3), qb);
+		const __m128 t1 = _mm_mul_ps(SPARTAN_SWIZZLE(qa, 0, 1, 2, 0), SPARTAN_SWIZZLE(qb, 3, 3, 3, 0));
+		const __m128 t2 = _mm_mul_ps(SPARTAN_SWIZZLE(qa, 1, 2, 0, 1), SPARTAN_SWIZZLE(qb, 2, 0, 1, 1));
+		const __m128 t3 = _mm_mul_ps(SPARTAN_SWIZZLE(qa, 2, 0, 1, 2), SPARTAN_SWIZZLE(qb, 1, 2, 0, 2));
+
+		__m128 result = _mm_add_ps(t0, _mm_xor_ps(_mm_add_ps(t1, t2), sign));
+		result = _mm_sub_ps(result, t3);
+		_mm_storeu_ps(out, result);
+	}
+
+	#undef SPARTAN_SHUFFLE
+	#undef SPARTAN_SWIZZLE
+#elif defined(SPARTAN_MATH_NEON)
+	// out = a * b
+	inline void MatrixMultiply(const float* a, const float* b, float* out)
+	{
+		const float32x4_t a0 = vld1q_f32(a + 0);
+		const float32x4_t a1 = vld1q_f32(a + 4);
+		const float32x4_t a2 = vld1q_f32(a + 8);
+		const float32x4_t a3 = vld1q_f32(a + 12);
+
+		// Every column of the result is a linear combination of the columns of a
+		for (int i = 0; i < 16; i += 4)
+		{
+			float32x4_t column = vmulq_n_f32(a0, b[i + 0]);
+			column = vmlaq_n_f32(column, a1, b[i + 1]);
+			column = vmlaq_n_f32(column, a2, b[i + 2]);
+			column = vmlaq_n_f32(column, a3, b[i + 3]);
+			vst1q_f32(out + i, column);
+		}
+	}
+
+	// out = v * m, where v and out are 4 floats
+	inline void MatrixTransform(const float* m, const float* v, float* out)
+	{
+		const float32x4x4_t rows = vld4q_f32(m); // de-interleaves, so the columns become rows
+
+		float32x4_t result = vmulq_n_f32(rows.val[0], v[0]);
+		result = vmlaq_n_f32(result, rows.val[1], v[1]);
+		result = vmlaq_n_f32(result, rows.val[2], v[2]);
+		result = vmlaq_n_f32(result, rows.val[3], v[3]);
+		vst1q_f32(out, result);
+	}
+#endif
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Accuracy test and microbenchmark for the SIMD math paths (see Simd.h).
+// It's not part of the engine build, compile it on its own (from the repository root) and run it:
+//   cl /std:c++17 /O2 /EHsc /DSPARTAN_MATH_TEST /DSPARTAN_CLASS= /I Runtime Runtime\Math\Simd_Test.cpp Runtime\Math\Quaternion.cpp Runtime\Math\Matrix.cpp Runtime\Math\Vector3.cpp Runtime\Math\Vector4.cpp
+// The process returns non-zero if any SIMD routine drifts from its scalar reference.
+#if defined(SPARTAN_MATH_TEST)
+
+//= INCLUDES ======
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "Matrix.h"
+//=================
+
+//= NAMESPACES ==================
+using namespace std;
+using namespace Spartan::Math;
+//===============================
+
+namespace
+{
+	const int g_accuracy_iterations	= 100000;
+	const int g_benchmark_iterations	= 10000000;
+
+	// Matrix multiplication and vector transformation perform the same operations in the same order,
+	// quaternion multiplication and matrix inversion group them differently
+	const float g_tolerance_exact		= 0.0f;
+	const float g_tolerance_quaternion	= 1e-6f;
+	const float g_tolerance_invert		= 1e-5f;
+
+	mt19937 g_random(1337);
+	uniform_real_distribution<float> g_distribution(-1.0f, 1.0f);
+	float Random() { return g_distribution(g_random); }
+
+	Matrix RandomTransform()
+	{
+		const Vector3 position	= Vector3(Random(), Random(), Random()) * 10.0f;
+		const Quaternion rotation	= Quaternion(Random(), Random(), Random(), Random()).Normalized();
+		const Vector3 scale		= Vector3(Random() + 2.0f, Random() + 2.0f, Random() + 2.0f);
+		return Matrix(position, rotation, scale);
+	}
+
+	float Difference(const Matrix& a, const Matrix& b)
+	{
+		float difference = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			difference = max(difference, fabs(a.Data()[i] - b.Data()[i]));
+		}
+		return difference;
+	}
+
+	float Difference(const Vector4& a, const Vector4& b)
+	{
+		return max(max(fabs(a.x - b.x), fabs(a.y - b.y)), max(fabs(a.z - b.z), fabs(a.w - b.w)));
+	}
+
+	float Difference(const Quaternion& a, const Quaternion& b)
+	{
+		return max(max(fabs(a.x - b.x), fabs(a.y - b.y)), max(fabs(a.z - b.z), fabs(a.w - b.w)));
+	}
+
+	// The scalar reference for operator*(Vector4, Matrix)
+	Vector4 TransformScalar(const Vector4& v, const Matrix& m)
+	{
+		return Vector4
+		(
+			(v.x * m.m00) + (v.y * m.m10) + (v.z * m.m20) + (v.w * m.m30),
+			(v.x * m.m01) + (v.y * m.m11) + (v.z * m.m21) + (v.w * m.m31),
+			(v.x * m.m02) + (v.y * m.m12) + (v.z * m.m22) + (v.w * m.m32),
+			(v.x * m.m03) + (v.y * m.m13) + (v.z * m.m23) + (v.w * m.m33)
+		);
+	}
+
+	bool Report(const char* name, const float difference, const float tolerance)
+	{
+		const bool passed = difference <= tolerance;
+		printf("%-24s max difference %g (tolerance %g) %s\n", name, difference, tolerance, passed ? "ok" : "FAILED");
+		return passed;
+	}
+
+	template<typename T>
+	double Time(T&& function)
+	{
+		const auto start = chrono::high_resolution_clock::now();
+		function();
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+int main()
+{
+#if defined(SPARTAN_MATH_SSE)
+	printf("Path: SSE\n");
+#elif defined(SPARTAN_MATH_NEON)
+	printf("Path: NEON\n");
+#else
+	printf("Path: scalar (SIMD routines fall back to the reference, differences must be zero)\n");
+#endif
+
+	// Accuracy
+	float difference_multiply	= 0.0f;
+	float difference_invert		= 0.0f;
+	float difference_transform	= 0.0f;
+	float difference_quaternion	= 0.0f;
+	for (int i = 0; i < g_accuracy_iterations; i++)
+	{
+		const Matrix a = RandomTransform();
+		Matrix b;
+		for (int j = 0; j < 16; j++)
+		{
+			b.Data()[j] = Random();
+		}
+
+		difference_multiply	= max(difference_multiply, Difference(a * b, Matrix::MultiplyScalar(a, b)));
+		difference_invert	= max(difference_invert, Difference(Matrix::Invert(a), Matrix::InvertScalar(a)));
+
+		const Vector4 v(Random(), Random(), Random(), Random());
+		difference_transform = max(difference_transform, Difference(v * a, TransformScalar(v, a)));
+
+		const Quaternion qa(Random(), Random(), Random(), Random());
+		const Quaternion qb(Random(), Random(), Random(), Random());
+		difference_quaternion = max(difference_quaternion, Difference(qa * qb, Quaternion::MultiplyScalar(qa, qb)));
+	}
+
+	bool passed = true;
+	passed &= Report("Matrix multiply", difference_multiply, g_tolerance_exact);
+	passed &= Report("Matrix invert", difference_invert, g_tolerance_invert);
+	passed &= Report("Vector4 transform", difference_transform, g_tolerance_exact);
+	passed &= Report("Quaternion multiply", difference_quaternion, g_tolerance_quaternion);
+
+	// Benchmark, the accumulators are printed so the loops can't be optimized away.
+	// A unit scale keeps the accumulated product finite, denormals and NaNs would skew the timings.
+	const Matrix transform = Matrix(Vector3(1.0f, 2.0f, 3.0f), Quaternion::FromEulerAngles(10.0f, 20.0f, 30.0f), Vector3::One);
+	Matrix accumulator_simd, accumulator_scalar, inverse_simd = transform, inverse_scalar = transform;
+
+	const double time_multiply_simd		= Time([&]() { for (int i = 0; i < g_benchmark_iterations; i++) accumulator_simd = accumulator_simd * transform; });
+	const double time_multiply_scalar	= Time([&]() { for (int i = 0; i < g_benchmark_iterations; i++) accumulator_scalar = Matrix::MultiplyScalar(accumulator_scalar, transform); });
+	const double time_invert_simd		= Time([&]() { for (int i = 0; i < g_benchmark_iterations; i++) inverse_simd = Matrix::Invert(inverse_simd); });
+	const double time_invert_scalar		= Time([&]() { for (int i = 0; i < g_benchmark_iterations; i++) inverse_scalar = Matrix::InvertScalar(inverse_scalar); });
+
+	printf("Matrix multiply x%d: simd %.1f ms, scalar %.1f ms (%.2fx)\n", g_benchmark_iterations, time_multiply_simd, time_multiply_scalar, time_multiply_scalar / time_multiply_simd);
+	printf("Matrix invert   x%d: simd %.1f ms, scalar %.1f ms (%.2fx)\n", g_benchmark_iterations, time_invert_simd, time_invert_scalar, time_invert_scalar / time_invert_simd);
+	printf("(%f %f)\n", accumulator_simd.m00 + accumulator_scalar.m00, inverse_simd.m00 + inverse_scalar.m00);
+
+	return passed ? 0 : 1;
+}
+
+#endif
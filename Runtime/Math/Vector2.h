@@ -37,11 +37,7 @@ namespace Spartan::Math
 			y = 0;
 		}
 
-		Vector2(const Vector2& vector)
-		{
-			this->x = vector.x;
-			this->y = vector.y;
-		}
+		Vector2(const Vector2& vector) = default;
 
 		Vector2(float x, float y)
 		{
@@ -67,7 +63,7 @@ namespace Spartan::Math
 			this->y = x;
 		}
 
-		~Vector2() {}
+		~Vector2() = default;
 
 		//= ADDITION ===============================
 		Vector2 operator+(const Vector2& b)
@@ -133,12 +129,12 @@ namespace Spartan::Math
 		}
 		//===================================================================================
 
-		bool operator==(const Vector2& b)
+		bool operator==(const Vector2& b) const
 		{
 			return x == b.x && y == b.y;
 		}
 
-		bool operator!=(const Vector2& b)
+		bool operator!=(const Vector2& b) const
 		{
 			return x != b.x || y != b.y;
 		}
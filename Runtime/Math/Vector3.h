@@ -42,13 +42,8 @@ namespace Spartan::Math
 			z = 0;
 		}
 
-		// Copy-constructor
-		Vector3(const Vector3& vector)
-		{
-			x = vector.x;
-			y = vector.y;
-			z = vector.z;
-		}
+		// Copy-constructor (defaulted, so that the vector stays trivially copyable)
+		Vector3(const Vector3& vector) = default;
 
         // Copy-constructor
         Vector3(const Vector4& vector);
@@ -61,7 +61,7 @@ namespace Spartan::Math
 		Vector4(const Vector3& value, float w);
 		Vector4(const Vector3& value);
 
-		~Vector4(){}
+		~Vector4() = default;
 
 		bool operator ==(const Vector4& rhs) const
 		{
@@ -250,7 +250,7 @@ namespace Spartan
 		const auto material_count	= m_resource_manager->GetResourceCount(Resource_Material);
 		const auto shader_count		= m_resource_manager->GetResourceCount(Resource_Shader);
 
-		static char buffer[1000]; // real usage is around 700
+		static char buffer[2000]; // real usage is around 1150
 		sprintf_s
 		(
 			buffer,
@@ -265,9 +265,26 @@ namespace Spartan
 			// Renderer
 			"Resolution:\t\t\t\t\t%dx%d\n"
 			"Meshes rendered:\t\t\t\t%d\n"
+			"Occluders/occluded:\t\t\t%d/%d\n"
+			"Clustered lights:\t\t\t\t%d\n"
+			"Shadow slices rendered/cached:\t%d/%d\n"
+			"Shadow casters drawn/culled:\t%d/%d\n"
+			"Shadow atlas lights/usage:\t\t%d/%.0f%%\n"
+			"Texture streaming memory/reads:\t%.2f MB/%d\n"
 			"Textures:\t\t\t\t\t%d\n"
 			"Materials:\t\t\t\t\t%d\n"
 			"Shaders:\t\t\t\t\t\t%d\n"
+			// World
+			"Entities ticked/skipped:\t\t%d/%d\n"
+			// World streaming
+			"Cells resident/pending:\t\t%d/%d\n"
+			"Cells streamed in/out:\t\t%d/%d\n"
+			"Streaming memory:\t\t\t\t%.2f MB\n"
+			"Streaming activation:\t\t\t%.2f ms\n"
+			// Resource cache
+			"Resource hits/misses:\t\t\t%llu/%llu\n"
+			"Resource evictions:\t\t\t%llu\n"
+			"Resource memory CPU/GPU:\t\t%.2f/%.2f MB\n"
 			// RHI
 			"RHI Draw calls:\t\t\t\t%d\n"
 			"RHI Index buffer bindings:\t\t%d\n"
@@ -291,9 +308,27 @@ namespace Spartan
 			// Renderer
 			static_cast<int>(m_renderer->GetResolution().x), static_cast<int>(m_renderer->GetResolution().y),
 			m_renderer_meshes_rendered,
+			m_renderer_occluders, m_renderer_occluded,
+			m_renderer_lights_clustered,
+			m_renderer_shadow_slices_rendered, m_renderer_shadow_slices_skipped,
+			m_renderer_shadow_casters, m_renderer_shadow_casters_culled,
+			m_renderer_shadow_atlas_lights, m_renderer_shadow_atlas_usage,
+			static_cast<float>(m_renderer_texture_streaming_memory) / (1024.0f * 1024.0f), m_renderer_texture_streaming_reads,
 			texture_count,
 			material_count,
 			shader_count,
+			// World
+			m_world_entities_ticked, m_world_entities_skipped,
+			// World streaming
+			m_world_cells_resident, m_world_cells_pending,
+			m_world_cells_streamed_in, m_world_cells_streamed_out,
+			static_cast<float>(m_world_streaming_memory) / (1024.0f * 1024.0f),
+			m_world_streaming_activation_ms,
+			// Resource cache
+			static_cast<unsigned long long>(m_resource_cache_hits), static_cast<unsigned long long>(m_resource_cache_misses),
+			static_cast<unsigned long long>(m_resource_cache_evictions),
+			static_cast<float>(m_resource_cache_memory_cpu) / (1024.0f * 1024.0f),
+			static_cast<float>(m_resource_cache_memory_gpu) / (1024.0f * 1024.0f),
 			// RHI
 			m_rhi_draw_calls,
 			m_rhi_bindings_buffer_index,
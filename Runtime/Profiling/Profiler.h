@@ -96,6 +96,36 @@ namespace Spartan
 
 		// Metrics - Renderer
 		uint32_t m_renderer_meshes_rendered = 0;
+		uint32_t m_renderer_occluders		= 0;
+		uint32_t m_renderer_occluded		= 0; // by occlusion culling
+		uint32_t m_renderer_lights_clustered	= 0;
+		uint32_t m_renderer_shadow_slices_rendered	= 0;
+		uint32_t m_renderer_shadow_slices_skipped	= 0; // cached
+		uint32_t m_renderer_shadow_casters			= 0; // summed over all shadow map slices
+		uint32_t m_renderer_shadow_casters_culled	= 0; // by the receivers
+		uint32_t m_renderer_shadow_atlas_lights		= 0; // point and spot lights with tiles
+		float m_renderer_shadow_atlas_usage			= 0.0f; // percent of the atlas
+		uint64_t m_renderer_texture_streaming_memory	= 0; // mips resident on the GPU, of the streamed textures
+		uint32_t m_renderer_texture_streaming_reads		= 0; // in flight
+
+		// Metrics - World
+		uint32_t m_world_entities_ticked		= 0;
+		uint32_t m_world_entities_skipped		= 0; // by the update LOD
+
+		// Metrics - World streaming
+		uint32_t m_world_cells_resident			= 0;
+		uint32_t m_world_cells_pending			= 0; // loading or activating
+		uint32_t m_world_cells_streamed_in		= 0;
+		uint32_t m_world_cells_streamed_out		= 0;
+		uint64_t m_world_streaming_memory		= 0;
+		float m_world_streaming_activation_ms	= 0.0f;
+
+		// Metrics - Resource cache
+		uint64_t m_resource_cache_hits			= 0; // lookups, since startup
+		uint64_t m_resource_cache_misses		= 0;
+		uint64_t m_resource_cache_evictions		= 0;
+		uint64_t m_resource_cache_memory_cpu	= 0;
+		uint64_t m_resource_cache_memory_gpu	= 0;
 
 		// Metrics - Time
 		float m_time_frame_ms	= 0.0f;
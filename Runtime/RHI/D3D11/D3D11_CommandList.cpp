@@ -345,6 +345,20 @@ namespace Spartan
 		cmd.depth_clear_stencil = stencil;
 	}
 
+	void RHI_CommandList::CopyDepthStencil(void* depth_stencil_source, void* depth_stencil_destination)
+	{
+		if (!depth_stencil_source || !depth_stencil_destination)
+		{
+			LOG_ERROR("Provided depth stencil is null");
+			return;
+		}
+
+		auto& cmd						= GetCmd();
+		cmd.type						= RHI_Cmd_CopyDepthStencil;
+		cmd.depth_stencil_copy_source	= depth_stencil_source;
+		cmd.depth_stencil				= depth_stencil_destination;
+	}
+
 	bool RHI_CommandList::Submit(bool profile /*=true*/)
 	{
 		auto context		= m_rhi_device->GetContextRhi();
@@ -616,6 +630,39 @@ namespace Spartan
 
 					break;
 				}
+
+				case RHI_Cmd_CopyDepthStencil:
+				{
+					// Depth stencil copies have to cover a whole subresource, so resolve the views to their texture and array slice
+					auto view_source		= static_cast<ID3D11DepthStencilView*>(cmd.depth_stencil_copy_source);
+					auto view_destination	= static_cast<ID3D11DepthStencilView*>(cmd.depth_stencil);
+					const auto array_slice	= [](ID3D11DepthStencilView* view)
+					{
+						D3D11_DEPTH_STENCIL_VIEW_DESC desc;
+						view->GetDesc(&desc);
+						return desc.ViewDimension == D3D11_DSV_DIMENSION_TEXTURE2DARRAY ? desc.Texture2DArray.FirstArraySlice : 0;
+					};
+
+					ID3D11Resource* resource_source			= nullptr;
+					ID3D11Resource* resource_destination	= nullptr;
+					view_source->GetResource(&resource_source);
+					view_destination->GetResource(&resource_destination);
+
+					device_context->CopySubresourceRegion
+					(
+						resource_destination,
+						D3D11CalcSubresource(0, array_slice(view_destination), 1),
+						0, 0, 0,
+						resource_source,
+						D3D11CalcSubresource(0, array_slice(view_source), 1),
+						nullptr
+					);
+
+					safe_release(resource_source);
+					safe_release(resource_destination);
+
+					break;
+				}
 			}
 		}
 
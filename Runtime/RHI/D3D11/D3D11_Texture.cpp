@@ -57,7 +57,7 @@ namespace Spartan
 		const uint32_t array_size,
 		const RHI_Format format,
 		const UINT bind_flags,
-		std::vector<std::vector<std::byte>>& data,
+		const std::vector<std::vector<std::byte>>& data,
 		const shared_ptr<RHI_Device>& rhi_device
 	)
 	{
@@ -152,7 +152,7 @@ namespace Spartan
 		return true;
 	}
 
-	inline bool CreateShaderResourceView(void* resource, void*& shader_resource_view, RHI_Format format, uint32_t array_size, std::vector<std::vector<std::byte>>& data, const shared_ptr<RHI_Device>& rhi_device)
+	inline bool CreateShaderResourceView(void* resource, void*& shader_resource_view, RHI_Format format, uint32_t array_size, const std::vector<std::vector<std::byte>>& data, const shared_ptr<RHI_Device>& rhi_device)
 	{
 		// Describe
 		D3D11_SHADER_RESOURCE_VIEW_DESC shader_resource_view_desc	= {};
@@ -175,7 +175,7 @@ namespace Spartan
 		return true;
 	}
 
-	bool RHI_Texture2D::CreateResourceGpu()
+	bool RHI_Texture2D::CreateResourceGpu(const vector<vector<std::byte>>& mips)
 	{
 		if (!m_rhi_device->GetContextRhi()->device)
 		{
@@ -207,19 +207,19 @@ namespace Spartan
 			format_srv		= Format_R32_FLOAT;
 		}
 
-		// TEXTURE
+		// TEXTURE (streamed textures are created at the size of their finest resident mip)
 		void* texture = nullptr;
 		result_tex = CreateTexture
 		(
 			texture,
-			m_width,
-			m_height,
+			Max(m_width >> m_mip_resident, 1u),
+			Max(m_height >> m_mip_resident, 1u),
 			m_channels,
 			m_bpc,
 			m_array_size,
 			format,
 			bind_flags,
-			m_data,
+			mips,
 			m_rhi_device
 		);
 
@@ -252,14 +252,23 @@ namespace Spartan
 		// SHADER RESOURCE VIEW
 		if (m_bind_flags & RHI_Texture_Sampled)
 		{
-			result_srv = CreateShaderResourceView(
+			// Streaming mips in or out creates the texture again, the current view is only replaced
+			// once the new one exists, so a failed upload keeps what was resident.
+			void* resource_texture = nullptr;
+			result_srv = result_tex && CreateShaderResourceView(
 				texture,
-				m_resource_texture,
+				resource_texture,
 				format_srv,
 				m_array_size,
-				m_data,
+				mips,
 				m_rhi_device
 			);
+
+			if (result_srv)
+			{
+				safe_release(static_cast<ID3D11ShaderResourceView*>(m_resource_texture));
+				m_resource_texture = resource_texture;
+			}
 		}
 
 		safe_release(reinterpret_cast<ID3D11Texture2D*>(texture));	
@@ -477,7 +486,7 @@ namespace Spartan
 		return true;
 	}
 
-	bool RHI_TextureCube::CreateResourceGpu()
+	bool RHI_TextureCube::CreateResourceGpu(const vector<vector<std::byte>>& mips)
 	{
 		auto result = true;
 
@@ -57,7 +57,8 @@ namespace Spartan
 		RHI_Cmd_SetTextures,
 		RHI_Cmd_SetRenderTargets,
 		RHI_Cmd_ClearRenderTarget,
-		RHI_Cmd_ClearDepthStencil
+		RHI_Cmd_ClearDepthStencil,
+		RHI_Cmd_CopyDepthStencil
 	};
 
 	struct RHI_Command
@@ -90,6 +91,7 @@ namespace Spartan
 			depth_clear					= 0;
 			depth_clear_stencil			= 0;
 			depth_clear_flags			= 0;
+			depth_stencil_copy_source	= nullptr;
 			vertex_count				= 0;
 			vertex_offset				= 0;
 			index_count					= 0;
@@ -136,6 +138,7 @@ namespace Spartan
 		float depth_clear									= 0;
 		uint32_t depth_clear_stencil						= 0;
 		uint32_t depth_clear_flags							= 0;
+		void* depth_stencil_copy_source						= nullptr;
 
 		// Misc	
 		bool is_array                                   = true;
@@ -239,6 +242,8 @@ namespace Spartan
 			}
 		}
 		void ClearDepthStencil(void* depth_stencil, uint32_t flags, float depth, uint32_t stencil = 0);
+		// Copies a whole depth stencil (a single array slice when the views are of texture arrays), both have to match in size and format
+		void CopyDepthStencil(void* depth_stencil_source, void* depth_stencil_destination);
 
 		bool Submit(bool profile = true);
 
@@ -0,0 +1,74 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==================
+#include <memory>
+#include "../Core/EngineDefs.h"
+#include "../Core/Spartan_Object.h"
+//=============================
+
+namespace Spartan
+{
+	// A cpu writable array of structures that shaders read through a shader resource view (bound like a texture)
+	class SPARTAN_CLASS RHI_StructuredBuffer : public Spartan_Object
+	{
+	public:
+		RHI_StructuredBuffer(const std::shared_ptr<RHI_Device>& rhi_device)
+		{
+			m_rhi_device = rhi_device;
+		}
+		~RHI_StructuredBuffer();
+
+		// Re-creates the buffer only when it has to grow
+		template<typename T>
+		bool Create(const uint32_t element_count)
+		{
+			if (m_buffer && sizeof(T) == m_stride && element_count <= m_element_count)
+				return true;
+
+			m_stride		= static_cast<uint32_t>(sizeof(T));
+			m_element_count	= element_count > 1 ? element_count : 1;
+			m_size			= static_cast<uint64_t>(m_stride) * m_element_count;
+			return _Create();
+		}
+
+		void* Map() const;
+		bool Unmap() const;
+		auto GetResource() const			{ return m_buffer; }
+		auto GetResource_Texture() const	{ return m_resource_view; }
+		auto GetStride() const				{ return m_stride; }
+		auto GetElementCount() const		{ return m_element_count; }
+
+	private:
+		bool _Create();
+
+		std::shared_ptr<RHI_Device> m_rhi_device;
+		uint32_t m_stride			= 0;
+		uint32_t m_element_count	= 0;
+
+		// API
+		void* m_buffer			= nullptr;
+		void* m_buffer_memory	= nullptr;
+		void* m_resource_view	= nullptr;
+	};
+}
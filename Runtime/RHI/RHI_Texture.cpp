@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../IO/FileStream.h"
 #include "../Rendering/Renderer.h"
 #include "../Resource/ResourceCache.h"
+#include "../Threading/Threading.h"
 //====================================
 
 //= NAMESPACES =====
@@ -32,6 +33,31 @@ using namespace std;
 
 namespace Spartan
 {
+	// Texture files start with a header, files without it predate the block compressed mips
+	static const uint32_t g_texture_file_magic		= 0x58455453; // "STEX"
+	static const uint32_t g_texture_file_version	= 1;
+
+	// Streamed textures load the mips up to this size (128x128 RGBA8) right away, always the smallest one at least
+	static const uint32_t g_texture_mip_size_initial = 64 * 1024;
+
+	// Reads the mip chain of a file which predates the header, whatever else is in it is left alone
+	static bool ReadMipChainLegacy(const string& file_path, vector<vector<std::byte>>* mips)
+	{
+		auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped);
+		if (!file->IsOpen() || file->ReadAs<uint32_t>() == g_texture_file_magic)
+			return false;
+
+		file->Seek(0);
+		file->ReadAs<uint32_t>(); // byte count
+		mips->resize(file->ReadAs<uint32_t>());
+		for (auto& mip : *mips)
+		{
+			file->Read(&mip);
+		}
+
+		return !mips->empty();
+	}
+
 	RHI_Texture::RHI_Texture(Context* context) : IResource(context, Resource_Texture)
 	{
 		m_rhi_device = context->GetSubsystem<Renderer>()->GetRhiDevice();
@@ -45,50 +71,54 @@ namespace Spartan
 
 	bool RHI_Texture::SaveToFile(const string& file_path)
 	{
-		// Check to see if the file already exists (if so, get the byte count)
-		uint32_t byte_count = 0;
+		// If the file already has our mip chain but we hold no data
+		// (it was freed after saving), keep the file's mip chain.
+		const auto keep_bytes = m_data.empty() && m_mip_chain_size_file != 0 && FileSystem::FileExists(file_path);
+
+		// A file in the older format can't be kept like that (the header comes first now), so its mip chain is read
+		// again and rewritten in the current format. Without any mips to write, the file is left as it is.
+		vector<vector<std::byte>> mips_file;
+		if (m_data.empty() && !keep_bytes && !ReadMipChainLegacy(file_path, &mips_file))
 		{
-			if (FileSystem::FileExists(file_path))
-			{
-				auto file = make_unique<FileStream>(file_path, FileStream_Read);
-				if (file->IsOpen())
-				{
-					file->Read(&byte_count);
-				}
-			}
+			LOGF_ERROR("No mips to save \"%s\" with", file_path.c_str());
+			return false;
 		}
+		const auto& mips = m_data.empty() ? mips_file : m_data;
 
-		auto append = true;
-		auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Append);
+		auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Update | FileStream_Async);
 		if (!file->IsOpen())
 			return false;
 
-		// If the existing file has a byte count but we 
-		// hold no data, don't overwrite the file's bytes.
-		if (byte_count != 0 && m_data.empty())
+		// Write header
+		file->Write(g_texture_file_magic);
+		file->Write(g_texture_file_version);
+
+		if (keep_bytes)
 		{
-			file->Skip
-			(
-				sizeof(uint32_t) +	// byte count
-				sizeof(uint32_t) +	// mipmap count
-				byte_count			// bytes
-			);
+			file->Skip(m_mip_chain_size_file);
 		}
 		else
 		{
-			byte_count = GetByteCount();
+			const auto mip_chain_start	= file->GetPosition();
+			const auto threading		= m_context->GetSubsystem<Threading>().get();
 
 			// Write byte count
+			uint32_t byte_count = 0;
+			for (const auto& mip : mips)
+			{
+				byte_count += static_cast<uint32_t>(mip.size());
+			}
 			file->Write(byte_count);
 			// Write mipmap count
-			file->Write(static_cast<uint32_t>(m_data.size()));
+			file->Write(static_cast<uint32_t>(mips.size()));
 			// Write bytes
-			for (auto& mip : m_data)
+			for (const auto& mip : mips)
 			{
-				file->Write(mip);
+				file->WriteBlocks(mip, m_file_compression, threading);
 			}
+			m_mip_chain_size_file = static_cast<uint32_t>(file->GetPosition() - mip_chain_start);
 
-			// The bytes have been saved, so we can now free some memory
+			// The bytes have been staged for writing, so we can now free some memory
 			m_data.clear();
 			m_data.shrink_to_fit();
 		}
@@ -142,6 +172,7 @@ namespace Spartan
 		}
 
 		// Create GPU resource
+		m_mip_chain_size_gpu = GetByteCount();
 		if (!CreateResourceGpu())
 		{
 			LOGF_ERROR("Failed to create shader resource for \"%s\".", GetResourceFilePath().c_str());
@@ -177,6 +208,12 @@ namespace Spartan
 		if (!imageImp->Load(file_path, this, generate_mipmaps))
 			return false;
 
+		// The whole mip chain is in memory, nothing to stream
+		m_mip_count		= static_cast<uint32_t>(m_data.size());
+		m_mip_streamed	= false;
+		m_mip_initial	= 0;
+		m_mip_resident	= 0;
+
 		// Change texture extension to an engine texture
 		SetResourceFilePath(FileSystem::GetFilePathWithoutExtension(file_path) + EXTENSION_TEXTURE);
 		SetResourceName(FileSystem::GetFileNameNoExtensionFromFilePath(GetResourceFilePath()));
@@ -186,23 +223,69 @@ namespace Spartan
 
 	bool RHI_Texture::LoadFromFile_NativeFormat(const string& file_path)
 	{
-		auto file = make_unique<FileStream>(file_path, FileStream_Read);
+		auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped);
 		if (!file->IsOpen())
 			return false;
 
 		m_data.clear();
 		m_data.shrink_to_fit();
 
+		// Read header, older files start with the byte count right away
+		const auto has_header = file->ReadAs<uint32_t>() == g_texture_file_magic;
+		if (has_header)
+		{
+			const auto version = file->ReadAs<uint32_t>();
+			if (version > g_texture_file_version)
+			{
+				LOGF_ERROR("\"%s\" was saved by a newer version (%d) of the texture format", file_path.c_str(), version);
+				return false;
+			}
+		}
+		else
+		{
+			file->Seek(0);
+		}
+		const auto mip_chain_start	= file->GetPosition();
+		const auto threading		= m_context->GetSubsystem<Threading>().get();
+
 		// Read byte and mipmap count
 		auto byte_count		= file->ReadAs<uint32_t>();
 		auto mipmap_count	= file->ReadAs<uint32_t>();
 
-		// Read bytes
-		m_data.resize(mipmap_count);
-		for (auto& mip : m_data)
+		// Read bytes, a texture with a mip chain (in the current format) skips the mips which it's too early for
+		m_mip_count		= mipmap_count;
+		m_mip_initial	= 0;
+		m_mip_streamed	= has_header && mipmap_count > 1;
+		m_data.reserve(mipmap_count);
+		for (uint32_t mip = 0; mip < mipmap_count; mip++)
 		{
-			file->Read(&mip);
+			if (!has_header)
+			{
+				file->Read(&m_data.emplace_back());
+				continue;
+			}
+
+			if (m_mip_streamed && mip + 1 < mipmap_count)
+			{
+				// The byte count comes first
+				const auto position	= file->GetPosition();
+				const auto size		= file->ReadAs<uint32_t>();
+				file->Seek(position);
+
+				if (size > g_texture_mip_size_initial)
+				{
+					file->SkipBlocks(sizeof(std::byte));
+					m_mip_initial = mip + 1;
+					continue;
+				}
+			}
+
+			file->ReadBlocks(&m_data.emplace_back(), threading);
 		}
+		m_mip_resident = m_mip_initial;
+
+		// Only a chain in the current format can be kept when saving without the data in memory, older ones are read again
+		m_mip_chain_size_file = has_header ? static_cast<uint32_t>(file->GetPosition() - mip_chain_start) : 0;
 
 		// Read properties
 		file->Read(&m_bpp);
@@ -240,6 +323,107 @@ namespace Spartan
 		}
 	}
 
+	uint64_t RHI_Texture::GetMipChainSize(const uint32_t mip) const
+	{
+		uint64_t size = 0;
+		for (auto i = mip; i < m_mip_count; i++)
+		{
+			size += static_cast<uint64_t>(Math::Max(m_width >> i, 1u)) * Math::Max(m_height >> i, 1u) * m_channels * (m_bpc / 8);
+		}
+
+		return size;
+	}
+
+	bool RHI_Texture::StreamRead(const uint32_t mip, vector<vector<std::byte>>* mips)
+	{
+		if (!m_mip_streamed || mip >= m_mip_count || !mips)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		auto file = make_unique<FileStream>(GetResourceFilePath(), FileStream_Read | FileStream_Mapped);
+		if (!file->IsOpen())
+			return false;
+
+		// Header, byte count and mipmap count, the file might have been replaced since the texture was loaded
+		const auto magic	= file->ReadAs<uint32_t>();
+		const auto version	= file->ReadAs<uint32_t>();
+		file->ReadAs<uint32_t>();
+		if (magic != g_texture_file_magic || version > g_texture_file_version || file->ReadAs<uint32_t>() != m_mip_count)
+		{
+			LOGF_ERROR("\"%s\" doesn't match the texture anymore", GetResourceFilePath().c_str());
+			return false;
+		}
+
+		// Skip the finer mips, read the rest
+		mips->clear();
+		mips->resize(m_mip_count - mip);
+		for (uint32_t i = 0; i < m_mip_count; i++)
+		{
+			if (i < mip)
+			{
+				file->SkipBlocks(sizeof(std::byte));
+			}
+			else
+			{
+				file->ReadBlocks(&(*mips)[i - mip]);
+			}
+		}
+
+		return true;
+	}
+
+	bool RHI_Texture::StreamUpload(const uint32_t mip, vector<vector<std::byte>>& mips)
+	{
+		if (!m_mip_streamed || mip >= m_mip_count || mips.size() != m_mip_count - mip)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return false;
+		}
+
+		// Straight from the mips that were read, m_data belongs to loading and saving (which can be on another thread).
+		// The resource is created at the size of the resident mip, if that fails the previous resource and mip remain.
+		const auto mip_resident	= m_mip_resident;
+		m_mip_resident			= mip;
+		const auto created		= CreateResourceGpu(mips);
+		mips.clear();
+		mips.shrink_to_fit();
+
+		if (!created)
+		{
+			m_mip_resident = mip_resident;
+			LOGF_ERROR("Failed to create the GPU resource of \"%s\" with mip %d", GetResourceFilePath().c_str(), mip);
+			return false;
+		}
+
+		m_mip_chain_size_gpu = GetMipChainSize(mip);
+		return true;
+	}
+
+	uint64_t RHI_Texture::GetMemoryUsageCpu()
+	{
+		uint64_t size = sizeof(*this);
+		for (const auto& mip : m_data)
+		{
+			size += mip.capacity();
+		}
+
+		return size;
+	}
+
+	uint64_t RHI_Texture::GetMemoryUsageGpu()
+	{
+		if (!m_resource_texture && !m_resource_render_target && m_resource_depth_stencils.empty())
+			return 0;
+
+		// Loaded textures know the size of their mip chain, render targets and the like have a single mip
+		if (m_mip_chain_size_gpu != 0)
+			return m_mip_chain_size_gpu;
+
+		return static_cast<uint64_t>(m_width) * m_height * GetChannelCountFromFormat(m_format) * (m_bpc / 8) * m_array_size;
+	}
+
 	uint32_t RHI_Texture::GetByteCount()
 	{
 		uint32_t byte_count = 0;
@@ -46,6 +46,8 @@ namespace Spartan
 		//= IResource ===========================================
 		bool SaveToFile(const std::string& file_path) override;
 		bool LoadFromFile(const std::string& file_path) override;
+		uint64_t GetMemoryUsageCpu() override;
+		uint64_t GetMemoryUsageGpu() override;
 		//=======================================================
 
 		auto GetWidth() const											{ return m_width; }
@@ -79,6 +81,17 @@ namespace Spartan
 		auto AddMipmap()												{ return &m_data.emplace_back(std::vector<std::byte>()); }
         bool HasMipmaps()                                               { return m_data.size() > 1;  }
 
+		// Mip streaming. Textures loaded from engine files with a mip chain start with their smallest mips only, the finer
+		// mips are read from the file with StreamRead() (on any thread) and made resident with StreamUpload() (on the
+		// rendering thread), see TextureStreamer. Mips are counted from the finest one, so a lower mip is a bigger one.
+		bool IsStreamed() const											{ return m_mip_streamed; }
+		auto GetMipCount() const										{ return m_mip_count; }
+		auto GetMipResident() const										{ return m_mip_resident; }
+		auto GetMipInitial() const										{ return m_mip_initial; }
+		uint64_t GetMipChainSize(uint32_t mip) const;
+		bool StreamRead(uint32_t mip, std::vector<std::vector<std::byte>>* mips);
+		bool StreamUpload(uint32_t mip, std::vector<std::vector<std::byte>>& mips);
+
 		// GPU resources
 		auto GetResource_Texture() const								{ return m_resource_texture; }
 		auto GetResource_RenderTarget()	const							{ return m_resource_render_target; }
@@ -90,7 +103,9 @@ namespace Spartan
 		bool LoadFromFile_NativeFormat(const std::string& file_path);
 		bool LoadFromFile_ForeignFormat(const std::string& file_path, bool generate_mipmaps);
 		static uint32_t GetChannelCountFromFormat(RHI_Format format);
-		virtual bool CreateResourceGpu() { return false; }
+		// Creates the GPU resource from the given mips, the finest resident one first (render targets and the like have none)
+		virtual bool CreateResourceGpu(const std::vector<std::vector<std::byte>>& mips) { return false; }
+		bool CreateResourceGpu() { return CreateResourceGpu(m_data); }
 
 		uint32_t m_bpp			= 0;
 		uint32_t m_bpc			= 8;
@@ -104,6 +119,12 @@ namespace Spartan
 		bool m_generate_mipmaps_when_loading = false;
 		RHI_Viewport m_viewport;
 		std::vector<std::vector<std::byte>> m_data;
+		uint32_t m_mip_chain_size_file = 0; // Size of the mip chain in the file, lets a save without data in memory keep it
+		uint64_t m_mip_chain_size_gpu	= 0; // Size of the mip chain that was uploaded, the data might be gone by now
+		bool m_mip_streamed				= false;
+		uint32_t m_mip_count			= 0; // in the file
+		uint32_t m_mip_initial			= 0; // the finest mip that gets loaded with the texture
+		uint32_t m_mip_resident			= 0; // the finest mip on the GPU
 		
 		// Dependencies
 		std::shared_ptr<RHI_Device> m_rhi_device;
@@ -87,6 +87,7 @@ namespace Spartan
 		~RHI_Texture2D();
 
 		// RHI_Texture
-		bool CreateResourceGpu() override;
+		using RHI_Texture::CreateResourceGpu;
+		bool CreateResourceGpu(const std::vector<std::vector<std::byte>>& mips) override;
 	};
 }
@@ -63,8 +63,9 @@ namespace Spartan
 
 		~RHI_TextureCube();
 
-		// RHI_Texture
-		bool CreateResourceGpu() override;
+		// RHI_Texture (the faces come from m_data_cube)
+		using RHI_Texture::CreateResourceGpu;
+		bool CreateResourceGpu(const std::vector<std::vector<std::byte>>& mips) override;
 
 	private:
 		std::vector<std::vector<std::vector<std::byte>>> m_data_cube;
@@ -324,6 +324,11 @@ namespace Spartan
 		SPARTAN_ASSERT(m_is_recording);
 	}
 
+	void RHI_CommandList::CopyDepthStencil(void* depth_stencil_source, void* depth_stencil_destination)
+	{
+		SPARTAN_ASSERT(m_is_recording);
+	}
+
 	bool RHI_CommandList::Submit(bool profile/*=true*/)
 	{
 		auto swap_chain = m_pipeline->GetState()->swap_chain;
@@ -337,7 +337,7 @@ namespace Spartan
         return vkCreateImageView(rhi_device->GetContextRhi()->device, &create_info, nullptr, image_view);
     }
 
-	bool RHI_Texture2D::CreateResourceGpu()
+	bool RHI_Texture2D::CreateResourceGpu(const vector<vector<std::byte>>& mips)
 	{
         // In case of a render target or a depth-stencil buffer, ensure the requested format is supported by the device
         VkFormat image_format       = vulkan_format[m_format];
@@ -358,12 +358,16 @@ namespace Spartan
             }
         }
 
+		// Streamed textures are created at the size of their finest resident mip
+		const auto width	= Max(m_width >> m_mip_resident, 1u);
+		const auto height	= Max(m_height >> m_mip_resident, 1u);
+
 		// Copy data to a buffer (if there are any)
 		VkBuffer staging_buffer = nullptr;
 		VkDeviceMemory staging_buffer_memory = nullptr;
-		if (!m_data.empty())
+		if (!mips.empty())
 		{
-			VkDeviceSize buffer_size = static_cast<uint64_t>(m_width) * static_cast<uint64_t>(m_height) * static_cast<uint64_t>(m_channels);
+			VkDeviceSize buffer_size = static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * static_cast<uint64_t>(m_channels);
 
 			// Create buffer
 			if (!Vulkan_Common::buffer::create(m_rhi_device, staging_buffer, staging_buffer_memory, buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT))
@@ -372,7 +376,7 @@ namespace Spartan
 			// Copy to buffer
 			void* data = nullptr;
 			vkMapMemory(m_rhi_device->GetContextRhi()->device, staging_buffer_memory, 0, buffer_size, 0, &data);
-			memcpy(data, m_data.front().data(), static_cast<size_t>(buffer_size));
+			memcpy(data, mips.front().data(), static_cast<size_t>(buffer_size));
 			vkUnmapMemory(m_rhi_device->GetContextRhi()->device, staging_buffer_memory);
 		}
 
@@ -386,15 +390,45 @@ namespace Spartan
         usage_flags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // specifies that the image can be used as the source of a transfer command.
         usage_flags |= VK_IMAGE_USAGE_TRANSFER_DST_BIT; // specifies that the image can be used as the destination of a transfer command.
 
+		// Streaming mips in or out creates the texture again. The new image (and it's sampled view) is created aside
+		// and only replaces the current one once everything succeeded, so a failed upload keeps what was resident.
+		void* texture			= nullptr;
+		void* texture_memory	= nullptr;
+		void* resource_texture	= nullptr;
+		const auto vk_device	= m_rhi_device->GetContextRhi()->device;
+		const auto release		= [this, vk_device, &staging_buffer, &staging_buffer_memory, &texture, &texture_memory, &resource_texture](const bool keep)
+		{
+			if (staging_buffer && staging_buffer_memory)
+			{
+				vkDestroyBuffer(vk_device, staging_buffer, nullptr);
+				vkFreeMemory(vk_device, staging_buffer_memory, nullptr);
+			}
+
+			if (keep)
+				return;
+
+			if (resource_texture)
+			{
+				vkDestroyImageView(vk_device, reinterpret_cast<VkImageView>(resource_texture), nullptr);
+			}
+
+			if (texture)
+			{
+				vkDestroyImage(vk_device, reinterpret_cast<VkImage>(texture), nullptr);
+			}
+
+			Vulkan_Common::memory::free(m_rhi_device, texture_memory);
+		};
+
 		// Create image
-		auto image = reinterpret_cast<VkImage*>(&m_texture);
-        auto image_memory = reinterpret_cast<VkDeviceMemory*>(&m_texture_memory);
+		auto image = reinterpret_cast<VkImage*>(&texture);
+        auto image_memory = reinterpret_cast<VkDeviceMemory*>(&texture_memory);
 		auto result = CreateImage(
 				m_rhi_device,
 				image,
 				image_memory,
-				m_width,
-				m_height,
+				width,
+				height,
                 image_format,
                 image_tiling,
 				usage_flags,
@@ -403,6 +437,7 @@ namespace Spartan
 		if (result != VK_SUCCESS)
 		{
 			LOGF_ERROR("Failed to create image, %s", Vulkan_Common::to_string(result));
+			release(false);
 			return false;
 		}
 
@@ -416,9 +451,10 @@ namespace Spartan
 
 			// Copy
 			lock_guard<mutex> lock(m_mutex); // Mutex prevents this error: THREADING ERROR : object of type VkQueue is simultaneously used in thread 0xfe0 and thread 0xe18
-			if (!CopyBufferToImage(m_rhi_device, static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height), *image, staging_buffer, cmd_pool))
+			if (!CopyBufferToImage(m_rhi_device, width, height, *image, staging_buffer, cmd_pool))
 			{
 				LOG_ERROR("Failed to copy buffer to image");
+				release(false);
 				return false;
 			}
 		}
@@ -430,6 +466,7 @@ namespace Spartan
             if (result != VK_SUCCESS)
             {
                 LOGF_ERROR("Failed to create render target view, %s", Vulkan_Common::to_string(result));
+                release(false);
                 return false;
             }
         }
@@ -442,6 +479,7 @@ namespace Spartan
             if (result != VK_SUCCESS)
             {
                 LOGF_ERROR("Failed to create depth stencil view, %s", Vulkan_Common::to_string(result));
+                release(false);
                 return false;
             }
         }
@@ -449,20 +487,29 @@ namespace Spartan
         // SAMPLED
         if (m_bind_flags & RHI_Texture_Sampled)
         {
-            result = CreateImageView(m_rhi_device, image, reinterpret_cast<VkImageView*>(&m_resource_texture), image_format, m_bind_flags);
+            result = CreateImageView(m_rhi_device, image, reinterpret_cast<VkImageView*>(&resource_texture), image_format, m_bind_flags);
             if (result != VK_SUCCESS)
             {
                 LOGF_ERROR("Failed to create sampled image view, %s", Vulkan_Common::to_string(result));
+                release(false);
                 return false;
             }
         }
 
-		// Release staging buffer
-		if (staging_buffer && staging_buffer_memory)
+		// Replace the previous image (if any) with the new one
+		release(true);
+		if (m_resource_texture)
+		{
+			vkDestroyImageView(vk_device, reinterpret_cast<VkImageView>(m_resource_texture), nullptr);
+		}
+		if (m_texture)
 		{
-			vkDestroyBuffer(m_rhi_device->GetContextRhi()->device, staging_buffer, nullptr);
-			vkFreeMemory(m_rhi_device->GetContextRhi()->device, staging_buffer_memory, nullptr);
+			vkDestroyImage(vk_device, reinterpret_cast<VkImage>(m_texture), nullptr);
 		}
+		Vulkan_Common::memory::free(m_rhi_device, m_texture_memory);
+		m_texture			= texture;
+		m_texture_memory	= texture_memory;
+		m_resource_texture	= resource_texture;
 
 		return true;
 	}
@@ -477,7 +524,7 @@ namespace Spartan
 		Vulkan_Common::memory::free(m_rhi_device, m_texture_memory);
 	}
 
-	bool RHI_TextureCube::CreateResourceGpu()
+	bool RHI_TextureCube::CreateResourceGpu(const vector<vector<std::byte>>& mips)
 	{
 		return true;
 	}
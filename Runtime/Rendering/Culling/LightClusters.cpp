@@ -0,0 +1,214 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "LightClusters.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+//=============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+	LightClusters::LightClusters(const uint32_t tile_count_x, const uint32_t tile_count_y, const uint32_t slice_count)
+	{
+		m_tile_count_x	= Max(tile_count_x, 1u);
+		m_tile_count_y	= Max(tile_count_y, 1u);
+		m_slice_count	= Max(slice_count, 1u);
+
+		m_cluster_bounds.resize(GetClusterCount());
+		m_cluster_lights.resize(GetClusterCount());
+		m_slice_depths.resize(m_slice_count + 1, 0.0f);
+		m_grid.resize(GetClusterCount() * 2, 0);
+	}
+
+	void LightClusters::Begin(const Matrix& view, const Matrix& projection, const float near_plane, const float far_plane, const uint32_t light_count)
+	{
+		m_view = view;
+		m_lights.resize(light_count);
+
+		if (projection == m_projection && near_plane == m_near_plane && far_plane == m_far_plane)
+			return;
+
+		m_projection	= projection;
+		m_near_plane	= Max(near_plane, 0.001f);
+		m_far_plane		= Max(far_plane, m_near_plane + 0.001f);
+
+		// Exponential slices, so that clusters stay roughly cubic as they get further away
+		const float log_range	= log(m_far_plane / m_near_plane);
+		m_slice_scale			= static_cast<float>(m_slice_count) / log_range;
+		m_slice_bias			= -static_cast<float>(m_slice_count) * log(m_near_plane) / log_range;
+
+		// View space bounds of every cluster, from the x and y of its tile at the near and far depth of its slice
+		const auto view_x = [this](const float ndc_x, const float z) { return (ndc_x * (z * m_projection.m23 + m_projection.m33) - z * m_projection.m20 - m_projection.m30) / m_projection.m00; };
+		const auto view_y = [this](const float ndc_y, const float z) { return (ndc_y * (z * m_projection.m23 + m_projection.m33) - z * m_projection.m21 - m_projection.m31) / m_projection.m11; };
+		for (uint32_t slice = 0; slice <= m_slice_count; slice++)
+		{
+			m_slice_depths[slice] = m_near_plane * pow(m_far_plane / m_near_plane, static_cast<float>(slice) / m_slice_count);
+		}
+
+		for (uint32_t slice = 0; slice < m_slice_count; slice++)
+		{
+			const float z_near	= m_slice_depths[slice];
+			const float z_far	= m_slice_depths[slice + 1];
+
+			for (uint32_t y = 0; y < m_tile_count_y; y++)
+			{
+				// Tile rows go from the top of the screen to the bottom
+				const float ndc_top		= 1.0f - 2.0f * y / m_tile_count_y;
+				const float ndc_bottom	= 1.0f - 2.0f * (y + 1) / m_tile_count_y;
+
+				for (uint32_t x = 0; x < m_tile_count_x; x++)
+				{
+					const float ndc_left	= -1.0f + 2.0f * x / m_tile_count_x;
+					const float ndc_right	= -1.0f + 2.0f * (x + 1) / m_tile_count_x;
+
+					const float x0 = view_x(ndc_left, z_near), x1 = view_x(ndc_left, z_far), x2 = view_x(ndc_right, z_near), x3 = view_x(ndc_right, z_far);
+					const float y0 = view_y(ndc_bottom, z_near), y1 = view_y(ndc_bottom, z_far), y2 = view_y(ndc_top, z_near), y3 = view_y(ndc_top, z_far);
+					m_cluster_bounds[GetCluster(x, y, slice)] = BoundingBox
+					(
+						Vector3(Min(Min(x0, x1), Min(x2, x3)), Min(Min(y0, y1), Min(y2, y3)), z_near),
+						Vector3(Max(Max(x0, x1), Max(x2, x3)), Max(Max(y0, y1), Max(y2, y3)), z_far)
+					);
+				}
+			}
+		}
+	}
+
+	void LightClusters::SetLight(const uint32_t index, const Vector3& position, const float range)
+	{
+		ClusterLight& light	= m_lights[index];
+		light.center		= position * m_view;
+		light.radius		= range;
+		light.slice_min		= 1;
+		light.slice_max		= 0;
+
+		const float z_min = light.center.z - range;
+		const float z_max = light.center.z + range;
+		if (range <= 0.0f || z_max < m_near_plane || z_min > m_far_plane)
+			return;
+
+		const auto slice = [this](const float z) { return static_cast<uint32_t>(Clamp(floor(log(z) * m_slice_scale + m_slice_bias), 0.0f, static_cast<float>(m_slice_count - 1))); };
+		light.slice_min = slice(Max(z_min, m_near_plane));
+		light.slice_max = slice(Min(z_max, m_far_plane));
+	}
+
+	void LightClusters::Bin(const uint32_t slice_start, const uint32_t slice_end)
+	{
+		const Matrix& p = m_projection;
+		const auto tile = [](const float value, const uint32_t count) { return static_cast<uint32_t>(Clamp(value * count, 0.0f, static_cast<float>(count - 1))); };
+
+		for (uint32_t slice = slice_start; slice < Min(slice_end, m_slice_count); slice++)
+		{
+			for (uint32_t cluster = GetCluster(0, 0, slice); cluster < GetCluster(0, 0, slice + 1); cluster++)
+			{
+				m_cluster_lights[cluster].clear();
+			}
+
+			const float slice_near	= m_slice_depths[slice];
+			const float slice_far	= m_slice_depths[slice + 1];
+
+			for (uint32_t index = 0; index < static_cast<uint32_t>(m_lights.size()); index++)
+			{
+				const ClusterLight& light = m_lights[index];
+				if (slice < light.slice_min || slice > light.slice_max)
+					continue;
+
+				// The part of the sphere inside the slice, its radius shrinks the further the center is from the slice
+				const Vector3& center			= light.center;
+				const float distance			= center.z < slice_near ? slice_near - center.z : (center.z > slice_far ? center.z - slice_far : 0.0f);
+				const float radius_squared		= light.radius * light.radius;
+				const float section_squared		= radius_squared - distance * distance;
+				if (section_squared < 0.0f)
+					continue;
+
+				const float section	= sqrt(section_squared);
+				const float z_near	= Max(slice_near, center.z - light.radius);
+				const float z_far	= Min(slice_far, center.z + light.radius);
+
+				// Project that box, the extremes of a perspective projection are always at the corners
+				float ndc_min_x = numeric_limits<float>::max(), ndc_max_x = numeric_limits<float>::lowest();
+				float ndc_min_y = numeric_limits<float>::max(), ndc_max_y = numeric_limits<float>::lowest();
+				for (const float z : { z_near, z_far })
+				{
+					const float w_inverted = 1.0f / (z * p.m23 + p.m33);
+					for (const float offset : { -section, section })
+					{
+						const float ndc_x = ((center.x + offset) * p.m00 + z * p.m20 + p.m30) * w_inverted;
+						const float ndc_y = ((center.y + offset) * p.m11 + z * p.m21 + p.m31) * w_inverted;
+						ndc_min_x = Min(ndc_min_x, ndc_x); ndc_max_x = Max(ndc_max_x, ndc_x);
+						ndc_min_y = Min(ndc_min_y, ndc_y); ndc_max_y = Max(ndc_max_y, ndc_y);
+					}
+				}
+
+				// Off screen lights end up on the border tiles, where the exact test below rejects them
+				const uint32_t tile_x_min = tile((ndc_min_x + 1.0f) * 0.5f, m_tile_count_x);
+				const uint32_t tile_x_max = tile((ndc_max_x + 1.0f) * 0.5f, m_tile_count_x);
+				const uint32_t tile_y_min = tile((1.0f - ndc_max_y) * 0.5f, m_tile_count_y);
+				const uint32_t tile_y_max = tile((1.0f - ndc_min_y) * 0.5f, m_tile_count_y);
+
+				for (uint32_t y = tile_y_min; y <= tile_y_max; y++)
+				{
+					for (uint32_t x = tile_x_min; x <= tile_x_max; x++)
+					{
+						// Sphere against the cluster's box
+						const uint32_t cluster	= GetCluster(x, y, slice);
+						const BoundingBox& box	= m_cluster_bounds[cluster];
+						const Vector3 closest
+						(
+							Clamp(center.x, box.GetMin().x, box.GetMax().x),
+							Clamp(center.y, box.GetMin().y, box.GetMax().y),
+							Clamp(center.z, box.GetMin().z, box.GetMax().z)
+						);
+
+						if (Vector3::DistanceSquared(closest, center) <= radius_squared)
+						{
+							m_cluster_lights[cluster].emplace_back(index);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void LightClusters::Compact()
+	{
+		uint32_t offset = 0;
+		for (uint32_t cluster = 0; cluster < GetClusterCount(); cluster++)
+		{
+			const uint32_t count	= static_cast<uint32_t>(m_cluster_lights[cluster].size());
+			m_grid[cluster * 2 + 0]	= offset;
+			m_grid[cluster * 2 + 1]	= count;
+			offset					+= count;
+		}
+
+		m_indices.resize(offset);
+		for (uint32_t cluster = 0; cluster < GetClusterCount(); cluster++)
+		{
+			copy(m_cluster_lights[cluster].begin(), m_cluster_lights[cluster].end(), m_indices.begin() + m_grid[cluster * 2]);
+		}
+	}
+}
@@ -0,0 +1,90 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include "../../Core/EngineDefs.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/BoundingBox.h"
+//===================================
+
+namespace Spartan
+{
+	// Splits the view frustum into a grid of clusters (screen tiles times exponential depth slices) and bins
+	// light spheres into them. The result is a compact list of light indices per cluster, which the light
+	// pass reads so that every pixel only shades the lights that can actually reach it.
+	//
+	// Usage per frame: Begin(), SetLight() for every light, Bin() for every slice, then Compact().
+	// SetLight() and Bin() can run in parallel as long as the index/slice ranges don't overlap.
+	class SPARTAN_CLASS LightClusters
+	{
+	public:
+		LightClusters(uint32_t tile_count_x = 16, uint32_t tile_count_y = 9, uint32_t slice_count = 24);
+		~LightClusters() = default;
+
+		void Begin(const Math::Matrix& view, const Math::Matrix& projection, float near_plane, float far_plane, uint32_t light_count);
+		void SetLight(uint32_t index, const Math::Vector3& position, float range);
+		void Bin(uint32_t slice_start, uint32_t slice_end);
+		void Compact();
+
+		// The slice of a view space depth is floor(log(depth) * scale + bias)
+		float GetSliceScale() const					{ return m_slice_scale; }
+		float GetSliceBias() const					{ return m_slice_bias; }
+		uint32_t GetTileCountX() const				{ return m_tile_count_x; }
+		uint32_t GetTileCountY() const				{ return m_tile_count_y; }
+		uint32_t GetSliceCount() const				{ return m_slice_count; }
+		uint32_t GetClusterCount() const			{ return m_tile_count_x * m_tile_count_y * m_slice_count; }
+		const Math::BoundingBox& GetClusterBounds(uint32_t cluster) const { return m_cluster_bounds[cluster]; }
+
+		// Offset and count into the index list, for every cluster (x first, then y, then slice)
+		const auto& GetGrid() const		{ return m_grid; }
+		const auto& GetIndices() const	{ return m_indices; }
+
+	private:
+		uint32_t GetCluster(const uint32_t x, const uint32_t y, const uint32_t slice) const { return (slice * m_tile_count_y + y) * m_tile_count_x + x; }
+
+		struct ClusterLight
+		{
+			Math::Vector3 center;	// view space
+			float radius;
+			uint32_t slice_min;
+			uint32_t slice_max;
+		};
+
+		uint32_t m_tile_count_x;
+		uint32_t m_tile_count_y;
+		uint32_t m_slice_count;
+		float m_slice_scale	= 0.0f;
+		float m_slice_bias	= 0.0f;
+		float m_near_plane	= 0.0f;
+		float m_far_plane	= 0.0f;
+		Math::Matrix m_view;
+		Math::Matrix m_projection;
+		std::vector<float> m_slice_depths;					// view space depth where every slice starts, plus the far plane
+		std::vector<Math::BoundingBox> m_cluster_bounds;	// view space, rebuilt only when the projection changes
+		std::vector<ClusterLight> m_lights;
+		std::vector<std::vector<uint32_t>> m_cluster_lights;
+		std::vector<uint32_t> m_grid;
+		std::vector<uint32_t> m_indices;
+	};
+}
@@ -0,0 +1,383 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <limits>
+#include "../../Math/Simd.h"
+//==============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+	// Anything closer than this (in w) is treated as crossing the near plane
+	static const float near_w = 0.001f;
+	// Triangles are clipped to a guard band of this many screens, keeping edge setup precise
+	static const float guard_band = 2.0f;
+
+	OcclusionBuffer::OcclusionBuffer(const uint32_t width, const uint32_t height)
+	{
+		// Keep the dimensions a multiple of the tile size, which also keeps rows 4 pixel aligned
+		m_width			= Max((width / tile_size) * tile_size, tile_size);
+		m_height		= Max((height / tile_size) * tile_size, tile_size);
+		m_tile_count_x	= m_width / tile_size;
+		m_tile_count_y	= m_height / tile_size;
+
+		m_depth.resize(m_width * m_height, 0.0f);
+		m_tiles.resize(m_tile_count_x * m_tile_count_y, 0.0f);
+	}
+
+	void OcclusionBuffer::Clear(const Matrix& view_projection)
+	{
+		m_view_projection = view_projection;
+		m_triangles.clear();
+		fill(m_depth.begin(), m_depth.end(), 0.0f);
+		fill(m_tiles.begin(), m_tiles.end(), 0.0f);
+	}
+
+	void OcclusionBuffer::AddOccluder(const Matrix& transform, const OccluderGeometry& geometry)
+	{
+		const Matrix world_view_projection = transform * m_view_projection;
+
+		// Transform to clip space once per vertex
+		static thread_local vector<Vector4> clip;
+		clip.resize(geometry.positions.size());
+		for (size_t i = 0; i < geometry.positions.size(); i++)
+		{
+			clip[i] = Vector4(geometry.positions[i], 1.0f) * world_view_projection;
+		}
+
+		// Signed distances to the planes the polygons get clipped against (near, left, right, bottom, top)
+		const auto distance = [](const Vector4& v, const uint32_t plane)
+		{
+			switch (plane)
+			{
+				case 0:	return v.w - near_w;
+				case 1:	return v.x + guard_band * v.w;
+				case 2:	return guard_band * v.w - v.x;
+				case 3:	return v.y + guard_band * v.w;
+				default:return guard_band * v.w - v.y;
+			}
+		};
+
+		const uint32_t index_count = static_cast<uint32_t>(geometry.indices.size()) / 3 * 3;
+		for (uint32_t i = 0; i < index_count; i += 3)
+		{
+			const uint32_t i0 = geometry.indices[i + 0];
+			const uint32_t i1 = geometry.indices[i + 1];
+			const uint32_t i2 = geometry.indices[i + 2];
+			if (i0 >= clip.size() || i1 >= clip.size() || i2 >= clip.size())
+				continue;
+
+			// Trivially reject triangles that are fully outside of any plane, and skip clipping when fully inside
+			uint32_t outside_all	= 0x1F;
+			uint32_t outside_any	= 0;
+			for (const uint32_t index : { i0, i1, i2 })
+			{
+				uint32_t outside = 0;
+				for (uint32_t plane = 0; plane < 5; plane++)
+				{
+					outside |= (distance(clip[index], plane) < 0.0f) ? (1 << plane) : 0;
+				}
+				outside_all &= outside;
+				outside_any |= outside;
+			}
+
+			if (outside_all != 0)
+				continue;
+
+			if (outside_any == 0)
+			{
+				AddTriangle(clip[i0], clip[i1], clip[i2]);
+				continue;
+			}
+
+			// Sutherland-Hodgman, every plane can add at most one vertex
+			Vector4 polygon[2][8];
+			uint32_t count	= 3;
+			uint32_t source	= 0;
+			polygon[0][0] = clip[i0];
+			polygon[0][1] = clip[i1];
+			polygon[0][2] = clip[i2];
+
+			for (uint32_t plane = 0; plane < 5 && count >= 3; plane++)
+			{
+				if (!(outside_any & (1 << plane)))
+					continue;
+
+				const Vector4* in	= polygon[source];
+				Vector4* out		= polygon[source ^ 1];
+				uint32_t out_count	= 0;
+				for (uint32_t v = 0; v < count; v++)
+				{
+					const Vector4& a	= in[v];
+					const Vector4& b	= in[(v + 1) % count];
+					const float da		= distance(a, plane);
+					const float db		= distance(b, plane);
+
+					if (da >= 0.0f)
+					{
+						out[out_count++] = a;
+					}
+
+					if ((da >= 0.0f) != (db >= 0.0f))
+					{
+						const float t = da / (da - db);
+						out[out_count++] = Vector4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t);
+					}
+				}
+				count	= out_count;
+				source	^= 1;
+			}
+
+			// Triangulate the clipped polygon as a fan
+			for (uint32_t v = 2; v < count; v++)
+			{
+				AddTriangle(polygon[source][0], polygon[source][v - 1], polygon[source][v]);
+			}
+		}
+	}
+
+	void OcclusionBuffer::AddTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2)
+	{
+		// Project to pixel coordinates (y pointing down) and keep 1/w as depth
+		float x[3], y[3], z[3];
+		const Vector4* vertices[3] = { &v0, &v1, &v2 };
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			const float inv_w = 1.0f / vertices[i]->w;
+			x[i] = (vertices[i]->x * inv_w * 0.5f + 0.5f) * m_width;
+			y[i] = (0.5f - vertices[i]->y * inv_w * 0.5f) * m_height;
+			z[i] = inv_w;
+		}
+
+		// Twice the signed area, degenerate triangles don't cover anything
+		const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (Abs(area) < 1e-6f)
+			return;
+
+		Triangle triangle;
+
+		// Pixel centers that fall inside the bounds
+		triangle.min_x = Max(static_cast<int32_t>(ceil(Min(x[0], Min(x[1], x[2])) - 0.5f)), 0);
+		triangle.max_x = Min(static_cast<int32_t>(floor(Max(x[0], Max(x[1], x[2])) - 0.5f)), static_cast<int32_t>(m_width) - 1);
+		triangle.min_y = Max(static_cast<int32_t>(ceil(Min(y[0], Min(y[1], y[2])) - 0.5f)), 0);
+		triangle.max_y = Min(static_cast<int32_t>(floor(Max(y[0], Max(y[1], y[2])) - 0.5f)), static_cast<int32_t>(m_height) - 1);
+		if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+			return;
+
+		// Edge functions, flipped so that the inside is positive regardless of the winding
+		const float sign = area > 0.0f ? 1.0f : -1.0f;
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			const uint32_t j = (i + 1) % 3;
+			triangle.edge_a[i] = (y[i] - y[j]) * sign;
+			triangle.edge_b[i] = (x[j] - x[i]) * sign;
+			triangle.edge_c[i] = (x[i] * y[j] - x[j] * y[i]) * sign;
+		}
+
+		// Depth plane
+		const float inv_area	= 1.0f / area;
+		triangle.depth_a		= ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * inv_area;
+		triangle.depth_b		= ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * inv_area;
+		triangle.depth_c		= z[0] - triangle.depth_a * x[0] - triangle.depth_b * y[0];
+
+		m_triangles.emplace_back(triangle);
+	}
+
+	void OcclusionBuffer::Rasterize(const uint32_t tile_row_start, const uint32_t tile_row_end)
+	{
+		const int32_t row_start	= static_cast<int32_t>(Min(tile_row_start, m_tile_count_y) * tile_size);
+		const int32_t row_end	= static_cast<int32_t>(Min(tile_row_end, m_tile_count_y) * tile_size) - 1;
+
+		for (const Triangle& triangle : m_triangles)
+		{
+			const int32_t y_start	= Max(triangle.min_y, row_start);
+			const int32_t y_end		= Min(triangle.max_y, row_end);
+			if (y_start > y_end)
+				continue;
+
+			// Rows are 4 pixel aligned, so a span can always be processed in groups of 4
+			const int32_t x_start	= triangle.min_x & ~3;
+			const int32_t x_end		= triangle.max_x;
+
+#if defined(SPARTAN_MATH_SSE)
+			const __m128 offsets	= _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 zero		= _mm_setzero_ps();
+			const __m128 ea0 = _mm_set1_ps(triangle.edge_a[0]), eb0 = _mm_set1_ps(triangle.edge_b[0]), ec0 = _mm_set1_ps(triangle.edge_c[0]);
+			const __m128 ea1 = _mm_set1_ps(triangle.edge_a[1]), eb1 = _mm_set1_ps(triangle.edge_b[1]), ec1 = _mm_set1_ps(triangle.edge_c[1]);
+			const __m128 ea2 = _mm_set1_ps(triangle.edge_a[2]), eb2 = _mm_set1_ps(triangle.edge_b[2]), ec2 = _mm_set1_ps(triangle.edge_c[2]);
+			const __m128 da  = _mm_set1_ps(triangle.depth_a),   db  = _mm_set1_ps(triangle.depth_b),   dc  = _mm_set1_ps(triangle.depth_c);
+			const __m128 x_last		= _mm_set1_ps(static_cast<float>(x_end) + 0.5f);
+
+			for (int32_t y = y_start; y <= y_end; y++)
+			{
+				const __m128 py = _mm_set1_ps(static_cast<float>(y) + 0.5f);
+
+				// Row constant parts
+				const __m128 row0	= _mm_add_ps(_mm_mul_ps(eb0, py), ec0);
+				const __m128 row1	= _mm_add_ps(_mm_mul_ps(eb1, py), ec1);
+				const __m128 row2	= _mm_add_ps(_mm_mul_ps(eb2, py), ec2);
+				const __m128 rowd	= _mm_add_ps(_mm_mul_ps(db, py), dc);
+				float* depth_row	= &m_depth[y * m_width];
+
+				for (int32_t x = x_start; x <= x_end; x += 4)
+				{
+					const __m128 px	= _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+					const __m128 w0	= _mm_add_ps(_mm_mul_ps(ea0, px), row0);
+					const __m128 w1	= _mm_add_ps(_mm_mul_ps(ea1, px), row1);
+					const __m128 w2	= _mm_add_ps(_mm_mul_ps(ea2, px), row2);
+
+					__m128 inside = _mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(w2, zero));
+					inside = _mm_and_ps(inside, _mm_cmple_ps(px, x_last));
+					if (_mm_movemask_ps(inside) == 0)
+						continue;
+
+					// Keep the nearest depth (largest 1/w)
+					const __m128 depth		= _mm_add_ps(_mm_mul_ps(da, px), rowd);
+					const __m128 current	= _mm_loadu_ps(depth_row + x);
+					const __m128 nearest	= _mm_max_ps(current, _mm_and_ps(depth, inside));
+					_mm_storeu_ps(depth_row + x, nearest);
+				}
+			}
+#else
+			for (int32_t y = y_start; y <= y_end; y++)
+			{
+				const float py		= static_cast<float>(y) + 0.5f;
+				float* depth_row	= &m_depth[y * m_width];
+
+				for (int32_t x = x_start; x <= x_end; x++)
+				{
+					const float px = static_cast<float>(x) + 0.5f;
+					if (triangle.edge_a[0] * px + triangle.edge_b[0] * py + triangle.edge_c[0] < 0.0f ||
+						triangle.edge_a[1] * px + triangle.edge_b[1] * py + triangle.edge_c[1] < 0.0f ||
+						triangle.edge_a[2] * px + triangle.edge_b[2] * py + triangle.edge_c[2] < 0.0f)
+						continue;
+
+					const float depth	= triangle.depth_a * px + triangle.depth_b * py + triangle.depth_c;
+					depth_row[x]		= Max(depth_row[x], depth);
+				}
+			}
+#endif
+		}
+
+		// Build the hierarchical level, every tile keeps its farthest depth
+		for (uint32_t tile_y = Min(tile_row_start, m_tile_count_y); tile_y < Min(tile_row_end, m_tile_count_y); tile_y++)
+		{
+			for (uint32_t tile_x = 0; tile_x < m_tile_count_x; tile_x++)
+			{
+				float farthest = numeric_limits<float>::max();
+				for (uint32_t y = tile_y * tile_size; y < (tile_y + 1) * tile_size; y++)
+				{
+					const float* depth_row = &m_depth[y * m_width + tile_x * tile_size];
+					for (uint32_t x = 0; x < tile_size; x++)
+					{
+						farthest = Min(farthest, depth_row[x]);
+					}
+				}
+				m_tiles[tile_y * m_tile_count_x + tile_x] = farthest;
+			}
+		}
+	}
+
+	bool OcclusionBuffer::IsVisible(const BoundingBox& box) const
+	{
+		const Vector3& box_min = box.GetMin();
+		const Vector3& box_max = box.GetMax();
+
+		// Screen space bounds and nearest depth of the box
+		float min_x		= numeric_limits<float>::max();
+		float min_y		= numeric_limits<float>::max();
+		float max_x		= numeric_limits<float>::lowest();
+		float max_y		= numeric_limits<float>::lowest();
+		float nearest	= 0.0f;
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			const Vector3 corner
+			(
+				(i & 1) ? box_max.x : box_min.x,
+				(i & 2) ? box_max.y : box_min.y,
+				(i & 4) ? box_max.z : box_min.z
+			);
+			const Vector4 clip = Vector4(corner, 1.0f) * m_view_projection;
+
+			// Crosses the near plane, can't be occluded
+			if (clip.w < near_w)
+				return true;
+
+			const float inv_w	= 1.0f / clip.w;
+			const float x		= (clip.x * inv_w * 0.5f + 0.5f) * m_width;
+			const float y		= (0.5f - clip.y * inv_w * 0.5f) * m_height;
+			min_x	= Min(min_x, x);
+			max_x	= Max(max_x, x);
+			min_y	= Min(min_y, y);
+			max_y	= Max(max_y, y);
+			nearest	= Max(nearest, inv_w);
+		}
+
+		// Every pixel the box touches
+		const int32_t x_start	= Max(static_cast<int32_t>(floor(min_x)), 0);
+		const int32_t x_end		= Min(static_cast<int32_t>(ceil(max_x)) - 1, static_cast<int32_t>(m_width) - 1);
+		const int32_t y_start	= Max(static_cast<int32_t>(floor(min_y)), 0);
+		const int32_t y_end		= Min(static_cast<int32_t>(ceil(max_y)) - 1, static_cast<int32_t>(m_height) - 1);
+
+		// Off screen, leave it to frustum culling
+		if (x_start > x_end || y_start > y_end)
+			return true;
+
+		const int32_t tile_x_start	= x_start / tile_size;
+		const int32_t tile_x_end	= x_end / tile_size;
+		const int32_t tile_y_start	= y_start / tile_size;
+		const int32_t tile_y_end	= y_end / tile_size;
+		for (int32_t tile_y = tile_y_start; tile_y <= tile_y_end; tile_y++)
+		{
+			for (int32_t tile_x = tile_x_start; tile_x <= tile_x_end; tile_x++)
+			{
+				// Every occluder pixel in the tile is in front of the box
+				if (nearest < m_tiles[tile_y * m_tile_count_x + tile_x])
+					continue;
+
+				// Otherwise go down to the pixels the box overlaps
+				const int32_t px_start	= Max(x_start, tile_x * static_cast<int32_t>(tile_size));
+				const int32_t px_end	= Min(x_end, (tile_x + 1) * static_cast<int32_t>(tile_size) - 1);
+				const int32_t py_start	= Max(y_start, tile_y * static_cast<int32_t>(tile_size));
+				const int32_t py_end	= Min(y_end, (tile_y + 1) * static_cast<int32_t>(tile_size) - 1);
+				for (int32_t y = py_start; y <= py_end; y++)
+				{
+					const float* depth_row = &m_depth[y * m_width];
+					for (int32_t x = px_start; x <= px_end; x++)
+					{
+						if (depth_row[x] <= nearest)
+							return true;
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,89 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <vector>
+#include "../../Core/EngineDefs.h"
+#include "../../Math/Matrix.h"
+#include "../../Math/BoundingBox.h"
+//===================================
+
+namespace Spartan
+{
+	// Object space triangles of an occluder, positions only
+	struct OccluderGeometry
+	{
+		std::vector<Math::Vector3> positions;
+		std::vector<uint32_t> indices;
+	};
+
+	// A low resolution software depth buffer. Occluders are rasterized into it with SIMD and bounding
+	// boxes are then tested against it, first per 8x8 tile (farthest depth) and then per pixel.
+	// Depth is stored as 1/w, so it interpolates linearly in screen space and 0 means "no occluder".
+	// It doesn't touch the GPU at all.
+	class SPARTAN_CLASS OcclusionBuffer
+	{
+	public:
+		OcclusionBuffer(uint32_t width = 256, uint32_t height = 128);
+		~OcclusionBuffer() = default;
+
+		// Starts a new frame, for the given view projection matrix
+		void Clear(const Math::Matrix& view_projection);
+
+		// Transforms, clips and sets up the triangles of an occluder (not thread safe)
+		void AddOccluder(const Math::Matrix& transform, const OccluderGeometry& geometry);
+
+		// Rasterizes the occluders into a range of tile rows, different ranges can be rasterized in parallel
+		void Rasterize(uint32_t tile_row_start, uint32_t tile_row_end);
+
+		// Returns false if the box is fully hidden behind the rasterized occluders (thread safe)
+		bool IsVisible(const Math::BoundingBox& box) const;
+
+		uint32_t GetWidth() const			{ return m_width; }
+		uint32_t GetHeight() const			{ return m_height; }
+		uint32_t GetTileRowCount() const	{ return m_tile_count_y; }
+		uint32_t GetTriangleCount() const	{ return static_cast<uint32_t>(m_triangles.size()); }
+		const auto& GetDepth() const		{ return m_depth; }
+
+		static const uint32_t tile_size = 8;
+
+	private:
+		struct Triangle
+		{
+			float edge_a[3], edge_b[3], edge_c[3];	// edge functions, positive inside
+			float depth_a, depth_b, depth_c;		// depth plane, 1/w = a * x + b * y + c
+			int32_t min_x, max_x, min_y, max_y;		// pixel bounds
+		};
+
+		void AddTriangle(const Math::Vector4& v0, const Math::Vector4& v1, const Math::Vector4& v2);
+
+		uint32_t m_width;
+		uint32_t m_height;
+		uint32_t m_tile_count_x;
+		uint32_t m_tile_count_y;
+		Math::Matrix m_view_projection;
+		std::vector<Triangle> m_triangles;
+		std::vector<float> m_depth;	// 1/w per pixel
+		std::vector<float> m_tiles;	// farthest 1/w per tile
+	};
+}
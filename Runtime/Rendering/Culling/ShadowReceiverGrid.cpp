@@ -0,0 +1,147 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "ShadowReceiverGrid.h"
+#include <algorithm>
+#include <limits>
+//=============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+	// Corners closer to the light plane than this (in w) make the footprint cover the whole slice
+	static const float near_w = 0.001f;
+
+	void ShadowReceiverGrid::Clear(const Matrix& view, const Matrix& projection)
+	{
+		m_view				= view;
+		m_projection		= projection;
+		m_receiver_count	= 0;
+		fill(begin(m_depth_max), end(m_depth_max), numeric_limits<float>::lowest());
+	}
+
+	void ShadowReceiverGrid::AddReceiver(const Vector3& center, const Vector3& extent)
+	{
+		Footprint footprint;
+		if (!Project(center, extent, footprint))
+			return;
+
+		for (uint32_t y = footprint.min_y; y <= footprint.max_y; y++)
+		{
+			for (uint32_t x = footprint.min_x; x <= footprint.max_x; x++)
+			{
+				float& depth = m_depth_max[y * grid_size + x];
+				depth = Max(depth, footprint.max_z);
+			}
+		}
+
+		m_receiver_count++;
+	}
+
+	bool ShadowReceiverGrid::IsCasterRelevant(const Vector3& center, const Vector3& extent) const
+	{
+		Footprint footprint;
+		if (!Project(center, extent, footprint))
+			return false;
+
+		for (uint32_t y = footprint.min_y; y <= footprint.max_y; y++)
+		{
+			for (uint32_t x = footprint.min_x; x <= footprint.max_x; x++)
+			{
+				if (footprint.min_z <= m_depth_max[y * grid_size + x])
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool ShadowReceiverGrid::Project(const Vector3& center, const Vector3& extent, Footprint& footprint) const
+	{
+		float min_x = numeric_limits<float>::max();
+		float min_y = numeric_limits<float>::max();
+		float max_x = numeric_limits<float>::lowest();
+		float max_y = numeric_limits<float>::lowest();
+		footprint.min_z = numeric_limits<float>::max();
+		footprint.max_z = numeric_limits<float>::lowest();
+		bool crosses_light_plane = false;
+
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			const Vector3 corner
+			(
+				center.x + ((i & 1) ? extent.x : -extent.x),
+				center.y + ((i & 2) ? extent.y : -extent.y),
+				center.z + ((i & 4) ? extent.z : -extent.z)
+			);
+
+			const Vector3 view	= corner * m_view;
+			const Vector4 clip	= Vector4(view.x, view.y, view.z, 1.0f) * m_projection;
+
+			footprint.min_z = Min(footprint.min_z, view.z);
+			footprint.max_z = Max(footprint.max_z, view.z);
+
+			if (clip.w < near_w)
+			{
+				crosses_light_plane = true;
+				continue;
+			}
+
+			const float x = clip.x / clip.w;
+			const float y = clip.y / clip.w;
+			min_x = Min(min_x, x); max_x = Max(max_x, x);
+			min_y = Min(min_y, y); max_y = Max(max_y, y);
+		}
+
+		// Behind a perspective light, nothing to cast or receive
+		if (footprint.max_z < 0.0f && m_projection.m23 != 0.0f)
+			return false;
+
+		// Straddling the light, any direction is possible
+		if (crosses_light_plane)
+		{
+			min_x = min_y = -1.0f;
+			max_x = max_y = 1.0f;
+		}
+
+		// Outside of the slice
+		if (max_x < -1.0f || min_x > 1.0f || max_y < -1.0f || min_y > 1.0f)
+			return false;
+
+		// Clip space to cells, y points up in clip space and down in the shadow map but the grid only has to be consistent
+		const auto to_cell = [](const float value)
+		{
+			const float cell = (value * 0.5f + 0.5f) * static_cast<float>(grid_size);
+			return static_cast<uint32_t>(Clamp(cell, 0.0f, static_cast<float>(grid_size - 1)));
+		};
+		footprint.min_x = to_cell(min_x);
+		footprint.max_x = to_cell(max_x);
+		footprint.min_y = to_cell(min_y);
+		footprint.max_y = to_cell(max_y);
+
+		return true;
+	}
+}
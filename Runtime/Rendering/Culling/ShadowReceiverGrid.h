@@ -0,0 +1,69 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include "../../Core/EngineDefs.h"
+#include "../../Math/Matrix.h"
+//===================================
+
+namespace Spartan
+{
+	// The camera visible shadow receivers of one shadow map slice, extruded away from the light. The slice is split
+	// into a coarse grid and every cell keeps the farthest light space depth of the receivers that cover it. A caster
+	// can only darken something visible if it overlaps a cell and lies in front of that cell's farthest receiver.
+	// Works for orthographic (directional) and perspective (spot, point face) light projections alike.
+	class SPARTAN_CLASS ShadowReceiverGrid
+	{
+	public:
+		ShadowReceiverGrid() = default;
+		~ShadowReceiverGrid() = default;
+
+		// Starts over, for the given light view and projection
+		void Clear(const Math::Matrix& view, const Math::Matrix& projection);
+
+		// Extrudes a receiver's bounding box (world space center and extents)
+		void AddReceiver(const Math::Vector3& center, const Math::Vector3& extent);
+
+		// Returns false if the caster can't cast onto any of the receivers
+		bool IsCasterRelevant(const Math::Vector3& center, const Math::Vector3& extent) const;
+
+		bool HasReceivers() const { return m_receiver_count != 0; }
+
+		static const uint32_t grid_size = 16;
+
+	private:
+		struct Footprint
+		{
+			uint32_t min_x, max_x, min_y, max_y;	// inclusive cells
+			float min_z, max_z;						// light view space depth
+		};
+
+		// Returns false if the box is completely behind the light
+		bool Project(const Math::Vector3& center, const Math::Vector3& extent, Footprint& footprint) const;
+
+		Math::Matrix m_view;
+		Math::Matrix m_projection;
+		float m_depth_max[grid_size * grid_size] = {};
+		uint32_t m_receiver_count = 0;
+	};
+}
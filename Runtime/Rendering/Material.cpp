@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_ConstantBuffer.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_TextureCube.h"
+#include "../World/WorldSnapshot.h"
 //====================================
 
 //= NAMESPACES ================
@@ -250,7 +251,7 @@ namespace Spartan
 		return shader;
 	}
 
-	bool Material::UpdateConstantBuffer()
+	bool Material::UpdateConstantBuffer(const SnapshotMaterial& snapshot)
 	{
 		// Has to match GBuffer.hlsl
 		if (!m_constant_buffer_gpu)
@@ -261,28 +262,28 @@ namespace Spartan
 
 		// Determine if the buffer needs to update
 		auto update = false;
-		update = m_constant_buffer_cpu.mat_albedo			!= GetColorAlbedo() 					? true : update;
-		update = m_constant_buffer_cpu.mat_tiling_uv		!= GetTiling()							? true : update;
-		update = m_constant_buffer_cpu.mat_offset_uv		!= GetOffset()							? true : update;
-		update = m_constant_buffer_cpu.mat_roughness_mul	!= GetMultiplier(TextureType_Roughness) ? true : update;
-		update = m_constant_buffer_cpu.mat_metallic_mul		!= GetMultiplier(TextureType_Metallic)	? true : update;
-		update = m_constant_buffer_cpu.mat_normal_mul		!= GetMultiplier(TextureType_Normal)	? true : update;
-		update = m_constant_buffer_cpu.mat_height_mul		!= GetMultiplier(TextureType_Height)	? true : update;
-		update = m_constant_buffer_cpu.mat_shading_mode		!= static_cast<float>(GetShadingMode())	? true : update;
+		update = m_constant_buffer_cpu.mat_albedo			!= snapshot.color_albedo						? true : update;
+		update = m_constant_buffer_cpu.mat_tiling_uv		!= snapshot.tiling								? true : update;
+		update = m_constant_buffer_cpu.mat_offset_uv		!= snapshot.offset								? true : update;
+		update = m_constant_buffer_cpu.mat_roughness_mul	!= snapshot.multiplier_roughness				? true : update;
+		update = m_constant_buffer_cpu.mat_metallic_mul		!= snapshot.multiplier_metallic					? true : update;
+		update = m_constant_buffer_cpu.mat_normal_mul		!= snapshot.multiplier_normal					? true : update;
+		update = m_constant_buffer_cpu.mat_height_mul		!= snapshot.multiplier_height					? true : update;
+		update = m_constant_buffer_cpu.mat_shading_mode		!= static_cast<float>(snapshot.shading_mode)	? true : update;
 
 		if (!update)
 			return true;
 
 		auto buffer = static_cast<ConstantBufferData*>(m_constant_buffer_gpu->Map());
 
-		buffer->mat_albedo			= m_constant_buffer_cpu.mat_albedo			= GetColorAlbedo();
-		buffer->mat_tiling_uv		= m_constant_buffer_cpu.mat_tiling_uv		= GetTiling();
-		buffer->mat_offset_uv		= m_constant_buffer_cpu.mat_offset_uv		= GetOffset();
-		buffer->mat_roughness_mul	= m_constant_buffer_cpu.mat_roughness_mul	= GetMultiplier(TextureType_Roughness);
-		buffer->mat_metallic_mul	= m_constant_buffer_cpu.mat_metallic_mul	= GetMultiplier(TextureType_Metallic);
-		buffer->mat_normal_mul		= m_constant_buffer_cpu.mat_normal_mul		= GetMultiplier(TextureType_Normal);
-		buffer->mat_height_mul		= m_constant_buffer_cpu.mat_height_mul		= GetMultiplier(TextureType_Height);
-		buffer->mat_shading_mode	= m_constant_buffer_cpu.mat_shading_mode	= static_cast<float>(GetShadingMode());
+		buffer->mat_albedo			= m_constant_buffer_cpu.mat_albedo			= snapshot.color_albedo;
+		buffer->mat_tiling_uv		= m_constant_buffer_cpu.mat_tiling_uv		= snapshot.tiling;
+		buffer->mat_offset_uv		= m_constant_buffer_cpu.mat_offset_uv		= snapshot.offset;
+		buffer->mat_roughness_mul	= m_constant_buffer_cpu.mat_roughness_mul	= snapshot.multiplier_roughness;
+		buffer->mat_metallic_mul	= m_constant_buffer_cpu.mat_metallic_mul	= snapshot.multiplier_metallic;
+		buffer->mat_normal_mul		= m_constant_buffer_cpu.mat_normal_mul		= snapshot.multiplier_normal;
+		buffer->mat_height_mul		= m_constant_buffer_cpu.mat_height_mul		= snapshot.multiplier_height;
+		buffer->mat_shading_mode	= m_constant_buffer_cpu.mat_shading_mode	= static_cast<float>(snapshot.shading_mode);
 		buffer->padding				= m_constant_buffer_cpu.padding				= Vector3::Zero;
 
 		return m_constant_buffer_gpu->Unmap();
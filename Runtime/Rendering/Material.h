@@ -34,6 +34,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Spartan
 {	
 	class ShaderVariation;
+	struct SnapshotMaterial;
 
 	enum TextureType
 	{
@@ -84,10 +85,11 @@ namespace Spartan
 		auto HasShader()		const { return GetShader() != nullptr; }
 		//=============================================================================
 
-		//= CONSTANT BUFFER ===================================================
-		bool UpdateConstantBuffer();
+		//= CONSTANT BUFFER ==========================================================================
+		// From a snapshot of the material, the renderer never reads the material itself while it's being edited
+		bool UpdateConstantBuffer(const SnapshotMaterial& snapshot);
 		const auto& GetConstantBuffer() const { return m_constant_buffer_gpu; }
-		//=====================================================================
+		//============================================================================================
 
 		//= PROPERTIES ==========================================================================================
 		auto GetCullMode() const											{ return m_cull_mode; }
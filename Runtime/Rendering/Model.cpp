@@ -35,6 +35,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_IndexBuffer.h"
 #include "../RHI/RHI_Texture2D.h"
+#include "../Threading/Threading.h"
 //=========================================
 
 //= NAMESPACES ================
@@ -44,6 +45,10 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	// Model files start with a header, files without it predate the block compressed geometry
+	static const uint32_t g_model_file_magic	= 0x4C444D53; // "SMDL"
+	static const uint32_t g_model_file_version	= 1;
+
 	Model::Model(Context* context) : IResource(context, Resource_Model)
 	{
 		m_normalized_scale	= 1.0f;
@@ -95,15 +100,19 @@ namespace Spartan
 
 	bool Model::SaveToFile(const string& file_path)
 	{
-		auto file = make_unique<FileStream>(file_path, FileStream_Write);
+		auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Async);
 		if (!file->IsOpen())
 			return false;
 
+		const auto threading = m_context->GetSubsystem<Threading>().get();
+
+		file->Write(g_model_file_magic);
+		file->Write(g_model_file_version);
 		file->Write(GetResourceName());
 		file->Write(GetResourceFilePath());
 		file->Write(m_normalized_scale);
-		file->Write(m_mesh->Indices_Get());
-		file->Write(m_mesh->Vertices_Get());	
+		file->WriteBlocks(m_mesh->Indices_Get(), m_file_compression, threading);
+		file->WriteBlocks(m_mesh->Vertices_Get(), m_file_compression, threading);
 
 		return true;
 	}
@@ -237,15 +246,40 @@ namespace Spartan
 	bool Model::LoadFromEngineFormat(const string& file_path)
 	{
 		// Deserialize
-		auto file = make_unique<FileStream>(file_path, FileStream_Read);
+		auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped);
 		if (!file->IsOpen())
 			return false;
 
+		// Older files start with the name right away
+		const auto has_header = file->ReadAs<uint32_t>() == g_model_file_magic;
+		if (has_header)
+		{
+			const auto version = file->ReadAs<uint32_t>();
+			if (version > g_model_file_version)
+			{
+				LOGF_ERROR("\"%s\" was saved by a newer version (%d) of the model format", file_path.c_str(), version);
+				return false;
+			}
+		}
+		else
+		{
+			file->Seek(0);
+		}
+
 		SetResourceName(file->ReadAs<string>());
 		SetResourceFilePath(file->ReadAs<string>());
 		file->Read(&m_normalized_scale);
-		file->Read(&m_mesh->Indices_Get());
-		file->Read(&m_mesh->Vertices_Get());
+		if (has_header)
+		{
+			const auto threading = m_context->GetSubsystem<Threading>().get();
+			file->ReadBlocks(&m_mesh->Indices_Get(), threading);
+			file->ReadBlocks(&m_mesh->Vertices_Get(), threading);
+		}
+		else
+		{
+			file->Read(&m_mesh->Indices_Get());
+			file->Read(&m_mesh->Vertices_Get());
+		}
 
 		GeometryUpdate();
 
@@ -326,6 +360,16 @@ namespace Spartan
 		return 1.0f / scale_offset;
 	}
 
+	uint64_t Model::GetMemoryUsageCpu()
+	{
+		return sizeof(*this) + (m_mesh ? m_mesh->Geometry_MemoryUsage() : 0);
+	}
+
+	uint64_t Model::GetMemoryUsageGpu()
+	{
+		return (m_vertex_buffer ? m_vertex_buffer->GetSize() : 0) + (m_index_buffer ? m_index_buffer->GetSize() : 0);
+	}
+
 	uint32_t Model::GeometryComputeMemoryUsage() const
 	{
 		// Vertices & Indices
@@ -47,6 +47,8 @@ namespace Spartan
 		//= RESOURCE INTERFACE =================================
 		bool LoadFromFile(const std::string& file_path) override;
 		bool SaveToFile(const std::string& file_path) override;
+		uint64_t GetMemoryUsageCpu() override;
+		uint64_t GetMemoryUsageGpu() override;
 		//======================================================
 
 		// Sets the entity that represents this model in the scene
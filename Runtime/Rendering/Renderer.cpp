@@ -20,22 +20,32 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 //= INCLUDES ==============================
+#include <algorithm>
 #include "Renderer.h"
 #include "Font/Font.h"
 #include "Shaders/ShaderBuffered.h"
+#include "Material.h"
 #include "Utilities/Sampling.h"
+#include "Culling/ShadowReceiverGrid.h"
 #include "../Profiling/Profiler.h"
 #include "../Resource/ResourceCache.h"
 #include "Gizmos/Grid.h"
 #include "Gizmos/Transform_Gizmo.h"
 #include "../Core/Engine.h"
 #include "../Core/Timer.h"
+#include "../Threading/Threading.h"
+#include "../World/World.h"
 #include "../World/Entity.h"
-#include "../World/Components/Renderable.h"
+#include "../World/WorldSnapshot.h"
 #include "../World/Components/Camera.h"
 #include "../RHI/RHI_Device.h"
 #include "../RHI/RHI_PipelineCache.h"
 #include "../RHI/RHI_CommandList.h"
+#include "../RHI/RHI_Vertex.h"
+#include "../RHI/RHI_StructuredBuffer.h"
+#include "../RHI/RHI_Texture2D.h"
+#include "../RHI/RHI_ConstantBuffer.h"
+#include "Model.h"
 //=========================================
 
 //= NAMESPACES ===============
@@ -58,23 +68,17 @@ namespace Spartan
 		m_flags		|= Render_PostProcess_MotionBlur;
 		m_flags		|= Render_PostProcess_TAA;
         m_flags     |= Render_PostProcess_SSR;
+		m_flags		|= Render_OcclusionCulling;
 		//m_flags	|= Render_PostProcess_FXAA;                 // Disabled by default: TAA is superior.
 		//m_flags	|= Render_PostProcess_Sharpening;		    // Disabled by default: TAA's blurring is taken core of with an always on sharpen pass specifically for it.
 		//m_flags	|= Render_PostProcess_Dithering;			// Disabled by default: It's only needed in very dark scenes to fix smooth color gradients.
 		//m_flags	|= Render_PostProcess_ChromaticAberration;	// Disabled by default: It doesn't improve the image quality, it's more of a stylistic effect.	
-
-		// Subscribe to events
-		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Complete,    EVENT_HANDLER_VARIANT(RenderablesAcquire));
-        SUBSCRIBE_TO_EVENT(Event_World_Unload,              EVENT_HANDLER(ClearEntities));
 	}
 
 	Renderer::~Renderer()
 	{
-		// Unsubscribe from events
-		UNSUBSCRIBE_FROM_EVENT(Event_World_Resolve_Complete, EVENT_HANDLER_VARIANT(RenderablesAcquire));
-
-		m_entities.clear();
-		m_camera = nullptr;
+		m_snapshot	= nullptr;
+		m_camera	= nullptr;
 
 		// Log to file as the renderer is no more
 		LOG_TO_FILE(true);
@@ -85,6 +89,7 @@ namespace Spartan
         // Get required systems		
         m_resource_cache    = m_context->GetSubsystem<ResourceCache>().get();
         m_profiler          = m_context->GetSubsystem<Profiler>().get();
+        m_threading         = m_context->GetSubsystem<Threading>().get();
 
         // Create device
         m_rhi_device = make_shared<RHI_Device>(m_context);
@@ -130,6 +135,17 @@ namespace Spartan
 		m_uber_buffer = make_shared<RHI_ConstantBuffer>(m_rhi_device);
 		m_uber_buffer->Create<UberBuffer>();
 
+		// Clustered lighting buffers, the structured ones grow as needed
+		m_cluster_buffer = make_shared<RHI_ConstantBuffer>(m_rhi_device);
+		m_cluster_buffer->Create<ClusterBuffer>();
+		m_cluster_grid		= make_shared<RHI_StructuredBuffer>(m_rhi_device);
+		m_cluster_indices	= make_shared<RHI_StructuredBuffer>(m_rhi_device);
+		m_cluster_lights	= make_shared<RHI_StructuredBuffer>(m_rhi_device);
+
+		// Shadow atlas tiles are cleared with a quad, depth stencil views can only be cleared whole
+		m_shadow_atlas_clear_buffer = make_shared<RHI_ConstantBuffer>(m_rhi_device);
+		m_shadow_atlas_clear_buffer->Create<Matrix>();
+
 		// Line buffer
 		m_vertex_buffer_lines = make_shared<RHI_VertexBuffer>(m_rhi_device);
 
@@ -165,18 +181,46 @@ namespace Spartan
             return;
 
         m_resolution_shadow = resolution;
+        m_shadow_caches.clear();
 
-        const auto& light_entities = m_entities[Renderer_Object_Light];
-        for (const auto& light_entity : light_entities)
+        if (!m_snapshot)
+            return;
+
+        for (const auto& light : m_snapshot->lights)
         {
-            auto& light = light_entity->GetComponent<Light>();
-            if (light->GetCastShadows())
+            if (light.cast_shadows)
             {
-                light->CreateShadowMap(true);
+                light.light_component->CreateShadowMap(true);
             }
         }
     }
 
+    void Renderer::SetShadowAtlasResolution(uint32_t resolution)
+    {
+        resolution = Clamp(resolution, m_resolution_shadow_min, m_max_resolution);
+
+        if (resolution == m_resolution_shadow_atlas)
+            return;
+
+        // Every light gets new tiles (and renders its shadows again) on the next frame
+        m_resolution_shadow_atlas   = resolution;
+        m_shadow_atlas              = ShadowAtlas(resolution);
+        m_shadow_atlas_texture      = nullptr;
+        m_shadow_atlas_entries.clear();
+        m_shadow_caches.clear();
+    }
+
+    void Renderer::SetShadowCascadeInterval(uint32_t cascade, uint32_t interval)
+    {
+        if (cascade >= m_shadow_cascade_interval.size())
+        {
+            LOGF_ERROR("Invalid cascade %d", cascade);
+            return;
+        }
+
+        m_shadow_cascade_interval[cascade] = Max(interval, 1u);
+    }
+
     void Renderer::SetAnisotropy(uint32_t anisotropy)
     {
         uint32_t min = 0;
@@ -192,6 +236,10 @@ namespace Spartan
 		if (!m_rhi_device || !m_rhi_device->IsInitialized())
 			return;
 
+		// Acquire the latest world snapshot, it's held (and won't change) for the whole frame
+		m_snapshot	= m_context->GetSubsystem<World>()->GetSnapshot();
+		m_camera	= m_snapshot->has_camera ? m_snapshot->camera.camera_component : nullptr;
+
 		// If there is no camera, do nothing
 		if (!m_camera)
 		{
@@ -200,9 +248,9 @@ namespace Spartan
 		}
 
 		// If there is nothing to render clear to camera's color and present
-		if (m_entities.empty())
+		if (m_snapshot->renderables_opaque.empty() && m_snapshot->renderables_transparent.empty() && m_snapshot->lights.empty())
 		{
-			m_cmd_list->ClearRenderTarget(m_render_targets[RenderTarget_Composition_Ldr]->GetResource_RenderTarget(), m_camera->GetClearColor());
+			m_cmd_list->ClearRenderTarget(m_render_targets[RenderTarget_Composition_Ldr]->GetResource_RenderTarget(), m_snapshot->camera.clear_color);
 			return;
 		}
 
@@ -211,11 +259,12 @@ namespace Spartan
 
 		// Get camera matrices
 		{
-			m_near_plane	= m_camera->GetNearPlane();
-			m_far_plane		= m_camera->GetFarPlane();
-			m_view			= m_camera->GetViewMatrix();
-			m_view_base		= m_camera->GetBaseViewMatrix();
-			m_projection	= m_camera->GetProjectionMatrix();
+			const auto& camera = m_snapshot->camera;
+			m_near_plane	= camera.near_plane;
+			m_far_plane		= camera.far_plane;
+			m_view			= camera.view;
+			m_view_base		= camera.view_base;
+			m_projection	= camera.projection;
 
 			// TAA - Generate jitter
 			if (FlagEnabled(Render_PostProcess_TAA))
@@ -242,11 +291,611 @@ namespace Spartan
 			m_view_projection_orthographic	= m_view_base * m_projection_orthographic;
 		}
 
+		UpdateShadowAtlas();
+		Cull();
+		UpdateTextureStreaming();
+		BuildLightClusters();
+
 		m_is_rendering = true;
 		Pass_Main();
 		m_is_rendering = false;
 	}
 
+	void Renderer::Cull()
+	{
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		// Every job culls a range of one list of bounds against one frustum, the ranges
+		// start on a multiple of 32 so that no two jobs write to the same visibility word.
+		struct Cull_Job
+		{
+			const Frustum* frustum			= nullptr;
+			const SnapshotBounds* bounds	= nullptr;
+			uint32_t* visibility			= nullptr;
+			uint32_t start					= 0;
+			uint32_t end					= 0;
+		};
+		static const uint32_t job_size = 32 * 128;
+		vector<Cull_Job> jobs;
+
+		auto add_jobs = [&jobs](const Frustum& frustum, const SnapshotBounds& bounds, vector<uint32_t>& visibility)
+		{
+			visibility.assign((bounds.Size() + 31) / 32, 0);
+			for (uint32_t start = 0; start < bounds.Size(); start += job_size)
+			{
+				jobs.push_back({ &frustum, &bounds, visibility.data(), start, Min(start + job_size, bounds.Size()) });
+			}
+		};
+
+		// Camera
+		add_jobs(m_snapshot->camera.frustum, m_snapshot->bounds_opaque, m_visibility_opaque);
+		add_jobs(m_snapshot->camera.frustum, m_snapshot->bounds_transparent, m_visibility_transparent);
+
+		// Shadow map slices, directional lights bring their cascade frustums, spot lights and the faces of point light cube maps get theirs here
+		m_visibility_shadows.resize(m_snapshot->lights.size() * m_shadow_slice_count);
+		m_shadow_frustums.resize(m_snapshot->lights.size() * m_shadow_slice_count);
+		for (uint32_t light_index = 0; light_index < static_cast<uint32_t>(m_snapshot->lights.size()); light_index++)
+		{
+			const auto& light			= m_snapshot->lights[light_index];
+			uint32_t slice_count		= 0;
+			if (light.cast_shadows && light.type == LightType_Directional && light.shadow_map)
+			{
+				slice_count = Min(light.shadow_map->GetArraySize(), m_shadow_slice_count);
+			}
+			else if (light.cast_shadows && light.type != LightType_Directional)
+			{
+				// Lights that didn't get atlas tiles this frame don't render shadows
+				const auto entry	= m_shadow_atlas_entries.find(light.entity_id);
+				slice_count			= entry != m_shadow_atlas_entries.end() ? Min(static_cast<uint32_t>(entry->second.tiles.size()), m_shadow_slice_count) : 0;
+			}
+			for (uint32_t slice = 0; slice < m_shadow_slice_count; slice++)
+			{
+				auto& visibility = m_visibility_shadows[light_index * m_shadow_slice_count + slice];
+				if (slice >= slice_count)
+				{
+					visibility.clear();
+				}
+				else if (light.type == LightType_Directional && light.frustum_count != 0)
+				{
+					add_jobs(light.frustums[Min(slice, light.frustum_count - 1)], m_snapshot->bounds_opaque, visibility);
+				}
+				else if (light.type == LightType_Directional)
+				{
+					visibility.assign((m_snapshot->bounds_opaque.Size() + 31) / 32, 0xFFFFFFFF);
+				}
+				else
+				{
+					// Same depth as Light::ComputeProjectionMatrix() gives the far plane
+					auto& frustum	= m_shadow_frustums[light_index * m_shadow_slice_count + slice];
+					frustum			= Frustum(light.view[slice], light.projection[slice], m_reverse_z ? 0.1f : light.range);
+					add_jobs(frustum, m_snapshot->bounds_opaque, visibility);
+				}
+			}
+		}
+
+		m_threading->AddTaskLoop([&jobs](uint32_t start, uint32_t end)
+		{
+			for (uint32_t i = start; i < end; i++)
+			{
+				const auto& job = jobs[i];
+				job.bounds->Cull(*job.frustum, job.start, job.end, job.visibility);
+			}
+		}, static_cast<uint32_t>(jobs.size()));
+
+		TIME_BLOCK_END(m_profiler);
+
+		CullOcclusion();
+		CullShadowCasters();
+	}
+
+	void Renderer::CullShadowCasters()
+	{
+		m_profiler->m_renderer_shadow_casters			= 0;
+		m_profiler->m_renderer_shadow_casters_culled	= 0;
+
+		if (!m_snapshot->has_camera)
+			return;
+
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		const auto& bounds			= m_snapshot->bounds_opaque;
+		const auto& renderables		= m_snapshot->renderables_opaque;
+		const uint32_t slice_count	= static_cast<uint32_t>(m_visibility_shadows.size());
+
+		// Every slice extrudes the receivers the camera sees and keeps the casters in front of them, slices are independent of each other
+		vector<uint32_t> casters(slice_count, 0);
+		vector<uint32_t> culled(slice_count, 0);
+		m_threading->AddTaskLoop([this, &bounds, &renderables, &casters, &culled](uint32_t start, uint32_t end)
+		{
+			ShadowReceiverGrid receivers;
+			for (uint32_t slice_index = start; slice_index < end; slice_index++)
+			{
+				auto& visibility = m_visibility_shadows[slice_index];
+				if (visibility.empty())
+					continue;
+
+				const auto& light	= m_snapshot->lights[slice_index / m_shadow_slice_count];
+				const uint32_t i	= slice_index % m_shadow_slice_count;
+				receivers.Clear(light.view[i], light.projection[i]);
+
+				const uint32_t count = bounds.Size();
+				for (uint32_t index = 0; index < count; index++)
+				{
+					if (IsVisible(visibility, index) && IsVisible(m_visibility_opaque, index))
+					{
+						receivers.AddReceiver(Vector3(bounds.center_x[index], bounds.center_y[index], bounds.center_z[index]), Vector3(bounds.extent_x[index], bounds.extent_y[index], bounds.extent_z[index]));
+					}
+				}
+
+				for (uint32_t index = 0; index < count; index++)
+				{
+					if (!IsVisible(visibility, index) || !renderables[index].cast_shadows)
+						continue;
+
+					if (receivers.IsCasterRelevant(Vector3(bounds.center_x[index], bounds.center_y[index], bounds.center_z[index]), Vector3(bounds.extent_x[index], bounds.extent_y[index], bounds.extent_z[index])))
+					{
+						casters[slice_index]++;
+					}
+					else
+					{
+						visibility[index / 32] &= ~(1u << (index % 32));
+						culled[slice_index]++;
+					}
+				}
+			}
+		}, slice_count);
+
+		for (uint32_t i = 0; i < slice_count; i++)
+		{
+			m_profiler->m_renderer_shadow_casters			+= casters[i];
+			m_profiler->m_renderer_shadow_casters_culled	+= culled[i];
+		}
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
+	void Renderer::CullOcclusion()
+	{
+		m_profiler->m_renderer_occluders	= 0;
+		m_profiler->m_renderer_occluded		= 0;
+
+		if (!FlagEnabled(Render_OcclusionCulling) || !m_snapshot->has_camera)
+			return;
+
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		static const uint32_t occluder_count_max		= 32;
+		static const uint32_t occluder_triangles_max	= 2048;		// per occluder, unless it was tagged by hand
+		static const uint32_t occluder_triangles_budget	= 16384;	// for all of them
+		static const float occluder_coverage_min		= 0.1f;		// bounding radius over distance
+
+		const auto& renderables			= m_snapshot->renderables_opaque;
+		const auto& camera_position		= m_snapshot->camera.position;
+
+		// Pick the occluders among the visible opaque renderables, hand tagged ones first, then the ones covering the most screen
+		struct Occluder_Candidate
+		{
+			uint32_t index;
+			float score;
+		};
+		vector<Occluder_Candidate> candidates;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(renderables.size()); i++)
+		{
+			const auto& renderable = renderables[i];
+			if (!IsVisible(m_visibility_opaque, i) || !renderable.model || renderable.index_count == 0 || renderable.vertex_count == 0)
+				continue;
+
+			float score = numeric_limits<float>::max();
+			if (!renderable.is_occluder)
+			{
+				if (renderable.index_count / 3 > occluder_triangles_max)
+					continue;
+
+				const float radius		= renderable.aabb.GetExtents().Length();
+				const float distance	= Max(Vector3::Distance(renderable.aabb.GetCenter(), camera_position), 0.001f);
+				score					= radius / distance;
+				if (score < occluder_coverage_min)
+					continue;
+			}
+
+			candidates.push_back({ i, score });
+		}
+		sort(candidates.begin(), candidates.end(), [](const Occluder_Candidate& a, const Occluder_Candidate& b) { return a.score > b.score; });
+
+		// Set up the occluders, the rasterization itself is spread over the worker threads by rows of tiles
+		m_occlusion_buffer.Clear(m_snapshot->camera.view * m_snapshot->camera.projection);
+		vector<uint32_t> occluders;
+		uint32_t triangle_count = 0;
+		for (const auto& candidate : candidates)
+		{
+			if (occluders.size() == occluder_count_max)
+				break;
+
+			const auto& renderable = renderables[candidate.index];
+			if (triangle_count + renderable.index_count / 3 > occluder_triangles_budget)
+				continue;
+
+			if (const OccluderGeometry* geometry = GetOccluderGeometry(renderable))
+			{
+				m_occlusion_buffer.AddOccluder(renderable.transform, *geometry);
+				occluders.emplace_back(candidate.index);
+				triangle_count += renderable.index_count / 3;
+			}
+		}
+		m_profiler->m_renderer_occluders = static_cast<uint32_t>(occluders.size());
+
+		if (occluders.empty())
+		{
+			TIME_BLOCK_END(m_profiler);
+			return;
+		}
+
+		m_threading->AddTaskLoop([this](uint32_t start, uint32_t end)
+		{
+			m_occlusion_buffer.Rasterize(start, end);
+		}, m_occlusion_buffer.GetTileRowCount());
+
+		// Test everything that survived frustum culling, a word (32 renderables) at a time so that no two threads write to the same word.
+		// The occluders themselves are never culled, they would be tested against their own depth.
+		vector<uint32_t> occluder_words(m_visibility_opaque.size(), 0);
+		for (const uint32_t index : occluders)
+		{
+			occluder_words[index / 32] |= 1u << (index % 32);
+		}
+
+		const uint32_t word_count_opaque	= static_cast<uint32_t>(m_visibility_opaque.size());
+		const uint32_t word_count			= word_count_opaque + static_cast<uint32_t>(m_visibility_transparent.size());
+		atomic<uint32_t> occluded			= 0;
+		m_threading->AddTaskLoop([this, &occluder_words, &occluded, word_count_opaque](uint32_t start, uint32_t end)
+		{
+			uint32_t occluded_local = 0;
+			for (uint32_t word = start; word < end; word++)
+			{
+				const bool is_opaque	= word < word_count_opaque;
+				const uint32_t index	= is_opaque ? word : word - word_count_opaque;
+				uint32_t& visibility	= is_opaque ? m_visibility_opaque[index] : m_visibility_transparent[index];
+				const auto& renderables	= is_opaque ? m_snapshot->renderables_opaque : m_snapshot->renderables_transparent;
+
+				const uint32_t bits = visibility & ~(is_opaque ? occluder_words[index] : 0);
+				for (uint32_t bit = 0; bits != 0 && bit < 32; bit++)
+				{
+					if (!(bits & (1u << bit)))
+						continue;
+
+					if (!m_occlusion_buffer.IsVisible(renderables[index * 32 + bit].aabb))
+					{
+						visibility &= ~(1u << bit);
+						occluded_local++;
+					}
+				}
+			}
+			occluded += occluded_local;
+		}, word_count);
+		m_profiler->m_renderer_occluded = occluded;
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
+	void Renderer::UpdateShadowAtlas()
+	{
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		// A light's tiles only change size once it has asked for another size this many frames in a row,
+		// so that lights on the edge between two sizes don't render their shadows from scratch every frame
+		static const uint32_t resize_delay	= 30;
+		// Re-packing everything is reserved for when fragmentation makes allocations come up short, and happens once a second at most
+		static const uint32_t repack_delay	= 60;
+
+		if (!m_shadow_atlas_texture)
+		{
+			m_shadow_atlas_texture = make_shared<RHI_Texture2D>(m_context, m_shadow_atlas.GetSize(), m_shadow_atlas.GetSize(), Format_D32_FLOAT);
+		}
+
+		// The clear quad spans twice the screen, whatever viewport (tile) it's drawn with is covered
+		if (auto buffer = static_cast<Matrix*>(m_shadow_atlas_clear_buffer->Map()))
+		{
+			*buffer = Matrix::CreateScale(4.0f / m_resolution.x, 4.0f / m_resolution.y, 0.0f) * Matrix::CreateTranslation(Vector3(0.0f, 0.0f, GetClearDepth()));
+			m_shadow_atlas_clear_buffer->Unmap();
+		}
+
+		// What every light wants, from how much of the screen its range covers
+		const auto& camera				= m_snapshot->camera;
+		const float projection_scale	= camera.projection.m11; // 1 / tan(fov / 2)
+		const uint32_t tile_size_min	= m_shadow_atlas.GetTileSizeMin();
+		for (const auto& light : m_snapshot->lights)
+		{
+			if (light.type == LightType_Directional || !light.cast_shadows || light.shadow_slice_count == 0)
+				continue;
+
+			auto& entry			= m_shadow_atlas_entries[light.entity_id];
+			entry.frame_seen	= m_frame_num;
+			entry.slice_count	= light.shadow_slice_count;
+
+			// The light's sphere of influence, as a fraction of half the screen
+			float coverage = 0.0f;
+			if (m_snapshot->has_camera && camera.frustum.CheckSphere(light.position, light.range) != Outside)
+			{
+				const float distance	= Vector3::Distance(camera.position, light.position);
+				coverage				= distance <= light.range ? 1.0f : Min(light.range / Sqrt(distance * distance - light.range * light.range) * projection_scale, 1.0f);
+			}
+
+			// Cube maps take six tiles, so they get smaller ones
+			const uint32_t tile_size_max	= m_shadow_atlas.GetSize() / (light.type == LightType_Point ? 8 : 4);
+			entry.tile_size_wanted			= coverage > 0.0f ? m_shadow_atlas.GetTileSize(Max(static_cast<uint32_t>(coverage * tile_size_max), tile_size_min)) : 0;
+			entry.importance				= coverage * light.intensity;
+		}
+
+		// When all of it doesn't fit, the least important lights settle for smaller tiles (or none, once they're at the smallest)
+		const uint64_t atlas_area	= static_cast<uint64_t>(m_shadow_atlas.GetSize()) * m_shadow_atlas.GetSize();
+		const auto get_area			= [](const uint32_t tile_size, const uint32_t slice_count) { return static_cast<uint64_t>(tile_size) * tile_size * slice_count; };
+		vector<ShadowAtlasEntry*> wanting;
+		uint64_t area_wanted = 0;
+		for (auto& it : m_shadow_atlas_entries)
+		{
+			if (it.second.frame_seen == m_frame_num && it.second.tile_size_wanted != 0)
+			{
+				wanting.emplace_back(&it.second);
+				area_wanted += get_area(it.second.tile_size_wanted, it.second.slice_count);
+			}
+		}
+
+		if (area_wanted > atlas_area)
+		{
+			sort(wanting.begin(), wanting.end(), [](const ShadowAtlasEntry* a, const ShadowAtlasEntry* b) { return a->importance < b->importance; });
+			for (ShadowAtlasEntry* entry : wanting)
+			{
+				while (area_wanted > atlas_area && entry->tile_size_wanted != 0)
+				{
+					area_wanted -= get_area(entry->tile_size_wanted, entry->slice_count);
+					entry->tile_size_wanted = entry->tile_size_wanted > tile_size_min ? entry->tile_size_wanted / 2 : 0;
+					area_wanted += get_area(entry->tile_size_wanted, entry->slice_count);
+				}
+
+				if (area_wanted <= atlas_area)
+					break;
+			}
+		}
+
+		for (ShadowAtlasEntry* entry : wanting)
+		{
+			entry->frames_wanted = entry->tile_size_wanted == entry->tile_size ? 0 : entry->frames_wanted + 1;
+		}
+
+		// Allocates all the tiles of an entry, halving their size until they fit
+		auto allocate = [this, tile_size_min](ShadowAtlasEntry& entry)
+		{
+			for (uint32_t size = entry.tile_size_wanted; size >= tile_size_min; size /= 2)
+			{
+				for (uint32_t i = 0; i < entry.slice_count; i++)
+				{
+					const auto tile = m_shadow_atlas.Allocate(size);
+					if (!tile.IsValid())
+						break;
+
+					entry.tiles.emplace_back(tile);
+				}
+
+				if (entry.tiles.size() == entry.slice_count)
+				{
+					entry.tile_size = size;
+					return true;
+				}
+
+				for (auto& tile : entry.tiles)
+				{
+					m_shadow_atlas.Free(tile);
+				}
+				entry.tiles.clear();
+			}
+
+			entry.tile_size = 0;
+			return false;
+		};
+
+		// Free the tiles of lights that are gone, or that are due for a new size
+		vector<ShadowAtlasEntry*> pending;
+		for (auto it = m_shadow_atlas_entries.begin(); it != m_shadow_atlas_entries.end();)
+		{
+			auto& entry			= it->second;
+			const bool gone		= entry.frame_seen != m_frame_num;
+			const bool resize	= entry.tile_size != entry.tile_size_wanted && (entry.tile_size == 0 || entry.frames_wanted >= resize_delay);
+			if (gone || resize)
+			{
+				for (auto& tile : entry.tiles)
+				{
+					m_shadow_atlas.Free(tile);
+				}
+				entry.tiles.clear();
+				entry.tile_size		= 0;
+				entry.frames_wanted	= 0;
+			}
+
+			if (gone)
+			{
+				it = m_shadow_atlas_entries.erase(it);
+				continue;
+			}
+
+			if (entry.tile_size == 0 && entry.tile_size_wanted != 0)
+			{
+				pending.emplace_back(&entry);
+			}
+			++it;
+		}
+
+		// Hand out tiles, most important lights first, and keep track of how much area the lights came up short
+		sort(pending.begin(), pending.end(), [](const ShadowAtlasEntry* a, const ShadowAtlasEntry* b) { return a->importance > b->importance; });
+		uint64_t area_short = 0;
+		for (ShadowAtlasEntry* entry : pending)
+		{
+			allocate(*entry);
+			area_short += get_area(entry->tile_size_wanted, entry->slice_count) - get_area(entry->tile_size, entry->slice_count);
+		}
+
+		// Freed tiles leave holes that larger tiles don't fit in. If there is enough free area for what the lights came up short,
+		// that's fragmentation, so start over. Otherwise tiles which are still waiting to shrink hold the area, and they will give it
+		// back on their own. Largest tiles first packs a quadtree without holes, and what's wanted fits (see above), so everyone gets theirs.
+		const uint64_t area_free = atlas_area - m_shadow_atlas.GetAreaUsed();
+		if (area_short != 0 && area_short <= area_free && m_frame_num - m_shadow_atlas_repack_frame >= repack_delay)
+		{
+			m_shadow_atlas.Reset();
+			pending.clear();
+			for (auto& it : m_shadow_atlas_entries)
+			{
+				it.second.tiles.clear();
+				it.second.tile_size		= 0;
+				it.second.frames_wanted	= 0;
+				if (it.second.tile_size_wanted != 0)
+				{
+					pending.emplace_back(&it.second);
+				}
+			}
+
+			sort(pending.begin(), pending.end(), [](const ShadowAtlasEntry* a, const ShadowAtlasEntry* b)
+			{
+				return a->tile_size_wanted != b->tile_size_wanted ? a->tile_size_wanted > b->tile_size_wanted : a->importance > b->importance;
+			});
+			for (ShadowAtlasEntry* entry : pending)
+			{
+				allocate(*entry);
+			}
+
+			m_shadow_atlas_repack_frame = m_frame_num;
+		}
+
+		uint32_t lights = 0;
+		for (const auto& it : m_shadow_atlas_entries)
+		{
+			lights += it.second.tiles.empty() ? 0 : 1;
+		}
+		m_profiler->m_renderer_shadow_atlas_lights	= lights;
+		m_profiler->m_renderer_shadow_atlas_usage	= 100.0f * static_cast<float>(m_shadow_atlas.GetAreaUsed()) / static_cast<float>(atlas_area);
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
+	void Renderer::UpdateTextureStreaming()
+	{
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		// Uploads what was read since the last frame, this is the only place where streamed textures get recreated
+		m_texture_streamer.Update(m_threading, m_frame_num);
+
+		const auto& camera				= m_snapshot->camera;
+		const float projection_scale	= camera.projection.m11; // 1 / tan(fov / 2)
+		const auto request = [this, &camera, projection_scale](const SnapshotRenderable& renderable)
+		{
+			if (!renderable.material)
+				return;
+
+			// How many pixels the renderable's bounding sphere spans, anything that contains the camera wants it all
+			const auto radius	= renderable.aabb.GetExtents().Length();
+			const auto distance	= Vector3::Distance(camera.position, renderable.aabb.GetCenter());
+			auto pixels			= distance <= radius ? numeric_limits<float>::max() : radius / distance * projection_scale * m_resolution.y;
+
+			// A tiled texture repeats across the surface, so every repeat gets fewer pixels
+			const auto& tiling	= renderable.material->tiling;
+			pixels				/= Max(Max(tiling.x, tiling.y), 1.0f);
+
+			for (const auto& texture : renderable.material->textures)
+			{
+				m_texture_streamer.Request(texture, pixels, m_frame_num);
+			}
+		};
+
+		// Next frame's uploads are for what is visible now
+		const auto& renderables_opaque = m_snapshot->renderables_opaque;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(renderables_opaque.size()); i++)
+		{
+			if (IsVisible(m_visibility_opaque, i))
+			{
+				request(renderables_opaque[i]);
+			}
+		}
+
+		const auto& renderables_transparent = m_snapshot->renderables_transparent;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(renderables_transparent.size()); i++)
+		{
+			if (IsVisible(m_visibility_transparent, i))
+			{
+				request(renderables_transparent[i]);
+			}
+		}
+
+		m_profiler->m_renderer_texture_streaming_memory	= m_texture_streamer.GetMemoryUsage();
+		m_profiler->m_renderer_texture_streaming_reads	= m_texture_streamer.GetReadsInFlight();
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
+	void Renderer::BuildLightClusters()
+	{
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		// Lights with shadows still need their own pass (and shadow map), directional lights cover every cluster anyway
+		m_lights_clustered.clear();
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_snapshot->lights.size()); i++)
+		{
+			const auto& light = m_snapshot->lights[i];
+			if (light.type != LightType_Directional && !light.cast_shadows && light.intensity > 0.0f && light.range > 0.0f)
+			{
+				m_lights_clustered.emplace_back(i);
+			}
+		}
+		m_profiler->m_renderer_lights_clustered = static_cast<uint32_t>(m_lights_clustered.size());
+
+		if (!m_lights_clustered.empty())
+		{
+			// Same (jittered) projection as the g-buffer, so that the clusters line up with the pixels that look them up
+			m_light_clusters.Begin(m_view, m_projection, m_near_plane, m_far_plane, static_cast<uint32_t>(m_lights_clustered.size()));
+
+			m_threading->AddTaskLoop([this](uint32_t start, uint32_t end)
+			{
+				for (uint32_t i = start; i < end; i++)
+				{
+					const auto& light = m_snapshot->lights[m_lights_clustered[i]];
+					m_light_clusters.SetLight(i, light.position, light.range);
+				}
+			}, static_cast<uint32_t>(m_lights_clustered.size()));
+
+			m_threading->AddTaskLoop([this](uint32_t start, uint32_t end)
+			{
+				m_light_clusters.Bin(start, end);
+			}, m_light_clusters.GetSliceCount());
+
+			m_light_clusters.Compact();
+		}
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
+	const OccluderGeometry* Renderer::GetOccluderGeometry(const SnapshotRenderable& renderable)
+	{
+		// Geometry only changes when a model is re-imported, so a stale entry is simply caught by its size
+		const uint64_t key	= (static_cast<uint64_t>(renderable.model->GetId()) << 32) | renderable.index_offset;
+		auto& geometry		= m_occluder_geometry[key];
+		if (geometry.indices.size() == renderable.index_count && geometry.positions.size() == renderable.vertex_count)
+			return &geometry;
+
+		vector<uint32_t> indices;
+		vector<RHI_Vertex_PosTexNorTan> vertices;
+		renderable.model->GeometryGet(renderable.index_offset, renderable.index_count, renderable.vertex_offset, renderable.vertex_count, &indices, &vertices);
+		if (indices.empty() || vertices.empty())
+		{
+			m_occluder_geometry.erase(key);
+			return nullptr;
+		}
+
+		geometry.indices = move(indices);
+		geometry.positions.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			geometry.positions[i] = Vector3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+		}
+
+		return &geometry;
+	}
+
 	void Renderer::SetResolution(uint32_t width, uint32_t height)
 	{
 		// Return if resolution is invalid
@@ -318,14 +967,12 @@ namespace Spartan
 		}
 
         float light_directional_intensity = 0.0f;
-        if (!m_entities[Renderer_Object_LightDirectional].empty())
+        for (const auto& light : m_snapshot->lights)
         {
-            if (Entity * entity = m_entities[Renderer_Object_LightDirectional].front())
+            if (light.type == LightType_Directional)
             {
-                if (shared_ptr<Light>& light = entity->GetComponent<Light>())
-                {
-                    light_directional_intensity = light->GetIntensity();
-                }
+                light_directional_intensity = light.intensity;
+                break;
             }
         }
 
@@ -336,9 +983,9 @@ namespace Spartan
 		buffer->m_view_projection		    = m_view_projection;
 		buffer->m_view_projection_inv	    = m_view_projection_inv;
 		buffer->m_view_projection_ortho	    = m_view_projection_orthographic;
-		buffer->camera_position			    = m_camera->GetTransform()->GetPosition();
-		buffer->camera_near				    = m_camera->GetNearPlane();
-		buffer->camera_far				    = m_camera->GetFarPlane();
+		buffer->camera_position			    = m_snapshot->camera.position;
+		buffer->camera_near				    = m_snapshot->camera.near_plane;
+		buffer->camera_far				    = m_snapshot->camera.far_plane;
 		buffer->resolution				    = Vector2(static_cast<float>(resolution_width), static_cast<float>(resolution_height));
 		buffer->fxaa_sub_pixel			    = m_fxaa_sub_pixel;
 		buffer->fxaa_edge_threshold		    = m_fxaa_edge_threshold;
@@ -359,91 +1006,6 @@ namespace Spartan
 		return m_uber_buffer->Unmap();
 	}
 
-	void Renderer::RenderablesAcquire(const Variant& entities_variant)
-	{
-        while(m_acquiring_renderables)
-        {
-            LOGF_WARNING("Waiting for previous operation to finish...");
-        }
-        m_acquiring_renderables = true;
-
-		TIME_BLOCK_START_CPU(m_profiler);
-
-		// Clear previous state
-		m_entities.clear();
-		m_camera = nullptr;
-
-		vector<shared_ptr<Entity>> entities = entities_variant.Get<vector<shared_ptr<Entity>>>();
-		for (const auto& entity : entities)
-		{
-			if (!entity || !entity->IsActive())
-				continue;
-
-			// Get all the components we are interested in
-			auto renderable = entity->GetComponent<Renderable>();
-			auto light		= entity->GetComponent<Light>();
-			auto camera		= entity->GetComponent<Camera>();
-
-			if (renderable)
-			{
-				const auto is_transparent = !renderable->HasMaterial() ? false : renderable->GetMaterial()->GetColorAlbedo().w < 1.0f;
-                m_entities[is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque].emplace_back(entity.get());
-			}
-
-			if (light)
-			{
-				m_entities[Renderer_Object_Light].emplace_back(entity.get());
-
-                if (light->GetLightType() == LightType_Directional) m_entities[Renderer_Object_LightDirectional].emplace_back(entity.get());
-                if (light->GetLightType() == LightType_Point)       m_entities[Renderer_Object_LightPoint].emplace_back(entity.get());
-                if (light->GetLightType() == LightType_Spot)        m_entities[Renderer_Object_LightSpot].emplace_back(entity.get());
-			}
-
-			if (camera)
-			{
-				m_entities[Renderer_Object_Camera].emplace_back(entity.get());
-				m_camera = camera;
-			}
-		}
-
-		RenderablesSort(&m_entities[Renderer_Object_Opaque]);
-		RenderablesSort(&m_entities[Renderer_Object_Transparent]);
-
-		TIME_BLOCK_END(m_profiler);
-
-        m_acquiring_renderables = false;
-	}
-
-	void Renderer::RenderablesSort(vector<Entity*>* renderables)
-	{
-		if (!m_camera || renderables->size() <= 2)
-			return;
-
-		auto render_hash = [this](Entity* entity)
-		{
-			// Get renderable
-			auto renderable = entity->GetRenderable_PtrRaw();
-			if (!renderable)
-				return 0.0f;
-
-			// Get material
-			const auto material = renderable->GetMaterial();
-			if (!material)
-				return 0.0f;
-
-			const auto num_depth    = (renderable->GetAabb().GetCenter() - m_camera->GetTransform()->GetPosition()).LengthSquared();
-			const auto num_material = static_cast<float>(material->GetId());
-
-			return stof(to_string(num_depth) + "-" + to_string(num_material));
-		};
-
-		// Sort by depth (front to back), then sort by material		
-		sort(renderables->begin(), renderables->end(), [&render_hash](Entity* a, Entity* b)
-		{
-            return render_hash(a) < render_hash(b);
-		});
-	}
-
 	shared_ptr<RHI_RasterizerState>& Renderer::GetRasterizerState(const RHI_Cull_Mode cull_mode, const RHI_Fill_Mode fill_mode)
 	{
 		if (cull_mode == Cull_Back)		return (fill_mode == Fill_Solid) ? m_rasterizer_cull_back_solid		: m_rasterizer_cull_back_wireframe;
@@ -24,7 +24,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <vector>
-#include <atomic>
 #include <map>
 #include <unordered_map>
 #include "../Core/ISubsystem.h"
@@ -33,6 +32,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Math/Matrix.h"
 #include "../Math/Vector2.h"
 #include "../Math/Rectangle.h"
+#include "../Math/Frustum.h"
+#include "Culling/OcclusionBuffer.h"
+#include "Culling/LightClusters.h"
+#include "Shadows/ShadowAtlas.h"
+#include "Streaming/TextureStreamer.h"
 //================================
 
 namespace Spartan
@@ -43,14 +47,15 @@ namespace Spartan
 	class Light;
 	class ResourceCache;
 	class Font;
-	class Variant;
 	class Grid;
 	class Transform_Gizmo;
 	class Profiler;
+	class Threading;
+	struct WorldSnapshot;
+	struct SnapshotRenderable;
 	namespace Math
 	{
 		class BoundingBox;
-		class Frustum;
 	}
 
 	enum Renderer_Option : uint32_t
@@ -72,7 +77,8 @@ namespace Spartan
 		Render_PostProcess_MotionBlur			= 1 << 14,
 		Render_PostProcess_Sharpening			= 1 << 15,
 		Render_PostProcess_ChromaticAberration	= 1 << 16,
-		Render_PostProcess_Dithering			= 1 << 17
+		Render_PostProcess_Dithering			= 1 << 17,
+		Render_OcclusionCulling					= 1 << 18
 	};
 
 	enum Renderer_Buffer_Type
@@ -100,17 +106,6 @@ namespace Spartan
 		ToneMapping_Uncharted2
 	};
 
-	enum Renderer_Object_Type
-	{
-		Renderer_Object_Opaque,
-		Renderer_Object_Transparent,
-        Renderer_Object_Light,
-		Renderer_Object_LightDirectional,
-        Renderer_Object_LightPoint,
-        Renderer_Object_LightSpot,
-		Renderer_Object_Camera
-	};
-
 	enum Renderer_Shader_Type
 	{
 		Shader_Gbuffer_V,
@@ -140,6 +135,7 @@ namespace Spartan
         Shader_LightDirectional_P,
         Shader_LightPoint_P,
         Shader_LightSpot_P,
+        Shader_LightClustered_P,
 		Shader_Composition_P,
 		Shader_Color_Vp,
 		Shader_Font_Vp,
@@ -246,6 +242,16 @@ namespace Spartan
         // Shadow
         auto GetShadowResolution()                          { return m_resolution_shadow; }
         void SetShadowResolution(uint32_t resolution);
+        // A directional light's cascade is re-rendered every this many frames (1 means every frame), in between it keeps its cached shadow map
+        uint32_t GetShadowCascadeInterval(uint32_t cascade) const  { return cascade < m_shadow_cascade_interval.size() ? m_shadow_cascade_interval[cascade] : 1; }
+        void SetShadowCascadeInterval(uint32_t cascade, uint32_t interval);
+        // Point and spot lights share a single shadow map, every light gets tiles of it sized by its screen coverage
+        auto GetShadowAtlasResolution() const                       { return m_resolution_shadow_atlas; }
+        void SetShadowAtlasResolution(uint32_t resolution);
+
+        // Texture streaming, the finer mips of the material textures are streamed in by the screen size of what uses them
+        auto GetTextureStreamingBudget() const                      { return m_texture_streamer.GetMemoryBudget(); }
+        void SetTextureStreamingBudget(const uint64_t bytes)        { m_texture_streamer.SetMemoryBudget(bytes); }
 
         // Anisotropy
         auto GetAnisotropy()                                { return m_anisotropy; }
@@ -290,6 +296,23 @@ namespace Spartan
 		void CreateRenderTextures();
         //==============================
 
+		//= CULLING ============================================================================================================================================
+		// Tests the snapshot's renderables against the camera and every shadow cascade, in batches spread across the worker threads
+		void Cull();
+		// Drops the shadow casters that can't cast onto anything the camera sees, per shadow map slice
+		void CullShadowCasters();
+		// Rasterizes the biggest on screen occluders into a software depth buffer and clears the visibility of whatever they hide
+		void CullOcclusion();
+		const OccluderGeometry* GetOccluderGeometry(const SnapshotRenderable& renderable);
+		// Sizes the shadow atlas tiles of the point and spot lights by screen coverage, and places them by importance
+		void UpdateShadowAtlas();
+		// Asks the texture streamer for the mips that the visible renderables need, by their size on screen
+		void UpdateTextureStreaming();
+		// Bins the shadowless point and spot lights into view space clusters, Pass_Light shades all of them in a single draw
+		void BuildLightClusters();
+		static bool IsVisible(const std::vector<uint32_t>& visibility, const uint32_t index) { return (visibility[index / 32] & (1u << (index % 32))) != 0; }
+		//======================================================================================================================================================
+
 		//= PASSES ============================================================================================================================================
 		void Pass_Main();
 		void Pass_LightDepth();
@@ -323,11 +346,8 @@ namespace Spartan
 
         //= MISC =======================================================================================================================
         bool UpdateUberBuffer(uint32_t resolution_width, uint32_t resolution_height, const Math::Matrix& mMVP = Math::Matrix::Identity);
-        void RenderablesAcquire(const Variant& renderables);
-        void RenderablesSort(std::vector<Entity*>* renderables);
         std::shared_ptr<RHI_RasterizerState>& GetRasterizerState(RHI_Cull_Mode cull_mode, RHI_Fill_Mode fill_mode);
         void* GetEnvironmentTexture_GpuResource();
-        void ClearEntities() { m_entities.clear(); }
         //==============================================================================================================================
 
         //= RENDER TEXTURES ================================================================
@@ -351,6 +371,7 @@ namespace Spartan
 		//= DEPTH-STENCIL STATES =======================================
 		std::shared_ptr<RHI_DepthStencilState> m_depth_stencil_enabled;
 		std::shared_ptr<RHI_DepthStencilState> m_depth_stencil_disabled;
+		std::shared_ptr<RHI_DepthStencilState> m_depth_stencil_overwrite;
 		//==============================================================
 
         //= BLEND STATES =================================
@@ -422,7 +443,6 @@ namespace Spartan
         bool m_is_odd_frame                         = false;
         bool m_is_rendering                         = false;
         bool m_brdf_specular_lut_rendered           = false;
-        std::atomic<bool> m_acquiring_renderables   = false;
 		//=================================================================
 
 		//= RHI ============================================
@@ -431,14 +451,69 @@ namespace Spartan
 		std::shared_ptr<RHI_PipelineCache> m_pipeline_cache;
 		//==================================================
                                                                                   
-		//= ENTITIES/COMPONENTS ==================================================
-		std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities;
+		//= ENTITIES/COMPONENTS ===================================================
+		std::shared_ptr<const WorldSnapshot> m_snapshot; // held for the duration of a frame
 		std::shared_ptr<Camera> m_camera;
-		//========================================================================
+		//=========================================================================
+
+		//= CULLING ===============================================================================================
+		std::vector<uint32_t> m_visibility_opaque;				// a bit per opaque renderable of the snapshot
+		std::vector<uint32_t> m_visibility_transparent;			// a bit per transparent renderable of the snapshot
+		std::vector<std::vector<uint32_t>> m_visibility_shadows;	// a bit per opaque renderable, per light shadow map slice (cascade or cube face)
+		std::vector<Math::Frustum> m_shadow_frustums;				// of the spot light and cube map faces, the cascades have their own
+		static constexpr uint32_t m_shadow_slice_count = 6;		// slices per light in m_visibility_shadows
+		OcclusionBuffer m_occlusion_buffer;
+		std::unordered_map<uint64_t, OccluderGeometry> m_occluder_geometry;	// keyed by model id and index offset
+		LightClusters m_light_clusters;
+		std::vector<uint32_t> m_lights_clustered;							// indices into the snapshot's lights
+		//=========================================================================================================
+
+		//= SHADOW CACHE ==========================================================================================
+		struct ShadowSlice
+		{
+			uint64_t signature_static	= 0;	// view projection and static casters the slice was rendered with
+			uint64_t signature_dynamic	= 0;	// dynamic casters the slice was rendered with
+			uint64_t signature_cached	= 0;	// static casters held by the static depth slice
+			uint64_t frame				= 0;
+			Math::Matrix view_projection;		// the light pass has to sample with what the slice was rendered with
+			bool valid					= false;
+		};
+		struct ShadowCache
+		{
+			std::vector<ShadowSlice> slices;
+			std::shared_ptr<RHI_Texture> static_depth;	// static casters only, created once a light has dynamic casters
+			const RHI_Texture* shadow_map	= nullptr;	// a recreated shadow map invalidates everything
+			uint64_t frame_seen				= 0;
+		};
+		std::unordered_map<uint32_t, ShadowCache> m_shadow_caches;	// keyed by light entity id
+		std::vector<uint32_t> m_shadow_cascade_interval = { 1, 1, 2, 4 };
+		//=========================================================================================================
+
+		//= SHADOW ATLAS ==========================================================================================
+		struct ShadowAtlasEntry
+		{
+			std::vector<ShadowAtlas::Tile> tiles;	// one per shadow slice, all of the same size
+			uint32_t slice_count		= 0;
+			uint32_t tile_size			= 0;		// what the tiles have now
+			uint32_t tile_size_wanted	= 0;		// what the light's screen coverage asks for
+			uint32_t frames_wanted		= 0;		// frames the two have disagreed for
+			float importance			= 0.0f;
+			uint64_t frame_seen			= 0;
+		};
+		ShadowAtlas m_shadow_atlas;
+		std::shared_ptr<RHI_Texture> m_shadow_atlas_texture;
+		std::shared_ptr<RHI_ConstantBuffer> m_shadow_atlas_clear_buffer;		// places the quad that clears a tile
+		std::unordered_map<uint32_t, ShadowAtlasEntry> m_shadow_atlas_entries;	// keyed by light entity id
+		uint32_t m_resolution_shadow_atlas		= 4096;
+		uint64_t m_shadow_atlas_repack_frame	= 0;
+		//=========================================================================================================
+
+		TextureStreamer m_texture_streamer;
 
 		//= DEPENDENCIES =========================
 		Profiler* m_profiler	        = nullptr;
         ResourceCache* m_resource_cache = nullptr;
+        Threading* m_threading          = nullptr;
 		//========================================
 		
 		// Uber buffer (holds what is needed by almost every shader)
@@ -479,5 +554,33 @@ namespace Spartan
             float padding;
 		};
 		std::shared_ptr<RHI_ConstantBuffer> m_uber_buffer;
+
+		// Clustered lighting, has to match LightClustered.hlsl
+		struct ClusterLight
+		{
+			Math::Vector3 color;
+			float intensity;
+			Math::Vector3 position;
+			float range;
+			Math::Vector3 direction;
+			float angle;
+			float is_spot;
+			Math::Vector3 padding;
+		};
+
+		struct ClusterBuffer
+		{
+			uint32_t cluster_count_x;
+			uint32_t cluster_count_y;
+			uint32_t cluster_count_z;
+			uint32_t light_count;
+			float slice_scale;
+			float slice_bias;
+			Math::Vector2 padding;
+		};
+		std::shared_ptr<RHI_ConstantBuffer> m_cluster_buffer;
+		std::shared_ptr<RHI_StructuredBuffer> m_cluster_grid;
+		std::shared_ptr<RHI_StructuredBuffer> m_cluster_indices;
+		std::shared_ptr<RHI_StructuredBuffer> m_cluster_lights;
 	};
 }
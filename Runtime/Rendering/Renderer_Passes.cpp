@@ -32,10 +32,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Gizmos/Transform_Gizmo.h"
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_ConstantBuffer.h"
+#include "../RHI/RHI_StructuredBuffer.h"
 #include "../RHI/RHI_Texture.h"
+#include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_Sampler.h"
 #include "../RHI/RHI_CommandList.h"
 #include "../World/Entity.h"
+#include "../World/WorldSnapshot.h"
 #include "../World/Components/Renderable.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Environment.h"
@@ -89,30 +92,49 @@ namespace Spartan
 		if (!shader_depth->IsCompiled())
 			return;
 
-        // Get opaque entities
-        const auto& entities_opaque = m_entities[Renderer_Object_Opaque];
-        if (entities_opaque.empty())
+        // Get opaque renderables
+        const auto& renderables_opaque = m_snapshot->renderables_opaque;
+        if (renderables_opaque.empty())
             return;
 
-        // Get light entities
-		const auto& entities_light = m_entities[Renderer_Object_Light];
+		uint32_t slices_rendered	= 0;
+		uint32_t slices_skipped		= 0;
+		vector<uint32_t> casters_static;
+		vector<uint32_t> casters_dynamic;
 
-		for (const auto& light_entity : entities_light)
+		for (uint32_t light_index = 0; light_index < static_cast<uint32_t>(m_snapshot->lights.size()); light_index++)
 		{
-			const auto& light = light_entity->GetComponent<Light>();
-
-            // Light can be null if it just got removed and our buffer doesn't update till the next frame
-            if (!light)
-                break;
+			const auto& light = m_snapshot->lights[light_index];
 
 			// Skip if it doesn't need to cast shadows
-			if (!light->GetCastShadows())
+			if (!light.cast_shadows)
 				continue;
 
-			// Acquire light's shadow map
-			const auto& shadow_map = light->GetShadowMap();
+			// Acquire light's shadow map, point and spot lights render into their tiles of the shadow atlas
+			const bool in_atlas						= light.type != LightType_Directional;
+			const ShadowAtlasEntry* atlas_entry		= nullptr;
+			if (in_atlas)
+			{
+				const auto entry = m_shadow_atlas_entries.find(light.entity_id);
+				if (entry == m_shadow_atlas_entries.end() || entry->second.tiles.empty())
+					continue;
+
+				atlas_entry = &entry->second;
+			}
+			const auto& shadow_map = in_atlas ? m_shadow_atlas_texture : light.shadow_map;
 			if (!shadow_map)
 				continue;
+			const uint32_t slice_count = in_atlas ? static_cast<uint32_t>(atlas_entry->tiles.size()) : shadow_map->GetArraySize();
+
+			// Acquire the light's cache, it starts over if the shadow map was recreated
+			auto& cache = m_shadow_caches[light.entity_id];
+			if (cache.shadow_map != shadow_map.get() || cache.slices.size() != slice_count)
+			{
+				cache				= ShadowCache();
+				cache.shadow_map	= shadow_map.get();
+				cache.slices.resize(slice_count);
+			}
+			cache.frame_seen = m_frame_num;
 
 			// Begin command list
 			m_cmd_list->Begin("Pass_LightDepth");
@@ -123,75 +145,203 @@ namespace Spartan
 			m_cmd_list->SetPrimitiveTopology(PrimitiveTopology_TriangleList);
 			m_cmd_list->SetShaderVertex(shader_depth);
 			m_cmd_list->SetInputLayout(shader_depth->GetInputLayout());
-			m_cmd_list->SetViewport(shadow_map->GetViewport());
 
 			// Tracking
 			uint32_t currently_bound_geometry   = 0;
 
-			for (uint32_t i = 0; i < light->GetShadowMap()->GetArraySize(); i++)
+			// Draws a list of casters into whatever depth stencil is bound
+			auto draw_casters = [this, &renderables_opaque, &currently_bound_geometry](const vector<uint32_t>& casters, const Matrix& light_view_projection, const uint32_t slice)
 			{
-				const auto cascade_depth_stencil = shadow_map->GetResource_DepthStencil(i);
+				for (const uint32_t renderable_index : casters)
+				{
+					const auto& renderable	= renderables_opaque[renderable_index];
+					const auto& model		= renderable.model;
 
-				m_cmd_list->Begin("Array_" + to_string(i + 1));
-				m_cmd_list->ClearDepthStencil(cascade_depth_stencil, Clear_Depth, GetClearDepth());
-				m_cmd_list->SetRenderTarget(nullptr, cascade_depth_stencil);
+					// Bind geometry
+					if (currently_bound_geometry != model->GetId())
+					{
+						m_cmd_list->SetBufferIndex(model->GetIndexBuffer());
+						m_cmd_list->SetBufferVertex(model->GetVertexBuffer());
+						currently_bound_geometry = model->GetId();
+					}
 
-				auto light_view_projection = light->GetViewMatrix(i) * light->GetProjectionMatrix(i);
+					// Update constant buffer
+					const auto& transform = renderable.transform_component;
+					transform->UpdateConstantBufferLight(m_rhi_device, renderable.transform, light_view_projection, slice);
+                    if (const shared_ptr<RHI_ConstantBuffer>& buffer = transform->GetConstantBufferLight(slice))
+                    {
+                        if (buffer->GetResource())
+                        {
+                            m_cmd_list->SetConstantBuffer(1, Buffer_VertexShader, buffer);
+                        }
+                    }
+					m_cmd_list->DrawIndexed(renderable.index_count, renderable.index_offset, renderable.vertex_offset);
+				}
+			};
 
-				for (const auto& entity : entities_opaque)
+			for (uint32_t i = 0; i < slice_count; i++)
+			{
+				auto& slice = cache.slices[i];
+
+				// Far cascades of directional lights are only due every few frames, staggered so that lights and cascades don't all land on the same frame
+				if (light.type == LightType_Directional && slice.valid)
 				{
-					// Acquire renderable component
-					const auto& renderable = entity->GetRenderable_PtrRaw();
-					if (!renderable)
+					const uint32_t interval = GetShadowCascadeInterval(i);
+					if ((m_frame_num + light_index + i) % interval != 0)
+					{
+						slices_skipped++;
 						continue;
+					}
+				}
+
+				const auto light_view_projection = light.view[i] * light.projection[i];
+				const auto& visibility = m_visibility_shadows[light_index * m_shadow_slice_count + i];
+
+				// Gather the casters and sign what the slice would be rendered from, casters that haven't moved for a while are static
+				casters_static.clear();
+				casters_dynamic.clear();
+				uint64_t signature_static	= 14695981039346656037ull;
+				uint64_t signature_dynamic	= 14695981039346656037ull;
+				const auto sign = [](uint64_t& signature, const uint64_t value) { signature = (signature ^ value) * 1099511628211ull; };
+				for (uint32_t r = 0; r < 4; r++)
+				{
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						const float value = light_view_projection.Data()[r * 4 + c];
+						sign(signature_static, *reinterpret_cast<const uint32_t*>(&value));
+					}
+				}
+				const float clear_depth = GetClearDepth();
+				sign(signature_static, *reinterpret_cast<const uint32_t*>(&clear_depth));
+				if (in_atlas)
+				{
+					const auto& tile = atlas_entry->tiles[i];
+					sign(signature_static, (static_cast<uint64_t>(tile.x) << 32) | tile.y);
+					sign(signature_static, tile.size);
+				}
 
+				for (uint32_t renderable_index = 0; renderable_index < static_cast<uint32_t>(renderables_opaque.size()); renderable_index++)
+				{
                     // Skip objects outside of the view frustum
-                    if (!light->IsInViewFrustrum(renderable, i))
+                    if (!IsVisible(visibility, renderable_index))
                         continue;
 
+					const auto& renderable = renderables_opaque[renderable_index];
+
 					// Acquire material
-					const auto& material = renderable->GetMaterial();
+					const auto& material = renderable.material;
 					if (!material)
 						continue;
 
 					// Acquire geometry
-					const auto& model = renderable->GeometryModel();
+					const auto& model = renderable.model;
 					if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
 						continue;
 
 					// Skip meshes that don't cast shadows
-					if (!renderable->GetCastShadows())
+					if (!renderable.cast_shadows)
 						continue;
 
 					// Skip transparent meshes (for now)
-					if (material->GetColorAlbedo().w < 1.0f)
+					if (material->color_albedo.w < 1.0f)
 						continue;
 
-					// Bind geometry
-					if (currently_bound_geometry != model->GetId())
+					auto& signature = renderable.is_static ? signature_static : signature_dynamic;
+					sign(signature, renderable.entity_id);
+					sign(signature, renderable.transform_version);
+					sign(signature, (static_cast<uint64_t>(model->GetId()) << 32) | renderable.index_offset);
+					(renderable.is_static ? casters_static : casters_dynamic).emplace_back(renderable_index);
+				}
+
+				// Nothing that would end up in the slice has changed
+				if (slice.valid && slice.signature_static == signature_static && slice.signature_dynamic == signature_dynamic)
+				{
+					slices_skipped++;
+					continue;
+				}
+
+				const auto cascade_depth_stencil = shadow_map->GetResource_DepthStencil(in_atlas ? 0 : i);
+				m_cmd_list->Begin("Array_" + to_string(i + 1));
+
+				if (in_atlas)
+				{
+					const auto& tile = atlas_entry->tiles[i];
+					m_cmd_list->SetViewport(RHI_Viewport(static_cast<float>(tile.x), static_cast<float>(tile.y), static_cast<float>(tile.size), static_cast<float>(tile.size)));
+				}
+				else
+				{
+					m_cmd_list->SetViewport(shadow_map->GetViewport());
+				}
+
+				if (in_atlas)
+				{
+					m_cmd_list->SetRenderTarget(nullptr, cascade_depth_stencil);
+
+					// Depth stencil views can only be cleared whole, so the tile is cleared by drawing a quad at the clear depth over it
+					m_cmd_list->SetDepthStencilState(m_depth_stencil_overwrite);
+					m_cmd_list->SetRasterizerState(m_rasterizer_cull_none_solid);
+					m_cmd_list->SetBufferVertex(m_quad.GetVertexBuffer());
+					m_cmd_list->SetBufferIndex(m_quad.GetIndexBuffer());
+					m_cmd_list->SetConstantBuffer(1, Buffer_VertexShader, m_shadow_atlas_clear_buffer);
+					m_cmd_list->DrawIndexed(Rectangle::GetIndexCount(), 0, 0);
+					m_cmd_list->SetDepthStencilState(m_depth_stencil_enabled);
+					m_cmd_list->SetRasterizerState(m_rasterizer_cull_back_solid);
+					currently_bound_geometry = 0;
+
+					// The tiles are too many and too small to be worth a static layer of their own
+					draw_casters(casters_static, light_view_projection, i);
+					draw_casters(casters_dynamic, light_view_projection, i);
+				}
+				else if (casters_dynamic.empty())
+				{
+					// Only static casters, draw them straight into the slice
+					m_cmd_list->ClearDepthStencil(cascade_depth_stencil, Clear_Depth, clear_depth);
+					m_cmd_list->SetRenderTarget(nullptr, cascade_depth_stencil);
+					draw_casters(casters_static, light_view_projection, i);
+				}
+				else
+				{
+					// Keep the static casters in a depth buffer of their own, so that moving casters only cost their own draws
+					if (!cache.static_depth)
 					{
-						m_cmd_list->SetBufferIndex(model->GetIndexBuffer());
-						m_cmd_list->SetBufferVertex(model->GetVertexBuffer());
-						currently_bound_geometry = model->GetId();
+						cache.static_depth = make_shared<RHI_Texture2D>(m_context, shadow_map->GetWidth(), shadow_map->GetHeight(), shadow_map->GetFormat(), shadow_map->GetArraySize());
 					}
 
-					// Update constant buffer
-					const auto& transform = entity->GetTransform_PtrRaw();
-					transform->UpdateConstantBufferLight(m_rhi_device, light_view_projection, i);
-                    if (const shared_ptr<RHI_ConstantBuffer>& buffer = transform->GetConstantBufferLight(i))
-                    {
-                        if (buffer->GetResource())
-                        {
-                            m_cmd_list->SetConstantBuffer(1, Buffer_VertexShader, buffer);
-                        }
-                    }
-					m_cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+					const auto static_depth_stencil = cache.static_depth->GetResource_DepthStencil(i);
+					if (slice.signature_cached != signature_static)
+					{
+						m_cmd_list->ClearDepthStencil(static_depth_stencil, Clear_Depth, clear_depth);
+						m_cmd_list->SetRenderTarget(nullptr, static_depth_stencil);
+						draw_casters(casters_static, light_view_projection, i);
+						slice.signature_cached = signature_static;
+					}
+
+					m_cmd_list->CopyDepthStencil(static_depth_stencil, cascade_depth_stencil);
+					m_cmd_list->SetRenderTarget(nullptr, cascade_depth_stencil);
+					draw_casters(casters_dynamic, light_view_projection, i);
 				}
+
 				m_cmd_list->End(); // end of cascade
+
+				slice.signature_static	= signature_static;
+				slice.signature_dynamic	= signature_dynamic;
+				slice.view_projection	= light_view_projection;
+				slice.frame				= m_frame_num;
+				slice.valid				= true;
+				slices_rendered++;
 			}
 			m_cmd_list->End();
 			m_cmd_list->Submit();
 		}
+
+		// Forget lights that are gone
+		for (auto it = m_shadow_caches.begin(); it != m_shadow_caches.end();)
+		{
+			it = it->second.frame_seen != m_frame_num ? m_shadow_caches.erase(it) : next(it);
+		}
+
+		m_profiler->m_renderer_shadow_slices_rendered	= slices_rendered;
+		m_profiler->m_renderer_shadow_slices_skipped	= slices_skipped;
 	}
 
 	void Renderer::Pass_GBuffer()
@@ -211,7 +361,7 @@ namespace Spartan
         auto& tex_depth     = m_render_targets[RenderTarget_Gbuffer_Depth];
 
 		// If there is nothing to render, just clear
-		if (m_entities[Renderer_Object_Opaque].empty())
+		if (m_snapshot->renderables_opaque.empty())
 		{
 			m_cmd_list->ClearRenderTarget(tex_albedo->GetResource_RenderTarget(), clear_color);
 			m_cmd_list->ClearRenderTarget(tex_normal->GetResource_RenderTarget(), clear_color);
@@ -243,21 +393,16 @@ namespace Spartan
 		uint32_t currently_bound_shader		= 0;
 		uint32_t currently_bound_material	= 0;
 
-        auto draw_entity = [this, &currently_bound_geometry, &currently_bound_shader, &currently_bound_material](Entity* entity)
+        auto draw_renderable = [this, &currently_bound_geometry, &currently_bound_shader, &currently_bound_material](const SnapshotRenderable& renderable)
         {
-            // Get renderable
-            const auto& renderable = entity->GetRenderable_PtrRaw();
-            if (!renderable)
-                return;
-
             // Get material
-            const auto& material = renderable->GetMaterial();
+            const auto& material = renderable.material;
             if (!material)
                 return;
 
             // Get shader and geometry
-            const auto& shader = material->GetShader();
-            const auto& model = renderable->GeometryModel();
+            const auto& shader = material->shader;
+            const auto& model = renderable.model;
 
             // Validate shader
             if (!shader || shader->GetCompilationState() != Shader_Compiled)
@@ -267,12 +412,8 @@ namespace Spartan
             if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
                 return;
 
-            // Skip objects outside of the view frustum
-            if (!m_camera->IsInViewFrustrum(renderable))
-                return;
-
             // Set face culling (changes only if required)
-            m_cmd_list->SetRasterizerState(GetRasterizerState(material->GetCullMode(), Fill_Solid));
+            m_cmd_list->SetRasterizerState(GetRasterizerState(material->cull_mode, Fill_Solid));
 
             // Bind geometry
             if (currently_bound_geometry != model->GetId())
@@ -290,25 +431,28 @@ namespace Spartan
             }
 
             // Bind material
-            if (currently_bound_material != material->GetId())
+            if (currently_bound_material != material->id)
             {
-                // Bind material textures		
-                m_cmd_list->SetTextures(0, material->GetResources(), 8);
+                // Bind material textures, their resources are looked up here since streaming recreates them on this thread
+                for (uint32_t i = 0; i < static_cast<uint32_t>(material->textures.size()); i++)
+                {
+                    m_cmd_list->SetTexture(i, material->textures[i]);
+                }
 
                 // Bind material buffer
-                material->UpdateConstantBuffer();
-                m_cmd_list->SetConstantBuffer(1, Buffer_PixelShader, material->GetConstantBuffer());
+                material->material_component->UpdateConstantBuffer(*material);
+                m_cmd_list->SetConstantBuffer(1, Buffer_PixelShader, material->material_component->GetConstantBuffer());
 
-                currently_bound_material = material->GetId();
+                currently_bound_material = material->id;
             }
 
             // Bind object buffer
-            const auto& transform = entity->GetTransform_PtrRaw();
-            transform->UpdateConstantBuffer(m_rhi_device, m_view_projection);
+            const auto& transform = renderable.transform_component;
+            transform->UpdateConstantBuffer(m_rhi_device, renderable.transform, m_view_projection);
             m_cmd_list->SetConstantBuffer(2, Buffer_VertexShader, transform->GetConstantBuffer());
 
             // Render	
-            m_cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+            m_cmd_list->DrawIndexed(renderable.index_count, renderable.index_offset, renderable.vertex_offset);
             m_profiler->m_renderer_meshes_rendered++;
         };
 
@@ -326,17 +470,23 @@ namespace Spartan
         m_cmd_list->SetConstantBuffer(0, Buffer_Global, m_uber_buffer);
         m_cmd_list->SetSampler(0, m_sampler_anisotropic_wrap);
 
-        // Draw opaque
-		for (const auto& entity : m_entities[Renderer_Object_Opaque])
+        // Draw opaque (skipping objects outside of the view frustum)
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_snapshot->renderables_opaque.size()); i++)
 		{
-			draw_entity(entity);
+			if (IsVisible(m_visibility_opaque, i))
+			{
+				draw_renderable(m_snapshot->renderables_opaque[i]);
+			}
 		}
 
         // Draw transparent (transparency of the poor)
         m_cmd_list->SetBlendState(m_blend_color_add);
-        for (const auto& entity : m_entities[Renderer_Object_Transparent])
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_snapshot->renderables_transparent.size()); i++)
         {
-            draw_entity(entity);
+            if (IsVisible(m_visibility_transparent, i))
+            {
+                draw_renderable(m_snapshot->renderables_transparent[i]);
+            }
         }
 
 		m_cmd_list->End();
@@ -507,25 +657,45 @@ namespace Spartan
         // Update uber
         UpdateUberBuffer(tex_diffuse->GetWidth(), tex_diffuse->GetHeight());
 
-        auto draw_lights = [this, &shader_light_directional, &shader_light_point, &shader_light_spot](Renderer_Object_Type type)
-        {
-            if (m_entities[type].empty())
-                return;
+        const auto& shader_light_clustered  = m_shaders[Shader_LightClustered_P];
+        const bool shader_light_clustered_ready = shader_light_clustered->IsCompiled();
 
+        auto draw_lights = [this, &shader_light_directional, &shader_light_point, &shader_light_spot, shader_light_clustered_ready](LightType type)
+        {
             // Choose correct shader
             ShaderBuffered* shader = nullptr;
-            if (type == Renderer_Object_LightDirectional)   shader = static_cast<ShaderBuffered*>(shader_light_directional.get());
-            else if (type == Renderer_Object_LightPoint)    shader = static_cast<ShaderBuffered*>(shader_light_point.get());
-            else if (type == Renderer_Object_LightSpot)     shader = static_cast<ShaderBuffered*>(shader_light_spot.get());
+            if (type == LightType_Directional)  shader = static_cast<ShaderBuffered*>(shader_light_directional.get());
+            else if (type == LightType_Point)   shader = static_cast<ShaderBuffered*>(shader_light_point.get());
+            else if (type == LightType_Spot)    shader = static_cast<ShaderBuffered*>(shader_light_spot.get());
 
             // Draw
-            for (const auto& entity : m_entities[type])
+            for (const auto& light : m_snapshot->lights)
             {
-                Light* light = entity->GetComponent<Light>().get();
-
-                // Light can be null if it just got removed and our buffer doesn't update till the next frame
-                if (!light)
-                    break;
+                // Shadowless point and spot lights are shaded by the clustered draw below
+                if (light.type != type || (type != LightType_Directional && !light.cast_shadows && shader_light_clustered_ready))
+                    continue;
+
+                // Acquire the shadow map, point and spot lights sample their tiles of the shadow atlas
+                void* shadow_map = nullptr;
+                Vector4 shadow_atlas_rects[g_shadow_slice_count_max];
+                if (light.cast_shadows && type == LightType_Directional && light.shadow_map)
+                {
+                    shadow_map = light.shadow_map->GetResource_Texture();
+                }
+                else if (light.cast_shadows && type != LightType_Directional)
+                {
+                    const auto entry = m_shadow_atlas_entries.find(light.entity_id);
+                    if (entry != m_shadow_atlas_entries.end() && !entry->second.tiles.empty())
+                    {
+                        const float atlas_size = static_cast<float>(m_shadow_atlas.GetSize());
+                        for (uint32_t i = 0; i < static_cast<uint32_t>(entry->second.tiles.size()) && i < g_shadow_slice_count_max; i++)
+                        {
+                            const auto& tile        = entry->second.tiles[i];
+                            shadow_atlas_rects[i]   = Vector4(tile.x / atlas_size, tile.y / atlas_size, tile.size / atlas_size, tile.size / atlas_size);
+                        }
+                        shadow_map = m_shadow_atlas_texture->GetResource_Texture();
+                    }
+                }
 
                 // Pack textures
                 void* textures[] =
@@ -534,17 +704,26 @@ namespace Spartan
                     m_render_targets[RenderTarget_Gbuffer_Material]->GetResource_Texture(),
                     m_render_targets[RenderTarget_Gbuffer_Depth]->GetResource_Texture(),
                     m_render_targets[RenderTarget_Ssao]->GetResource_Texture(),
-                    light->GetCastShadows() ? (light->GetLightType() == LightType_Directional  ? light->GetShadowMap()->GetResource_Texture() : nullptr) : nullptr,
-                    light->GetCastShadows() ? (light->GetLightType() == LightType_Point        ? light->GetShadowMap()->GetResource_Texture() : nullptr) : nullptr,
-                    light->GetCastShadows() ? (light->GetLightType() == LightType_Spot         ? light->GetShadowMap()->GetResource_Texture() : nullptr) : nullptr
+                    type == LightType_Directional ? shadow_map : nullptr,
+                    type != LightType_Directional ? shadow_map : nullptr
                 };
 
+                // Shadows are sampled with the matrices their cached slices were rendered with, which can be a few frames old
+                Matrix view_projection[g_shadow_slice_count_max];
+                const auto cache = m_shadow_caches.find(light.entity_id);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(g_shadow_slice_count_max); i++)
+                {
+                    const bool cached = cache != m_shadow_caches.end() && i < cache->second.slices.size() && cache->second.slices[i].valid;
+                    view_projection[i] = cached ? cache->second.slices[i].view_projection : light.view[i] * light.projection[i];
+                }
+
                 // Update light buffer   
-                light->UpdateConstantBuffer(m_flags & Render_PostProcess_VolumetricLighting, m_flags & Render_PostProcess_SSCS);
-                const vector<void*> constant_buffers = { m_uber_buffer->GetResource(), light->GetConstantBuffer()->GetResource() };
+                Light* light_component = light.light_component.get();
+                light_component->UpdateConstantBuffer(light, view_projection, shadow_atlas_rects, shadow_map != nullptr, m_flags & Render_PostProcess_VolumetricLighting, m_flags & Render_PostProcess_SSCS);
+                const vector<void*> constant_buffers = { m_uber_buffer->GetResource(), light_component->GetConstantBuffer()->GetResource() };
 
                 m_cmd_list->SetConstantBuffers(0, Buffer_Global, constant_buffers);
-                m_cmd_list->SetTextures(0, textures, 7);
+                m_cmd_list->SetTextures(0, textures, 6);
                 m_cmd_list->SetShaderPixel(shader);
                 m_cmd_list->DrawIndexed(Rectangle::GetIndexCount(), 0, 0);
                 m_cmd_list->Submit();
@@ -552,9 +731,79 @@ namespace Spartan
         };
 
         // Draw lights
-        draw_lights(Renderer_Object_LightDirectional);
-        draw_lights(Renderer_Object_LightPoint);
-        draw_lights(Renderer_Object_LightSpot);
+        draw_lights(LightType_Directional);
+        draw_lights(LightType_Point);
+        draw_lights(LightType_Spot);
+
+        // Draw clustered lights, the light list and the clusters are uploaded once for all of them
+        if (shader_light_clustered_ready && !m_lights_clustered.empty())
+        {
+            const auto& grid    = m_light_clusters.GetGrid();
+            const auto& indices = m_light_clusters.GetIndices();
+
+            if (m_cluster_grid->Create<uint32_t>(static_cast<uint32_t>(grid.size())) && m_cluster_indices->Create<uint32_t>(static_cast<uint32_t>(indices.size())) && m_cluster_lights->Create<ClusterLight>(static_cast<uint32_t>(m_lights_clustered.size())))
+            {
+                if (auto buffer = static_cast<uint32_t*>(m_cluster_grid->Map()))
+                {
+                    memcpy(buffer, grid.data(), grid.size() * sizeof(uint32_t));
+                    m_cluster_grid->Unmap();
+                }
+
+                if (auto buffer = static_cast<uint32_t*>(m_cluster_indices->Map()))
+                {
+                    if (!indices.empty())
+                    {
+                        memcpy(buffer, indices.data(), indices.size() * sizeof(uint32_t));
+                    }
+                    m_cluster_indices->Unmap();
+                }
+
+                if (auto buffer = static_cast<ClusterLight*>(m_cluster_lights->Map()))
+                {
+                    for (const uint32_t index : m_lights_clustered)
+                    {
+                        const auto& light   = m_snapshot->lights[index];
+                        buffer->color       = Vector3(light.color.x, light.color.y, light.color.z);
+                        buffer->intensity   = light.intensity;
+                        buffer->position    = light.position;
+                        buffer->range       = light.range;
+                        buffer->direction   = light.direction;
+                        buffer->angle       = light.angle;
+                        buffer->is_spot     = light.type == LightType_Spot ? 1.0f : 0.0f;
+                        buffer++;
+                    }
+                    m_cluster_lights->Unmap();
+                }
+
+                if (auto buffer = static_cast<ClusterBuffer*>(m_cluster_buffer->Map()))
+                {
+                    buffer->cluster_count_x = m_light_clusters.GetTileCountX();
+                    buffer->cluster_count_y = m_light_clusters.GetTileCountY();
+                    buffer->cluster_count_z = m_light_clusters.GetSliceCount();
+                    buffer->light_count     = static_cast<uint32_t>(m_lights_clustered.size());
+                    buffer->slice_scale     = m_light_clusters.GetSliceScale();
+                    buffer->slice_bias      = m_light_clusters.GetSliceBias();
+                    m_cluster_buffer->Unmap();
+                }
+
+                void* textures[] =
+                {
+                    m_render_targets[RenderTarget_Gbuffer_Normal]->GetResource_Texture(),
+                    m_render_targets[RenderTarget_Gbuffer_Material]->GetResource_Texture(),
+                    m_render_targets[RenderTarget_Gbuffer_Depth]->GetResource_Texture(),
+                    m_render_targets[RenderTarget_Ssao]->GetResource_Texture(),
+                    m_cluster_grid->GetResource_Texture(),
+                    m_cluster_indices->GetResource_Texture(),
+                    m_cluster_lights->GetResource_Texture()
+                };
+                const vector<void*> constant_buffers = { m_uber_buffer->GetResource(), m_cluster_buffer->GetResource() };
+
+                m_cmd_list->SetConstantBuffers(0, Buffer_Global, constant_buffers);
+                m_cmd_list->SetTextures(0, textures, 7);
+                m_cmd_list->SetShaderPixel(shader_light_clustered);
+                m_cmd_list->DrawIndexed(Rectangle::GetIndexCount(), 0, 0);
+            }
+        }
 
         m_cmd_list->Submit();
 
@@ -1284,26 +1533,20 @@ namespace Spartan
 			if (draw_picking_ray)
 			{
 				const auto& ray = m_camera->GetPickingRay();
-				DrawLine(ray.GetStart(), ray.GetStart() + ray.GetDirection() * m_camera->GetFarPlane(), Vector4(0, 1, 0, 1));
+				DrawLine(ray.GetStart(), ray.GetStart() + ray.GetDirection() * m_snapshot->camera.far_plane, Vector4(0, 1, 0, 1));
 			}
 
 			// AABBs
 			if (draw_aabb)
 			{
-				for (const auto& entity : m_entities[Renderer_Object_Opaque])
+				for (const auto& renderable : m_snapshot->renderables_opaque)
 				{
-					if (auto renderable = entity->GetRenderable_PtrRaw())
-					{
-						DrawBox(renderable->GetAabb(), Vector4(0.41f, 0.86f, 1.0f, 1.0f));
-					}
+					DrawBox(renderable.aabb, Vector4(0.41f, 0.86f, 1.0f, 1.0f));
 				}
 
-				for (const auto& entity : m_entities[Renderer_Object_Transparent])
+				for (const auto& renderable : m_snapshot->renderables_transparent)
 				{
-					if (auto renderable = entity->GetRenderable_PtrRaw())
-					{
-						DrawBox(renderable->GetAabb(), Vector4(0.41f, 0.86f, 1.0f, 1.0f));
-					}
+					DrawBox(renderable.aabb, Vector4(0.41f, 0.86f, 1.0f, 1.0f));
 				}
 			}
 		}
@@ -1321,7 +1564,7 @@ namespace Spartan
 		m_cmd_list->SetSampler(0, m_sampler_point_clamp);
 
         // unjittered matrix to avoid TAA jitter due to lack of motion vectors (line rendering is anti-aliased by m_rasterizer_cull_back_wireframe, decently)
-        const auto view_projection_unjittered = m_camera->GetViewMatrix() * m_camera->GetProjectionMatrix();
+        const auto view_projection_unjittered = m_snapshot->camera.view * m_snapshot->camera.projection;
 
 		// Draw lines that require depth
 		m_cmd_list->SetDepthStencilState(m_depth_stencil_enabled);
@@ -1420,22 +1663,17 @@ namespace Spartan
 		m_cmd_list->SetViewport(tex_out->GetViewport());	
 		m_cmd_list->SetRenderTarget(tex_out);
 
-		auto& lights = m_entities[Renderer_Object_Light];
+		const auto& lights = m_snapshot->lights;
 		if (render_lights && !lights.empty())
 		{
 			m_cmd_list->Begin("Pass_Gizmos_Lights");
 
-			for (const auto& entity : lights)
+			for (const auto& light : lights)
 			{
-                shared_ptr<Light>& light = entity->GetComponent<Light>();
-                // Light can be null if it just got removed and our buffer doesn't update till the next frame
-                if (!light)
-                    break;
-
-				auto position_light_world		= entity->GetTransform_PtrRaw()->GetPosition();
-				auto position_camera_world		= m_camera->GetTransform()->GetPosition();
+				auto position_light_world		= light.position;
+				auto position_camera_world		= m_snapshot->camera.position;
 				auto direction_camera_to_light	= (position_light_world - position_camera_world).Normalized();
-				auto v_dot_l					= Vector3::Dot(m_camera->GetTransform()->GetForward(), direction_camera_to_light);
+				auto v_dot_l					= Vector3::Dot(m_snapshot->camera.forward, direction_camera_to_light);
 
 				// Don't bother drawing if out of view
 				if (v_dot_l <= 0.5f)
@@ -1449,7 +1687,7 @@ namespace Spartan
 
 				// Choose texture based on light type
 				shared_ptr<RHI_Texture> light_tex = nullptr;
-				auto type = light->GetLightType();
+				auto type = light.type;
 				if (type == LightType_Directional)	light_tex = m_gizmo_tex_light_directional;
 				else if (type == LightType_Point)	light_tex = m_gizmo_tex_light_point;
 				else if (type == LightType_Spot)	light_tex = m_gizmo_tex_light_spot;
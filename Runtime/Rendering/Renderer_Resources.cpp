@@ -39,6 +39,7 @@ namespace Spartan
     {
         m_depth_stencil_enabled     = make_shared<RHI_DepthStencilState>(m_rhi_device, true,    GetComparisonFunction());
         m_depth_stencil_disabled    = make_shared<RHI_DepthStencilState>(m_rhi_device, false,   GetComparisonFunction());
+        m_depth_stencil_overwrite   = make_shared<RHI_DepthStencilState>(m_rhi_device, true,    Comparison_Always);
     }
 
     void Renderer::CreateRasterizerStates()
@@ -181,6 +182,11 @@ namespace Spartan
         shader_light_spot->CompileAsync(m_context, Shader_Pixel, dir_shaders + "Light.hlsl");
         m_shaders[Shader_LightSpot_P] = shader_light_spot;
 
+        // Light - Clustered
+        auto shader_light_clustered = make_shared<RHI_Shader>(m_rhi_device);
+        shader_light_clustered->CompileAsync(m_context, Shader_Pixel, dir_shaders + "LightClustered.hlsl");
+        m_shaders[Shader_LightClustered_P] = shader_light_clustered;
+
         // Composition
         auto shader_composition = make_shared<ShaderBuffered>(m_rhi_device);
         shader_composition->CompileAsync(m_context, Shader_Pixel, dir_shaders + "Composition.hlsl");
@@ -0,0 +1,187 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===================
+#include "ShadowAtlas.h"
+#include "../../Math/MathHelper.h"
+#include "../../Logging/Log.h"
+//==============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+	// Nodes of a level are in morton order, so the x and y of a node are its even and odd bits
+	static uint32_t compact_bits(uint32_t value)
+	{
+		value &= 0x55555555;
+		value = (value | (value >> 1)) & 0x33333333;
+		value = (value | (value >> 2)) & 0x0F0F0F0F;
+		value = (value | (value >> 4)) & 0x00FF00FF;
+		value = (value | (value >> 8)) & 0x0000FFFF;
+		return value;
+	}
+
+	ShadowAtlas::ShadowAtlas(const uint32_t size, const uint32_t tile_size_min)
+	{
+		// Both have to be powers of two, round down
+		m_size = 1;
+		while (m_size * 2 <= size)
+		{
+			m_size *= 2;
+		}
+
+		m_level_count = 1;
+		while ((m_size >> m_level_count) >= Max(tile_size_min, 1u) && m_level_count < 10) // 10 levels keep the node array under half a megabyte
+		{
+			m_level_count++;
+		}
+
+		m_nodes.resize(GetLevelOffset(m_level_count));
+		Reset();
+	}
+
+	void ShadowAtlas::Reset()
+	{
+		fill(m_nodes.begin(), m_nodes.end(), Node_Absent);
+		m_nodes[0]		= Node_Free;
+		m_tile_count	= 0;
+		m_area_used		= 0;
+	}
+
+	ShadowAtlas::Tile ShadowAtlas::Allocate(const uint32_t size)
+	{
+		const uint32_t level_target = GetLevelForSize(size);
+
+		// Find the smallest free node that fits, from the requested level up to the root
+		uint32_t node	= 0;
+		uint32_t level	= level_target + 1;
+		bool found		= false;
+		while (!found && level-- > 0)
+		{
+			const uint32_t offset	= GetLevelOffset(level);
+			const uint32_t count	= 1u << (2 * level);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (m_nodes[offset + i] == Node_Free)
+				{
+					node	= offset + i;
+					found	= true;
+					break;
+				}
+			}
+		}
+
+		if (!found)
+			return Tile();
+
+		// Split it down to the requested level, always continuing with the first child
+		while (level < level_target)
+		{
+			const uint32_t index	= node - GetLevelOffset(level);
+			const uint32_t child	= GetLevelOffset(level + 1) + index * 4;
+			m_nodes[node]			= Node_Split;
+			m_nodes[child + 0]		= Node_Free;
+			m_nodes[child + 1]		= Node_Free;
+			m_nodes[child + 2]		= Node_Free;
+			m_nodes[child + 3]		= Node_Free;
+			node					= child;
+			level++;
+		}
+
+		m_nodes[node] = Node_Used;
+
+		const uint32_t index = node - GetLevelOffset(level);
+		Tile tile;
+		tile.size	= m_size >> level;
+		tile.x		= compact_bits(index) * tile.size;
+		tile.y		= compact_bits(index >> 1) * tile.size;
+		tile.node	= node;
+
+		m_tile_count++;
+		m_area_used += static_cast<uint64_t>(tile.size) * tile.size;
+
+		return tile;
+	}
+
+	void ShadowAtlas::Free(Tile& tile)
+	{
+		if (!tile.IsValid())
+			return;
+
+		if (tile.node >= m_nodes.size() || m_nodes[tile.node] != Node_Used)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		m_nodes[tile.node] = Node_Free;
+		m_tile_count--;
+		m_area_used -= static_cast<uint64_t>(tile.size) * tile.size;
+
+		// Merge with the siblings for as long as they are all free
+		uint32_t node	= tile.node;
+		uint32_t level	= GetLevel(node);
+		while (level > 0)
+		{
+			const uint32_t index	= node - GetLevelOffset(level);
+			const uint32_t first	= GetLevelOffset(level) + (index & ~3u);
+			if (m_nodes[first] != Node_Free || m_nodes[first + 1] != Node_Free || m_nodes[first + 2] != Node_Free || m_nodes[first + 3] != Node_Free)
+				break;
+
+			m_nodes[first] = m_nodes[first + 1] = m_nodes[first + 2] = m_nodes[first + 3] = Node_Absent;
+			level--;
+			node			= GetLevelOffset(level) + index / 4;
+			m_nodes[node]	= Node_Free;
+		}
+
+		tile = Tile();
+	}
+
+	uint32_t ShadowAtlas::GetTileSize(const uint32_t size) const
+	{
+		return m_size >> GetLevelForSize(size);
+	}
+
+	uint32_t ShadowAtlas::GetLevel(const uint32_t node) const
+	{
+		uint32_t level = 0;
+		while (level + 1 < m_level_count && node >= GetLevelOffset(level + 1))
+		{
+			level++;
+		}
+		return level;
+	}
+
+	uint32_t ShadowAtlas::GetLevelForSize(const uint32_t size) const
+	{
+		// The deepest level that still fits the size
+		uint32_t level = 0;
+		while (level + 1 < m_level_count && (m_size >> (level + 1)) >= size)
+		{
+			level++;
+		}
+		return level;
+	}
+}
@@ -0,0 +1,87 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <vector>
+#include "../../Core/EngineDefs.h"
+//===============================
+
+namespace Spartan
+{
+	// Hands out square, power of two tiles of a shared shadow map. It's a quadtree: every node is either free,
+	// split into four children, or in use, and freeing the last used child of a node merges it back. An allocation
+	// takes the smallest free node that fits and splits it down, which keeps the big nodes whole for as long as possible.
+	// It only does the bookkeeping, the texture is owned by the renderer.
+	class SPARTAN_CLASS ShadowAtlas
+	{
+	public:
+		struct Tile
+		{
+			uint32_t x		= 0;	// texels
+			uint32_t y		= 0;	// texels
+			uint32_t size	= 0;	// texels, 0 means no tile
+			uint32_t node	= 0;
+
+			bool IsValid() const { return size != 0; }
+		};
+
+		ShadowAtlas(uint32_t size = 4096, uint32_t tile_size_min = 64);
+		~ShadowAtlas() = default;
+
+		// Frees every tile
+		void Reset();
+
+		// Returns a tile of at least the given size (rounded up to a power of two), or an invalid tile if nothing fits
+		Tile Allocate(uint32_t size);
+
+		// Returns a tile to the atlas, merging it with its free siblings
+		void Free(Tile& tile);
+
+		// The tile size an allocation of the given size ends up with
+		uint32_t GetTileSize(uint32_t size) const;
+
+		uint32_t GetSize() const		{ return m_size; }
+		uint32_t GetTileSizeMin() const	{ return m_size >> (m_level_count - 1); }
+		uint64_t GetAreaUsed() const	{ return m_area_used; }
+		uint32_t GetTileCount() const	{ return m_tile_count; }
+
+	private:
+		enum Node_State : uint8_t
+		{
+			Node_Absent,	// part of a free or used ancestor
+			Node_Free,
+			Node_Split,
+			Node_Used
+		};
+
+		static uint32_t GetLevelOffset(uint32_t level)	{ return ((1u << (2 * level)) - 1) / 3; }
+		uint32_t GetLevel(uint32_t node) const;
+		uint32_t GetLevelForSize(uint32_t size) const;
+
+		uint32_t m_size			= 0;
+		uint32_t m_level_count	= 0;
+		uint32_t m_tile_count	= 0;
+		uint64_t m_area_used	= 0;
+		std::vector<Node_State> m_nodes; // level by level, the children of node i of a level are 4i to 4i + 3 of the next
+	};
+}
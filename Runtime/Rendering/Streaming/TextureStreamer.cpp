@@ -0,0 +1,185 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===========================
+#include <algorithm>
+#include "TextureStreamer.h"
+#include "../../RHI/RHI_Texture.h"
+#include "../../Threading/Threading.h"
+#include "../../Math/MathHelper.h"
+//======================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+	void TextureStreamer::Request(const shared_ptr<RHI_Texture>& texture, const float pixels, const uint64_t frame)
+	{
+		if (!texture || !texture->IsStreamed())
+			return;
+
+		// The coarsest mip which still has a texel per pixel, but never coarser than what the texture always has
+		const auto size		= Max(texture->GetWidth(), texture->GetHeight());
+		const auto mip_max	= texture->GetMipInitial();
+		uint32_t mip		= 0;
+		while (mip < mip_max && static_cast<float>(size >> (mip + 1)) >= pixels)
+		{
+			mip++;
+		}
+
+		// The biggest surface using the texture decides
+		auto& entry = m_entries[texture.get()];
+		if (entry.frame_seen != frame)
+		{
+			entry.texture		= texture;
+			entry.mip_wanted	= mip;
+			entry.pixels		= pixels;
+			entry.frame_seen	= frame;
+		}
+		else
+		{
+			entry.mip_wanted	= Min(entry.mip_wanted, mip);
+			entry.pixels		= Max(entry.pixels, pixels);
+		}
+	}
+
+	void TextureStreamer::Update(Threading* threading, const uint64_t frame)
+	{
+		// Upload what has been read, a few per frame since every upload creates the texture again
+		uint32_t uploads = 0;
+		for (auto it = m_reads.begin(); it != m_reads.end();)
+		{
+			const auto& read = *it;
+			if (!read->done || uploads >= m_uploads_max)
+			{
+				++it;
+				continue;
+			}
+
+			if (read->succeeded)
+			{
+				read->texture->StreamUpload(read->mip, read->mips);
+				uploads++;
+			}
+
+			const auto it_entry = m_entries.find(read->texture.get());
+			if (it_entry != m_entries.end())
+			{
+				it_entry->second.reading = false;
+			}
+
+			it = m_reads.erase(it);
+		}
+
+		// Account, and work out which textures should get finer or coarser mips
+		struct Candidate
+		{
+			Entry* entry;
+			shared_ptr<RHI_Texture> texture;
+			uint32_t mip;
+			bool unused;
+		};
+		vector<Candidate> finer;
+		vector<Candidate> coarser;
+		m_memory_usage = 0;
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			auto& entry			= it->second;
+			const auto texture	= entry.texture.lock();
+			const auto unused	= frame - entry.frame_seen > m_frames_unused;
+
+			// Gone, or back where it started for good
+			if (!texture || (unused && !entry.reading && texture->GetMipResident() == texture->GetMipInitial()))
+			{
+				it = m_entries.erase(it);
+				continue;
+			}
+
+			const auto resident	= texture->GetMipResident();
+			const auto target	= unused ? texture->GetMipInitial() : entry.mip_wanted;
+			m_memory_usage		+= texture->GetMipChainSize(resident);
+
+			if (!entry.reading && target < resident)
+			{
+				finer.push_back({ &entry, texture, target, unused });
+			}
+			else if (!entry.reading && target > resident)
+			{
+				coarser.push_back({ &entry, texture, target, unused });
+			}
+
+			++it;
+		}
+
+		const auto read = [this, threading](const Candidate& candidate)
+		{
+			auto job		= make_shared<Read>();
+			job->texture	= candidate.texture;
+			job->mip		= candidate.mip;
+			candidate.entry->reading = true;
+			m_reads.emplace_back(job);
+
+			threading->AddTask([job]()
+			{
+				job->succeeded	= job->texture->StreamRead(job->mip, &job->mips);
+				job->done		= true;
+			});
+		};
+
+		// Drop mips of the textures which aren't used anymore, and of the smallest surfaces while over budget
+		auto memory = m_memory_usage;
+		sort(coarser.begin(), coarser.end(), [](const Candidate& a, const Candidate& b) { return a.unused != b.unused ? a.unused : a.entry->pixels < b.entry->pixels; });
+		for (const auto& candidate : coarser)
+		{
+			if (m_reads.size() >= m_reads_max)
+				break;
+
+			if (!candidate.unused && memory <= m_memory_budget)
+				break;
+
+			memory -= candidate.texture->GetMipChainSize(candidate.texture->GetMipResident()) - candidate.texture->GetMipChainSize(candidate.mip);
+			read(candidate);
+		}
+
+		// Bring in finer mips, biggest surfaces first, as fine as the budget allows
+		sort(finer.begin(), finer.end(), [](const Candidate& a, const Candidate& b) { return a.entry->pixels > b.entry->pixels; });
+		for (auto& candidate : finer)
+		{
+			if (m_reads.size() >= m_reads_max)
+				break;
+
+			const auto resident = candidate.texture->GetMipChainSize(candidate.texture->GetMipResident());
+			while (candidate.mip < candidate.texture->GetMipResident() && memory + candidate.texture->GetMipChainSize(candidate.mip) - resident > m_memory_budget)
+			{
+				candidate.mip++;
+			}
+
+			if (candidate.mip == candidate.texture->GetMipResident())
+				continue;
+
+			memory += candidate.texture->GetMipChainSize(candidate.mip) - resident;
+			read(candidate);
+		}
+	}
+}
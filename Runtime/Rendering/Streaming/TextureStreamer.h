@@ -0,0 +1,86 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include "../../Core/EngineDefs.h"
+//===============================
+
+namespace Spartan
+{
+	class Threading;
+	class RHI_Texture;
+
+	// Streams the mips of streamed textures (see RHI_Texture) in and out, by how big the surfaces using them are on screen.
+	// Every frame the renderer asks for the mip that each visible surface needs. The finer mips are read from the texture
+	// files by the worker threads, and they are uploaded in Update(), on the rendering thread. The biggest surfaces are
+	// served first, within the memory budget. Textures which haven't been asked for in a while drop back to their initial mips.
+	class SPARTAN_CLASS TextureStreamer
+	{
+	public:
+		TextureStreamer() = default;
+		~TextureStreamer() = default;
+
+		// Asks for the mip that a surface which is this many pixels across on screen needs
+		void Request(const std::shared_ptr<RHI_Texture>& texture, float pixels, uint64_t frame);
+
+		// Uploads the mips which have been read, then starts reading the most wanted ones
+		void Update(Threading* threading, uint64_t frame);
+
+		void SetMemoryBudget(const uint64_t bytes)	{ m_memory_budget = bytes; }
+		auto GetMemoryBudget() const				{ return m_memory_budget; }
+		auto GetMemoryUsage() const					{ return m_memory_usage; }
+		auto GetReadsInFlight() const				{ return static_cast<uint32_t>(m_reads.size()); }
+
+	private:
+		// A read of a texture's mips, shared with the worker that does it
+		struct Read
+		{
+			std::shared_ptr<RHI_Texture> texture;
+			uint32_t mip = 0;
+			std::vector<std::vector<std::byte>> mips;
+			std::atomic<bool> done	= false;
+			bool succeeded			= false;
+		};
+
+		struct Entry
+		{
+			std::weak_ptr<RHI_Texture> texture;
+			uint32_t mip_wanted	= 0;
+			float pixels		= 0.0f;	// the biggest surface using it
+			uint64_t frame_seen	= 0;
+			bool reading		= false;
+		};
+
+		std::unordered_map<const RHI_Texture*, Entry> m_entries;
+		std::vector<std::shared_ptr<Read>> m_reads;
+		uint64_t m_memory_budget		= 512 * 1024 * 1024;
+		uint64_t m_memory_usage			= 0;
+		uint32_t m_reads_max			= 4;	// in flight
+		uint32_t m_uploads_max			= 4;	// per frame
+		uint32_t m_frames_unused		= 300;	// until a texture drops back to its initial mips
+	};
+}
@@ -21,6 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ====================================
 #include "IResource.h"
+#include "ResourceCache.h"
 #include "../Audio/AudioClip.h"
 #include "../Rendering/Model.h"
 #include "../Rendering/Font/Font.h"
@@ -43,6 +44,28 @@ IResource::IResource(Context* context, const Resource_Type type) : Spartan_Objec
 	m_load_state	= LoadState_Idle;
 }
 
+void IResource::SetResourceName(const string& name)
+{
+	if (m_cache)
+	{
+		m_cache->Rename(this, name, m_resource_file_path);
+		return;
+	}
+
+	m_resource_name = name;
+}
+
+void IResource::SetResourceFilePath(const string& file_path)
+{
+	if (m_cache)
+	{
+		m_cache->Rename(this, m_resource_name, file_path);
+		return;
+	}
+
+	m_resource_file_path = file_path;
+}
+
 template <typename T>
 inline constexpr Resource_Type IResource::TypeToEnum() { return Resource_Unknown; }
 
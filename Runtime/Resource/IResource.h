@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========================
 #include <memory>
+#include <atomic>
 #include "../Core/Context.h"
 #include "../Core/Spartan_Object.h"
 #include "../FileSystem/FileSystem.h"
@@ -31,6 +32,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+	class ResourceCache;
+
 	enum Resource_Type
 	{
 		Resource_Unknown,
@@ -65,19 +68,29 @@ namespace Spartan
 		Resource_Type GetResourceType() const					{ return m_resource_type; }
 		const char* GetResourceTypeCstr() const					{ return typeid(*this).name(); }
 		const std::string& GetResourceName() const				{ return m_resource_name; }
-		void SetResourceName(const std::string& name)			{ m_resource_name = name; }
+		void SetResourceName(const std::string& name);
 		const std::string& GetResourceFilePath() const			{ return m_resource_file_path; }
-		void SetResourceFilePath(const std::string& file_path)  { m_resource_file_path = file_path; }
+		void SetResourceFilePath(const std::string& file_path);
 		bool HasFilePath() const								{ return !m_resource_file_path.empty(); }
 		std::string GetResourceFileName() const					{ return FileSystem::GetFileNameNoExtensionFromFilePath(m_resource_file_path); }
 		std::string GetResourceDirectory() const				{ return FileSystem::GetDirectoryFromFilePath(m_resource_file_path); }
-		virtual uint32_t GetMemoryUsage()						{ return static_cast<uint32_t>(sizeof(*this)); }
 		LoadState GetLoadState() const							{ return m_load_state; }
 		//======================================================================================================================================
 
+		//= MEMORY ==============================================================================
+		// Bytes held in system memory and in video memory
+		virtual uint64_t GetMemoryUsageCpu()					{ return sizeof(*this); }
+		virtual uint64_t GetMemoryUsageGpu()					{ return 0; }
+		uint64_t GetMemoryUsage()								{ return GetMemoryUsageCpu() + GetMemoryUsageGpu(); }
+		//=======================================================================================
+
 		//= IO =================================================================
 		virtual bool SaveToFile(const std::string& file_path)	{ return true; }
 		virtual bool LoadFromFile(const std::string& file_path)	{ return true; }
+
+		// Whether bulk data (e.g. mips, vertices) gets compressed when saved to an engine file
+		bool GetFileCompression() const							{ return m_file_compression; }
+		void SetFileCompression(const bool compression)			{ m_file_compression = compression; }
 		//======================================================================
 
 		//= TYPE ===================================
@@ -89,9 +102,17 @@ namespace Spartan
 		Resource_Type m_resource_type	= Resource_Unknown;
 		LoadState m_load_state			= LoadState_Idle;
 		Context* m_context				= nullptr;
+		bool m_file_compression			= true;
 
 	private:
+		friend class ResourceCache;
+
 		std::string m_resource_name;
 		std::string m_resource_file_path;
+
+		// The cache this resource is in, it's indexed by name and path so it has to know when they change
+		ResourceCache* m_cache = nullptr;
+		// Frame of the cache that the resource was last looked up in, for least recently used eviction
+		std::atomic<uint64_t> m_last_used = 0;
 	};
 }
@@ -26,6 +26,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Entity.h"
 #include "../IO/FileStream.h"
 #include "../Core/EventSystem.h"
+#include "../Threading/Threading.h"
+#include "../Profiling/Profiler.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_TextureCube.h"
 //=================================
@@ -37,6 +39,56 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	static mutex g_save_mutex; // Resources are saved in the background, one world save at a time
+
+	// Paths are compared after unifying the separators (and the case, on Windows), so "Data//a.png" finds "Data\\A.png"
+	static string NormalizePath(const string& path)
+	{
+		string normalized;
+		normalized.reserve(path.size());
+
+		for (char c : path)
+		{
+			if (c == '\\')
+			{
+				c = '/';
+			}
+#ifdef _WIN32
+			else if (c >= 'A' && c <= 'Z')
+			{
+				c = static_cast<char>(c - 'A' + 'a');
+			}
+#endif
+			// Repeated separators are one separator
+			if (c == '/' && !normalized.empty() && normalized.back() == '/')
+				continue;
+
+			normalized += c;
+		}
+
+		return normalized;
+	}
+
+	shared_ptr<IResource> ResourceLoad::GetResource()
+	{
+		lock_guard<mutex> lock(m_mutex);
+		return m_resource;
+	}
+
+	void ResourceLoad::OnComplete(Callback&& callback, const Load_Thread thread /*= Load_Thread_Main*/)
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (!IsDone())
+			{
+				m_callbacks.emplace_back(move(callback), thread);
+				return;
+			}
+		}
+
+		callback(m_state == LoadState_Completed ? GetResource() : nullptr);
+	}
+
 	ResourceCache::ResourceCache(Context* context) : ISubsystem(context)
 	{
 		string data_dir = GetDataDirectory();
@@ -54,7 +106,7 @@ namespace Spartan
 		SetProjectDirectory("Project//");
 
 		// Subscribe to events
-		SUBSCRIBE_TO_EVENT(Event_World_Save,	EVENT_HANDLER(SaveResourcesToFiles));
+		SUBSCRIBE_TO_EVENT(Event_World_Save,	[this](const Variant& var) { SaveResourcesToFiles(var.Get<bool>()); });
 		SUBSCRIBE_TO_EVENT(Event_World_Load,	EVENT_HANDLER(LoadResourcesFromFiles));
 		SUBSCRIBE_TO_EVENT(Event_World_Unload,	EVENT_HANDLER(Clear));
 	}
@@ -75,6 +127,43 @@ namespace Spartan
 		return true;
 	}
 
+	void ResourceCache::Tick(float delta_time)
+	{
+		m_frame++;
+
+		// The accounting walks over all the resources, so the budgets are enforced (and the stats reported) every now and then
+		m_time_since_memory_budget_sec += delta_time;
+		if (m_time_since_memory_budget_sec >= m_memory_budget_interval_sec)
+		{
+			m_time_since_memory_budget_sec = 0.0f;
+			EnforceMemoryBudgets();
+
+			if (const auto profiler = m_context->GetSubsystem<Profiler>())
+			{
+				profiler->m_resource_cache_hits			= m_hits;
+				profiler->m_resource_cache_misses		= m_misses;
+				profiler->m_resource_cache_evictions	= m_evictions;
+				profiler->m_resource_cache_memory_cpu	= GetMemoryUsageCpu();
+				profiler->m_resource_cache_memory_gpu	= GetMemoryUsageGpu();
+			}
+		}
+
+		// Run the completion callbacks which asked for the main thread
+		vector<pair<ResourceLoad::Callback, shared_ptr<IResource>>> callbacks;
+		{
+			lock_guard<mutex> lock(m_loads_mutex);
+			if (m_loads_callbacks.empty())
+				return;
+
+			callbacks.swap(m_loads_callbacks);
+		}
+
+		for (const auto& callback : callbacks)
+		{
+			callback.first(callback.second);
+		}
+	}
+
 	bool ResourceCache::IsCached(const string& resource_name, const Resource_Type resource_type /*= Resource_Unknown*/)
 	{
 		if (resource_name.empty())
@@ -83,117 +172,528 @@ namespace Spartan
 			return false;
 		}
 
-		for (const auto& resource : m_resource_groups[resource_type])
+		return GetByName(resource_name, resource_type) != nullptr;
+	}
+
+	shared_ptr<IResource> ResourceCache::GetByName(const string& name, const Resource_Type type)
+	{
+		shared_lock<shared_mutex> lock(m_mutex);
+
+		const auto it_group = m_resource_groups.find(type);
+		if (it_group == m_resource_groups.end())
 		{
-			if (resource_name == resource->GetResourceName())
-				return true;
+			m_misses++;
+			return nullptr;
 		}
 
-		return false;
+		const auto it = it_group->second.by_name.find(name);
+		if (it == it_group->second.by_name.end())
+		{
+			m_misses++;
+			return nullptr;
+		}
+
+		m_hits++;
+		it->second->m_last_used = m_frame.load();
+		return it->second;
 	}
 
-	shared_ptr<IResource>& ResourceCache::GetByName(const string& name, const Resource_Type type)
+	shared_ptr<IResource> ResourceCache::GetByPath(const string& path, const Resource_Type type)
 	{
-		for (auto& resource : m_resource_groups[type])
+		const auto path_normalized = NormalizePath(path);
+
+		shared_lock<shared_mutex> lock(m_mutex);
+
+		const auto it_group = m_resource_groups.find(type);
+		if (it_group == m_resource_groups.end())
+		{
+			m_misses++;
+			return nullptr;
+		}
+
+		const auto it = it_group->second.by_path.find(path_normalized);
+		if (it == it_group->second.by_path.end())
 		{
-			if (name == resource->GetResourceName())
-				return resource;
+			m_misses++;
+			return nullptr;
 		}
 
-		return m_empty_resource;
+		m_hits++;
+		it->second->m_last_used = m_frame.load();
+		return it->second;
 	}
 
 	vector<shared_ptr<IResource>> ResourceCache::GetByType(const Resource_Type type /*= Resource_Unknown*/)
 	{
+		shared_lock<shared_mutex> lock(m_mutex);
+
 		vector<shared_ptr<IResource>> resources;
 
 		if (type == Resource_Unknown)
 		{
 			for (const auto& resource_group : m_resource_groups)
 			{
-				resources.insert(resources.end(), resource_group.second.begin(), resource_group.second.end());
+				resources.insert(resources.end(), resource_group.second.resources.begin(), resource_group.second.resources.end());
 			}
 		}
 		else
 		{
-			resources = m_resource_groups[type];
+			const auto it_group = m_resource_groups.find(type);
+			if (it_group != m_resource_groups.end())
+			{
+				resources = it_group->second.resources;
+			}
 		}
 
 		return resources;
 	}
 
-	uint32_t ResourceCache::GetMemoryUsage(Resource_Type type /*= Resource_Unknown*/)
+	bool ResourceCache::CacheResource(shared_ptr<IResource>& resource)
+	{
+		unique_lock<shared_mutex> lock(m_mutex);
+
+		// The check and the insertion happen under the same lock, so two threads can't cache the same resource
+		auto& group = m_resource_groups[resource->GetResourceType()];
+		const auto it = group.by_name.find(resource->GetResourceName());
+		if (it != group.by_name.end())
+		{
+			resource = it->second;
+			return false;
+		}
+
+		resource->m_cache		= this;
+		resource->m_last_used	= m_frame.load();
+		group.resources.emplace_back(resource);
+		IndexAdd(group, resource);
+		return true;
+	}
+
+	void ResourceCache::Rename(IResource* resource, const string& name, const string& file_path)
 	{
-		uint32_t size = 0;
+		unique_lock<shared_mutex> lock(m_mutex);
+
+		// The name index holds the owning pointer, which is needed to index the resource again
+		auto& group = m_resource_groups[resource->GetResourceType()];
+		const auto it = group.by_name.find(resource->GetResourceName());
+		const auto cached = (it != group.by_name.end() && it->second.get() == resource) ? it->second : nullptr;
+
+		IndexRemove(group, resource);
+		resource->m_resource_name		= name;
+		resource->m_resource_file_path	= file_path;
 
-		if (type = Resource_Unknown)
+		if (cached)
 		{
-			for (const auto& group : m_resource_groups)
+			IndexAdd(group, cached);
+		}
+	}
+
+	void ResourceCache::IndexAdd(ResourceGroup& group, const shared_ptr<IResource>& resource)
+	{
+		// Names are unique per type (caching enforces it), paths are expected to be but the first one wins
+		group.by_name.emplace(resource->GetResourceName(), resource);
+		if (resource->HasFilePath())
+		{
+			group.by_path.emplace(NormalizePath(resource->GetResourceFilePath()), resource);
+		}
+	}
+
+	void ResourceCache::IndexRemove(ResourceGroup& group, const IResource* resource)
+	{
+		const auto it_name = group.by_name.find(resource->GetResourceName());
+		if (it_name != group.by_name.end() && it_name->second.get() == resource)
+		{
+			group.by_name.erase(it_name);
+		}
+
+		if (resource->HasFilePath())
+		{
+			const auto it_path = group.by_path.find(NormalizePath(resource->GetResourceFilePath()));
+			if (it_path != group.by_path.end() && it_path->second.get() == resource)
+			{
+				group.by_path.erase(it_path);
+			}
+		}
+	}
+
+	shared_ptr<ResourceLoad> ResourceCache::LoadAsync(const Resource_Type type, const string& file_path, const int priority, const function<shared_ptr<IResource>()>& create)
+	{
+		const auto path_normalized = NormalizePath(file_path);
+		shared_ptr<ResourceLoad> load;
+		{
+			lock_guard<mutex> lock(m_loads_mutex);
+
+			// Already loaded, the load is done before it starts
+			if (auto cached = GetByName(FileSystem::GetFileNameNoExtensionFromFilePath(file_path), type))
 			{
-				for (const auto& resource : group.second)
+				load				= make_shared<ResourceLoad>();
+				load->m_type		= type;
+				load->m_path		= path_normalized;
+				load->m_resource	= cached;
+				load->m_state		= LoadState_Completed;
+				return load;
+			}
+
+			// Already being loaded, join it (and bump its priority if it's still waiting)
+			auto& loads		= m_loads[type];
+			const auto it	= loads.find(path_normalized);
+			if (it != loads.end())
+			{
+				load = it->second.lock();
+			}
+
+			if (load)
+			{
+				if (load->m_started || priority <= load->m_priority)
+					return load;
+
+				load->m_priority = priority;
+			}
+			else
+			{
+				load								= make_shared<ResourceLoad>();
+				load->m_type						= type;
+				load->m_path						= path_normalized;
+				load->m_priority					= priority;
+				load->m_resource					= create();
+				load->m_resource->m_load_state		= LoadState_Started;
+				loads[path_normalized]				= load;
+			}
+
+			LoadQueue(load);
+		}
+
+		// Every queued entry gets a task, which starts the most important load waiting at the time it runs
+		m_context->GetSubsystem<Threading>()->AddTask([this]() { LoadNext(); });
+
+		return load;
+	}
+
+	shared_ptr<ResourceLoad> ResourceCache::LoadJoin(const Resource_Type type, const string& file_path)
+	{
+		shared_ptr<ResourceLoad> load;
+		auto run = false;
+		{
+			lock_guard<mutex> lock(m_loads_mutex);
+
+			const auto it_type = m_loads.find(type);
+			if (it_type == m_loads.end())
+				return nullptr;
+
+			const auto it = it_type->second.find(NormalizePath(file_path));
+			if (it == it_type->second.end() || !(load = it->second.lock()))
+				return nullptr;
+
+			// If it hasn't started yet, the caller does the loading and the queued entry gets skipped
+			run				= !load->m_started;
+			load->m_started	= true;
+		}
+
+		if (run)
+		{
+			LoadRun(load);
+		}
+		else
+		{
+			unique_lock<mutex> lock(load->m_mutex);
+			load->m_condition.wait(lock, [&load]() { return load->IsDone(); });
+		}
+
+		return load;
+	}
+
+	void ResourceCache::LoadQueue(const shared_ptr<ResourceLoad>& load)
+	{
+		// Expects m_loads_mutex to be locked
+		m_loads_pending.push_back({ load, load->m_priority, m_loads_order++ });
+		push_heap(m_loads_pending.begin(), m_loads_pending.end());
+	}
+
+	void ResourceCache::LoadNext()
+	{
+		shared_ptr<ResourceLoad> load;
+		{
+			lock_guard<mutex> lock(m_loads_mutex);
+
+			while (!load && !m_loads_pending.empty())
+			{
+				pop_heap(m_loads_pending.begin(), m_loads_pending.end());
+				auto pending = m_loads_pending.back().load;
+				m_loads_pending.pop_back();
+
+				// A load is cancelled if nobody holds a handle to it by the time it would start
+				auto candidate = pending.lock();
+				if (!candidate)
 				{
-					if (!resource)
-						continue;
+					for (auto& loads : m_loads)
+					{
+						for (auto it = loads.second.begin(); it != loads.second.end();)
+						{
+							it = it->second.expired() ? loads.second.erase(it) : next(it);
+						}
+					}
+					continue;
+				}
+
+				// Entries of loads which got a priority bump, or which got joined by Load(), are stale
+				if (candidate->m_started)
+					continue;
+
+				candidate->m_started	= true;
+				load					= candidate;
+			}
+		}
+
+		if (load)
+		{
+			LoadRun(load);
+		}
+	}
+
+	void ResourceCache::LoadRun(const shared_ptr<ResourceLoad>& load)
+	{
+		auto resource			= load->m_resource;
+		const auto loaded		= resource->LoadFromFile(resource->GetResourceFilePath());
+		resource->m_load_state	= loaded ? LoadState_Completed : LoadState_Failed;
+		if (!loaded)
+		{
+			LOGF_ERROR("Failed to load \"%s\".", resource->GetResourceFilePath().c_str());
+		}
+
+		vector<pair<ResourceLoad::Callback, Load_Thread>> callbacks;
+		{
+			lock_guard<mutex> lock(m_loads_mutex);
+
+			// If a resource with the same name got cached in the meantime, that's the one everybody gets
+			if (loaded)
+			{
+				CacheResource(resource);
+			}
+
+			auto& loads		= m_loads[load->m_type];
+			const auto it	= loads.find(load->m_path);
+			if (it != loads.end() && it->second.lock() == load)
+			{
+				loads.erase(it);
+			}
+
+			{
+				lock_guard<mutex> lock_load(load->m_mutex);
+				load->m_resource	= resource;
+				load->m_state		= loaded ? LoadState_Completed : LoadState_Failed;
+				callbacks.swap(load->m_callbacks);
+			}
 
-					size += resource->GetMemoryUsage();
+			for (auto& callback : callbacks)
+			{
+				if (callback.second == Load_Thread_Main)
+				{
+					m_loads_callbacks.emplace_back(move(callback.first), loaded ? resource : nullptr);
 				}
 			}
 		}
-		else
+		load->m_condition.notify_all();
+
+		for (const auto& callback : callbacks)
 		{
-			for (const auto& resource : m_resource_groups[type])
+			if (callback.second == Load_Thread_Worker)
 			{
-				size += resource->GetMemoryUsage();
+				callback.first(loaded ? resource : nullptr);
+			}
+		}
+	}
+
+	void ResourceCache::Clear()
+	{
+		unique_lock<shared_mutex> lock(m_mutex);
+
+		// Resources can outlive the cache, they shouldn't report back to it anymore
+		for (const auto& group : m_resource_groups)
+		{
+			for (const auto& resource : group.second.resources)
+			{
+				resource->m_cache = nullptr;
+			}
+		}
+
+		m_resource_groups.clear();
+	}
+
+	uint64_t ResourceCache::GetMemoryUsageCpu(const Resource_Type type /*= Resource_Unknown*/)
+	{
+		return GetMemoryUsage(type, false);
+	}
+
+	uint64_t ResourceCache::GetMemoryUsageGpu(const Resource_Type type /*= Resource_Unknown*/)
+	{
+		return GetMemoryUsage(type, true);
+	}
+
+	uint64_t ResourceCache::GetMemoryUsage(const Resource_Type type, const bool gpu)
+	{
+		shared_lock<shared_mutex> lock(m_mutex);
+
+		uint64_t size = 0;
+		for (const auto& group : m_resource_groups)
+		{
+			if (type != Resource_Unknown && group.first != type)
+				continue;
+
+			for (const auto& resource : group.second.resources)
+			{
+				size += gpu ? resource->GetMemoryUsageGpu() : resource->GetMemoryUsageCpu();
 			}
 		}
 
 		return size;
 	}
 
-	void ResourceCache::SaveResourcesToFiles()
+	void ResourceCache::SetMemoryBudget(const Resource_Type type, const uint64_t budget_cpu, const uint64_t budget_gpu)
+	{
+		unique_lock<shared_mutex> lock(m_mutex);
+		m_memory_budgets[type] = { budget_cpu, budget_gpu };
+	}
+
+	void ResourceCache::EnforceMemoryBudgets()
+	{
+		// Evicted resources are released after unlocking, that's when their memory is freed
+		vector<shared_ptr<IResource>> evicted;
+		{
+			unique_lock<shared_mutex> lock(m_mutex);
+
+			for (const auto& it_budget : m_memory_budgets)
+			{
+				const auto& budget	= it_budget.second;
+				const auto it_group	= m_resource_groups.find(it_budget.first);
+				if (it_group == m_resource_groups.end() || (budget.cpu == 0 && budget.gpu == 0))
+					continue;
+
+				// Account, and find the resources which nothing but the cache (the list and the indices) holds on to
+				auto& group			= it_group->second;
+				uint64_t usage_cpu	= 0;
+				uint64_t usage_gpu	= 0;
+				vector<pair<uint64_t, size_t>> candidates;
+				for (size_t i = 0; i < group.resources.size(); i++)
+				{
+					const auto& resource = group.resources[i];
+					usage_cpu += resource->GetMemoryUsageCpu();
+					usage_gpu += resource->GetMemoryUsageGpu();
+
+					const auto it_path	= resource->HasFilePath() ? group.by_path.find(NormalizePath(resource->GetResourceFilePath())) : group.by_path.end();
+					const auto refs		= (it_path != group.by_path.end() && it_path->second == resource) ? 3 : 2;
+					if (resource.use_count() == refs)
+					{
+						candidates.emplace_back(resource->m_last_used.load(), i);
+					}
+				}
+
+				const auto over_budget = [&budget, &usage_cpu, &usage_gpu]()
+				{
+					return (budget.cpu != 0 && usage_cpu > budget.cpu) || (budget.gpu != 0 && usage_gpu > budget.gpu);
+				};
+
+				if (!over_budget())
+					continue;
+
+				// Evict, least recently used first, until the type is within budget
+				sort(candidates.begin(), candidates.end());
+				vector<bool> evict(group.resources.size(), false);
+				for (const auto& candidate : candidates)
+				{
+					if (!over_budget())
+						break;
+
+					// It has to come back (transparently) from an engine file when it's needed again
+					const auto& resource	= group.resources[candidate.second];
+					const auto& file_path	= resource->GetResourceFilePath();
+					if (!(FileSystem::IsEngineTextureFile(file_path) || FileSystem::IsEngineModelFile(file_path)) || !FileSystem::FileExists(file_path))
+						continue;
+
+					usage_cpu -= resource->GetMemoryUsageCpu();
+					usage_gpu -= resource->GetMemoryUsageGpu();
+					IndexRemove(group, resource.get());
+					resource->m_cache = nullptr;
+					evicted.emplace_back(resource);
+					evict[candidate.second] = true;
+				}
+
+				size_t kept = 0;
+				for (size_t i = 0; i < group.resources.size(); i++)
+				{
+					if (!evict[i])
+					{
+						group.resources[kept++] = move(group.resources[i]);
+					}
+				}
+				group.resources.resize(kept);
+			}
+		}
+
+		m_evictions += evicted.size();
+	}
+
+	void ResourceCache::SaveResourcesToFiles(const bool missing_only /*= false*/)
 	{
 		// Start progress report
 		ProgressReport::Get().Reset(g_progress_resource_cache);
 		ProgressReport::Get().SetIsLoading(g_progress_resource_cache, true);
-		ProgressReport::Get().SetStatus(g_progress_resource_cache, "Loading resources...");
+		ProgressReport::Get().SetStatus(g_progress_resource_cache, "Saving resources...");
+
+		// Capture the resources which can be saved, holding on to them keeps them alive until they are written
+		vector<shared_ptr<IResource>> resources;
+		vector<shared_ptr<IResource>> resources_save;
+		for (const auto& resource : GetByType())
+		{
+			if (!resource->HasFilePath())
+				continue;
+
+			resources.emplace_back(resource);
+
+			// Incremental world saves only write the resources which have no file yet
+			if (!missing_only || !FileSystem::FileExists(resource->GetResourceFilePath()))
+			{
+				resources_save.emplace_back(resource);
+			}
+		}
 
 		// Create resource list file
 		string file_path = GetProjectDirectoryAbsolute() + m_context->GetSubsystem<World>()->GetName() + "_resources.dat";
-		auto file = make_unique<FileStream>(file_path, FileStream_Write);
+		auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Async);
 		if (!file->IsOpen())
 		{
 			LOG_ERROR_GENERIC_FAILURE();
+			ProgressReport::Get().SetIsLoading(g_progress_resource_cache, false);
 			return;
 		}
 
-		auto resource_count = GetResourceCount();
-		ProgressReport::Get().SetJobCount(g_progress_resource_cache, resource_count);
+		ProgressReport::Get().SetJobCount(g_progress_resource_cache, static_cast<int>(resources_save.size()));
 
 		// Save resource count
-		file->Write(resource_count);
+		file->Write(static_cast<uint32_t>(resources.size()));
 
-		// Save all the currently used resources to disk
-		for (const auto& resource_group : m_resource_groups)
+		for (const auto& resource : resources)
 		{
-			for (const auto& resource : resource_group.second)
-			{
-				if (!resource->HasFilePath())
-					continue;
+			// Save file path
+			file->Write(resource->GetResourceFilePath());
+			// Save type
+			file->Write(static_cast<uint32_t>(resource->GetResourceType()));
+		}
 
-				// Save file path
-				file->Write(resource->GetResourceFilePath());
-				// Save type
-				file->Write(static_cast<uint32_t>(resource->GetResourceType()));
-				// Save resource (to a dedicated file)
+		// Save the resources (to dedicated files) in the background, one save at a time
+		m_context->GetSubsystem<Threading>()->AddTask([resources_save]()
+		{
+			lock_guard<mutex> lock(g_save_mutex);
+
+			for (const auto& resource : resources_save)
+			{
 				resource->SaveToFile(resource->GetResourceFilePath());
 
 				// Update progress
 				ProgressReport::Get().IncrementJobsDone(g_progress_resource_cache);
 			}
-		}
 
-		// Finish with progress report
-		ProgressReport::Get().SetIsLoading(g_progress_resource_cache, false);
+			// Finish with progress report
+			ProgressReport::Get().SetIsLoading(g_progress_resource_cache, false);
+		});
 	}
 
 	void ResourceCache::LoadResourcesFromFiles()
@@ -238,7 +738,18 @@ namespace Spartan
 
 	uint32_t ResourceCache::GetResourceCount(const Resource_Type type)
 	{
-		return static_cast<uint32_t>(GetByType(type).size());
+		shared_lock<shared_mutex> lock(m_mutex);
+
+		size_t count = 0;
+		for (const auto& group : m_resource_groups)
+		{
+			if (type == Resource_Unknown || group.first == type)
+			{
+				count += group.second.resources.size();
+			}
+		}
+
+		return static_cast<uint32_t>(count);
 	}
 
 	void ResourceCache::AddDataDirectory(const Asset_Type type, const string& directory)
@@ -24,6 +24,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ====================
 #include <memory>
 #include <map>
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
 #include "Import/ModelImporter.h"
 #include "Import/ImageImporter.h"
 #include "Import/FontImporter.h"
@@ -45,20 +50,93 @@ namespace Spartan
 		Asset_Textures
 	};
 
+	// The thread that the completion callbacks of asynchronous loads run on
+	enum Load_Thread
+	{
+		Load_Thread_Worker,	// The thread that did the loading, as soon as it's done
+		Load_Thread_Main	// The thread that ticks the ResourceCache, during its next tick
+	};
+
+	// An asynchronous load, shared by all the LoadAsync() requests for the same file
+	class SPARTAN_CLASS ResourceLoad
+	{
+	public:
+		// The resource is nullptr if the load failed
+		typedef std::function<void(const std::shared_ptr<IResource>&)> Callback;
+
+		LoadState GetState() const	{ return m_state; }
+		bool IsDone() const			{ return m_state == LoadState_Completed || m_state == LoadState_Failed; }
+
+		// Until the load is done, this is a placeholder that gets filled in. If a resource with
+		// the same name got cached in the meantime, this becomes that resource once the load is done.
+		std::shared_ptr<IResource> GetResource();
+
+		// If the load is already done, the callback runs right away on the calling thread
+		void OnComplete(Callback&& callback, Load_Thread thread = Load_Thread_Main);
+
+	private:
+		friend class ResourceCache;
+
+		std::atomic<LoadState> m_state{ LoadState_Started };
+		std::shared_ptr<IResource> m_resource;
+		std::vector<std::pair<Callback, Load_Thread>> m_callbacks;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+
+		// Guarded by the cache
+		Resource_Type m_type	= Resource_Unknown;
+		std::string m_path;
+		int m_priority			= 0;
+		bool m_started			= false;
+	};
+
+	// What LoadAsync() returns. A load that hasn't started yet is cancelled when no handle to it is held anymore.
+	template <class T>
+	class ResourceHandle
+	{
+	public:
+		ResourceHandle() = default;
+		ResourceHandle(std::shared_ptr<ResourceLoad> load) : m_load(std::move(load)) {}
+
+		bool IsValid() const			{ return m_load != nullptr; }
+		LoadState GetState() const		{ return m_load ? m_load->GetState() : LoadState_Failed; }
+		bool IsDone() const				{ return !m_load || m_load->IsDone(); }
+		std::shared_ptr<T> GetResource() const	{ return m_load ? std::static_pointer_cast<T>(m_load->GetResource()) : nullptr; }
+		void Reset()					{ m_load = nullptr; }
+
+		void OnComplete(std::function<void(const std::shared_ptr<T>&)>&& callback, const Load_Thread thread = Load_Thread_Main)
+		{
+			if (!m_load)
+			{
+				callback(nullptr);
+				return;
+			}
+
+			m_load->OnComplete([callback](const std::shared_ptr<IResource>& resource) { callback(std::static_pointer_cast<T>(resource)); }, thread);
+		}
+
+	private:
+		std::shared_ptr<ResourceLoad> m_load;
+	};
+
 	class SPARTAN_CLASS ResourceCache : public ISubsystem
 	{
 	public:
 		ResourceCache(Context* context);
 		~ResourceCache();
 
-		//= Subsystem =============
+		//= Subsystem =======================
 		bool Initialize() override;
-		//=========================
+		void Tick(float delta_time) override;
+		//===================================
 
-        // Get by name
-		std::shared_ptr<IResource>& GetByName(const std::string& name, Resource_Type type);
+		// Lookups are hashed (by name, or by normalized file path) and they only take a shared lock,
+		// so they are cheap and safe to do from loader threads while other threads are caching.
+
+		// Get by name
+		std::shared_ptr<IResource> GetByName(const std::string& name, Resource_Type type);
 		template <class T> 
-		constexpr std::shared_ptr<T> GetByName(const std::string& name) 
+		std::shared_ptr<T> GetByName(const std::string& name) 
 		{ 
 			return std::static_pointer_cast<T>(GetByName(name, IResource::TypeToEnum<T>()));
 		}
@@ -67,35 +145,26 @@ namespace Spartan
 		std::vector<std::shared_ptr<IResource>> GetByType(Resource_Type type = Resource_Unknown);
 
 		// Get by path
+		std::shared_ptr<IResource> GetByPath(const std::string& path, Resource_Type type);
 		template <class T>
-		std::shared_ptr<T>& GetByPath(const std::string& path)
+		std::shared_ptr<T> GetByPath(const std::string& path)
 		{
-			for (auto& resource : m_resource_groups[IResource::TypeToEnum<T>()])
-			{
-				if (path == resource->GetResourceFilePath())
-					return std::static_pointer_cast<T>(resource);
-			}
-
-			return std::static_pointer_cast<T>(m_empty_resource);
+			return std::static_pointer_cast<T>(GetByPath(path, IResource::TypeToEnum<T>()));
 		}
 
-		// Caches resource, or replaces with existing cached resource
+		// Caches resource, or replaces it with the cached resource of the same name (returns false in that case)
 		template <class T>
-		void Cache(std::shared_ptr<T>& resource)
+		bool Cache(std::shared_ptr<T>& resource)
 		{
 			if (!resource)
-				return;
+				return false;
 
-			// If the resource is already loaded, replace it with the existing one, then early exit
-			if (IsCached(resource->GetResourceName(), resource->GetResourceType()))
-			{
-				resource = GetByName<T>(FileSystem::GetFileNameNoExtensionFromFilePath(resource->GetResourceFilePath()));
-				return;
-			}
+			auto cached = std::static_pointer_cast<IResource>(resource);
+			if (CacheResource(cached))
+				return true;
 
-			// Cache the resource
-			std::lock_guard<mutex> guard(m_mutex);
-			m_resource_groups[resource->GetResourceType()].emplace_back(resource);
+			resource = std::static_pointer_cast<T>(cached);
+			return false;
 		}
 		bool IsCached(const std::string& resource_name, Resource_Type resource_type);
 
@@ -114,10 +183,12 @@ namespace Spartan
 			auto name				= FileSystem::GetFileNameNoExtensionFromFilePath(file_path_relative);
 
 			// Check if the resource is already loaded
-			if (IsCached(name, IResource::TypeToEnum<T>()))
-			{
-				return GetByName<T>(name);
-			}
+			if (auto cached = GetByName<T>(name))
+				return cached;
+
+			// If it's being loaded asynchronously, finish that load instead of loading the file twice
+			if (auto load = LoadJoin(IResource::TypeToEnum<T>(), file_path_relative))
+				return load->GetState() == LoadState_Completed ? std::static_pointer_cast<T>(load->GetResource()) : nullptr;
 
 			// Create new resource
 			auto typed = std::make_shared<T>(m_context);
@@ -125,8 +196,10 @@ namespace Spartan
 			typed->SetResourceName(name);
 			typed->SetResourceFilePath(file_path_relative);
 
-			// Cache it now so LoadFromFile() can safely pass around a reference to the resource from the ResourceManager
-			Cache<T>(typed);
+			// Cache it now so LoadFromFile() can safely pass around a reference to the resource from the ResourceManager.
+			// If another thread cached it in the meantime, that one is used instead.
+			if (!Cache<T>(typed))
+				return typed;
 
 			// Load
 			if (!typed->LoadFromFile(file_path_relative))
@@ -139,16 +212,43 @@ namespace Spartan
 			return typed;
 		}
 
+		// Loads a resource in the background and returns right away. Requests for a file that is already
+		// being loaded join that load, and loads with a higher priority start first.
+		template <class T>
+		ResourceHandle<T> LoadAsync(const std::string& file_path, const int priority = 0)
+		{
+			if (!FileSystem::FileExists(file_path))
+			{
+				LOGF_ERROR("Path \"%s\" is invalid.", file_path.c_str());
+				return ResourceHandle<T>();
+			}
+
+			const auto file_path_relative = FileSystem::GetRelativeFilePath(file_path);
+
+			return ResourceHandle<T>(LoadAsync(IResource::TypeToEnum<T>(), file_path_relative, priority, [this, &file_path_relative]()
+			{
+				auto typed = std::make_shared<T>(m_context);
+				typed->SetResourceName(FileSystem::GetFileNameNoExtensionFromFilePath(file_path_relative));
+				typed->SetResourceFilePath(file_path_relative);
+				return std::static_pointer_cast<IResource>(typed);
+			}));
+		}
+
 		//= I/O ======================
-		void SaveResourcesToFiles();
+		void SaveResourcesToFiles(bool missing_only = false);
 		void LoadResourcesFromFiles();
 		//============================
 
 		//= MISC ========================================================
-		// Memory
-		uint32_t GetMemoryUsage(Resource_Type type = Resource_Unknown);
+		// Memory, in bytes
+		uint64_t GetMemoryUsage(Resource_Type type = Resource_Unknown)		{ return GetMemoryUsageCpu(type) + GetMemoryUsageGpu(type); }
+		uint64_t GetMemoryUsageCpu(Resource_Type type = Resource_Unknown);
+		uint64_t GetMemoryUsageGpu(Resource_Type type = Resource_Unknown);
+		// Memory budgets per type, in bytes (0 is unlimited). When a type goes over budget, its least recently used resources
+		// are evicted, as long as nothing but the cache holds on to them and they can be reloaded from an engine texture or model file.
+		void SetMemoryBudget(Resource_Type type, uint64_t budget_cpu, uint64_t budget_gpu);
 		// Unloads all resources
-		void Clear() { m_resource_groups.clear(); }
+		void Clear();
 		// Returns all resources of a given type
 		uint32_t GetResourceCount(Resource_Type type = Resource_Unknown);
 		//===============================================================
@@ -168,9 +268,68 @@ namespace Spartan
 		auto GetFontImporter()  const { return m_importer_font.get(); }
 
 	private:
+		friend class IResource;
+
+		// Resources of a type, indexed by name and by normalized file path
+		struct ResourceGroup
+		{
+			std::vector<std::shared_ptr<IResource>> resources;
+			std::unordered_map<std::string, std::shared_ptr<IResource>> by_name;
+			std::unordered_map<std::string, std::shared_ptr<IResource>> by_path;
+		};
+
+		bool CacheResource(std::shared_ptr<IResource>& resource);
+
+		// Invoked by cached resources when their name or file path changes, so that they can be found under the new ones
+		void Rename(IResource* resource, const std::string& name, const std::string& file_path);
+
+		void IndexAdd(ResourceGroup& group, const std::shared_ptr<IResource>& resource);
+		void IndexRemove(ResourceGroup& group, const IResource* resource);
+
+		// Asynchronous loads
+		struct PendingLoad
+		{
+			std::weak_ptr<ResourceLoad> load;
+			int priority;
+			uint64_t order;
+
+			// Highest priority first, then first come first served
+			bool operator<(const PendingLoad& other) const { return priority != other.priority ? priority < other.priority : order > other.order; }
+		};
+		std::shared_ptr<ResourceLoad> LoadAsync(Resource_Type type, const std::string& file_path, int priority, const std::function<std::shared_ptr<IResource>()>& create);
+		std::shared_ptr<ResourceLoad> LoadJoin(Resource_Type type, const std::string& file_path);
+		void LoadQueue(const std::shared_ptr<ResourceLoad>& load);
+		void LoadNext();
+		void LoadRun(const std::shared_ptr<ResourceLoad>& load);
+
+		// Budgets
+		struct MemoryBudget
+		{
+			uint64_t cpu = 0;
+			uint64_t gpu = 0;
+		};
+		void EnforceMemoryBudgets();
+		uint64_t GetMemoryUsage(Resource_Type type, bool gpu);
+
 		// Cache
-		std::map<Resource_Type, std::vector<std::shared_ptr<IResource>>> m_resource_groups;
-		std::mutex m_mutex;
+		std::map<Resource_Type, ResourceGroup> m_resource_groups;
+		std::shared_mutex m_mutex;
+
+		// Loads in flight (by type and normalized path), the ones waiting for a thread and the callbacks waiting for a tick
+		std::map<Resource_Type, std::unordered_map<std::string, std::weak_ptr<ResourceLoad>>> m_loads;
+		std::vector<PendingLoad> m_loads_pending;
+		uint64_t m_loads_order = 0;
+		std::vector<std::pair<ResourceLoad::Callback, std::shared_ptr<IResource>>> m_loads_callbacks;
+		std::mutex m_loads_mutex;
+
+		// Memory budgets, least recently used tracking and stats
+		std::map<Resource_Type, MemoryBudget> m_memory_budgets;
+		float m_memory_budget_interval_sec		= 1.0f;
+		float m_time_since_memory_budget_sec	= 0.0f;
+		std::atomic<uint64_t> m_frame			= 0;
+		std::atomic<uint64_t> m_hits			= 0;
+		std::atomic<uint64_t> m_misses			= 0;
+		std::atomic<uint64_t> m_evictions		= 0;
 
 		// Directories
 		std::map<Asset_Type, std::string> m_standard_resource_directories;
@@ -180,7 +339,5 @@ namespace Spartan
 		std::shared_ptr<ModelImporter> m_importer_model;
 		std::shared_ptr<ImageImporter> m_importer_image;
 		std::shared_ptr<FontImporter> m_importer_font;
-
-		std::shared_ptr<IResource> m_empty_resource = nullptr;
 	};
 }
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <atomic>
 #include <functional>
 #include "../Logging/Log.h"
 #include "../Core/ISubsystem.h"
@@ -80,6 +81,53 @@ namespace Spartan
 			m_conditionVar.notify_one();
 		}
 
+		// Splits [0, range) into chunks and runs function(start, end) on each of them.
+		// The calling thread works on chunks too and the function returns once they are all done,
+		// so it never waits on workers which are busy with something else (e.g. a world load).
+		template <typename Function>
+		void AddTaskLoop(Function&& function, const uint32_t range)
+		{
+			if (range == 0)
+				return;
+
+			struct Loop
+			{
+				std::atomic<uint32_t> chunk_next	= 0;
+				std::atomic<uint32_t> chunk_done	= 0;
+			};
+
+			const uint32_t chunk_count	= range < m_thread_count + 1 ? range : m_thread_count + 1;
+			const uint32_t chunk_size	= (range + chunk_count - 1) / chunk_count;
+			auto loop					= std::make_shared<Loop>();
+
+			// Claims chunks until there are none left, workers that start late simply find nothing to do
+			auto work = [loop, &function, chunk_count, chunk_size, range]()
+			{
+				for (uint32_t chunk = loop->chunk_next++; chunk < chunk_count; chunk = loop->chunk_next++)
+				{
+					const uint32_t start	= chunk * chunk_size;
+					const uint32_t end		= start + chunk_size < range ? start + chunk_size : range;
+					if (start < end)
+					{
+						function(start, end);
+					}
+					loop->chunk_done++;
+				}
+			};
+
+			for (uint32_t i = 1; i < chunk_count; i++)
+			{
+				AddTask(work);
+			}
+			work();
+
+			// Wait for the chunks that the workers claimed
+			while (loop->chunk_done < chunk_count)
+			{
+				std::this_thread::yield();
+			}
+		}
+
         auto GetThreadCount()       { return m_thread_count; }
         auto GetThreadCountMax()    { return m_thread_max; }
 
@@ -38,6 +38,7 @@ namespace Spartan
         //= COMPONENT =========================
         void OnInitialize() override;
         void OnTick(float delta_time) override;
+        bool IsDeserializeThreadSafe() const override { return true; }
         //=====================================
 
 	private:
@@ -118,6 +118,7 @@ namespace Spartan
 			return;
 		}
 		m_audio_clip = audio_clip;
+		MarkDirty();
 	}
 
 	string AudioSource::GetAudioClipName()
@@ -154,6 +155,7 @@ namespace Spartan
 			return;
 	
 		m_mute = mute;
+		MarkDirty();
 		m_audio_clip->SetMute(mute);
 	}
 	
@@ -165,6 +167,7 @@ namespace Spartan
 		// Priority for the channel, from 0 (most important) 
 		// to 256 (least important), default = 128.
 		m_priority = (int)Clamp(priority, 0, 255);
+		MarkDirty();
 		m_audio_clip->SetPriority(m_priority);
 	}
 	
@@ -174,6 +177,7 @@ namespace Spartan
 			return;
 	
 		m_volume = Clamp(volume, 0.0f, 1.0f);
+		MarkDirty();
 		m_audio_clip->SetVolume(m_volume);
 	}
 	
@@ -183,6 +187,7 @@ namespace Spartan
 			return;
 	
 		m_pitch = Clamp(pitch, 0.0f, 3.0f);
+		MarkDirty();
 		m_audio_clip->SetPitch(m_pitch);
 	}
 	
@@ -193,6 +198,7 @@ namespace Spartan
 	
 		// Pan level, from -1.0 (left) to 1.0 (right).
 		m_pan = Clamp(pan, -1.0f, 1.0f);
+		MarkDirty();
 		m_audio_clip->SetPan(m_pan);
 	}
 }
@@ -108,18 +108,21 @@ namespace Spartan
 	{
 		m_near_plane = Max(0.01f, near_plane);
 		m_isDirty = true;
+		MarkDirty();
 	}
 
 	void Camera::SetFarPlane(const float far_plane)
 	{
 		m_far_plane = far_plane;
 		m_isDirty = true;
+		MarkDirty();
 	}
 
 	void Camera::SetProjection(const ProjectionType projection)
 	{
 		m_projection_type = projection;
 		m_isDirty = true;
+		MarkDirty();
 	}
 
     float Camera::GetFovHorizontalDeg() const
@@ -136,6 +139,7 @@ namespace Spartan
 	{
 		m_fov_horizontal_rad = DegreesToRadians(fov);
 		m_isDirty = true;
+		MarkDirty();
 	}
 
     const Spartan::RHI_Viewport& Camera::GetViewport()
@@ -106,6 +106,7 @@ namespace Spartan
 		m_size.x = Clamp(m_size.x, M_EPSILON, INFINITY);
 		m_size.y = Clamp(m_size.y, M_EPSILON, INFINITY);
 		m_size.z = Clamp(m_size.z, M_EPSILON, INFINITY);
+		MarkDirty();
 
 		Shape_Update();
 	}
@@ -116,6 +117,7 @@ namespace Spartan
 			return;
 
 		m_center = center;
+		MarkDirty();
 		RigidBody_SetCenterOfMass(m_center);
 	}
 
@@ -125,6 +127,7 @@ namespace Spartan
 			return;
 
 		m_shapeType = type;
+		MarkDirty();
 		Shape_Update();
 	}
 
@@ -134,6 +137,7 @@ namespace Spartan
 			return;
 
 		m_optimize = optimize;
+		MarkDirty();
 		Shape_Update();
 	}
 
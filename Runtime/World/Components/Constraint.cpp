@@ -119,17 +119,31 @@ namespace Spartan
 		stream->Read(&m_highLimit);
 		stream->Read(&m_lowLimit);
 
-		const auto body_other_id = stream->ReadAs<uint32_t>();
-		m_bodyOther = GetContext()->GetSubsystem<World>()->EntityGetById(body_other_id);
+		m_bodyOtherId	= stream->ReadAs<uint32_t>();
+		m_bodyOther		= GetContext()->GetSubsystem<World>()->EntityGetById(m_bodyOtherId);
 
 		Construct();
 	}
 
+	void Constraint::OnWorldLoaded()
+	{
+		if (m_bodyOtherId == 0 || !m_bodyOther.expired())
+			return;
+
+		// Not set through SetBodyOther(), the constraint is as it was saved
+		m_bodyOther = GetContext()->GetSubsystem<World>()->EntityGetById(m_bodyOtherId);
+		if (!m_bodyOther.expired())
+		{
+			Construct();
+		}
+	}
+
 	void Constraint::SetConstraintType(const ConstraintType type)
 	{
 		if (m_type != type || !m_constraint)
 		{
 			m_constraintType = type;
+			MarkDirty();
 			Construct();
 		}
 	}
@@ -139,6 +153,7 @@ namespace Spartan
 		if (m_position != position)
 		{
 			m_position = position;
+			MarkDirty();
 			ApplyFrames();
 		}
 	}
@@ -148,6 +163,7 @@ namespace Spartan
 		if (m_rotation != rotation)
 		{
 			m_rotation = rotation;
+			MarkDirty();
 			ApplyFrames();
 		}
 	}
@@ -157,6 +173,7 @@ namespace Spartan
 		if (position != m_positionOther)
 		{
 			m_positionOther = position;
+			MarkDirty();
 			ApplyFrames();
 		}
 	}
@@ -166,6 +183,7 @@ namespace Spartan
 		if (rotation != m_rotationOther)
 		{
 			m_rotationOther = rotation;
+			MarkDirty();
 			ApplyFrames();
 		}
 	}
@@ -182,6 +200,7 @@ namespace Spartan
 		}
 
 		m_bodyOther = body_other;
+		MarkDirty();
 		Construct();
 	}
 
@@ -190,6 +209,7 @@ namespace Spartan
 		if (m_highLimit != limit)
 		{
 			m_highLimit = limit;
+			MarkDirty();
 			ApplyLimits();
 		}
 	}
@@ -199,6 +219,7 @@ namespace Spartan
 		if (m_lowLimit != limit)
 		{
 			m_lowLimit = limit;
+			MarkDirty();
 			ApplyLimits();
 		}
 	}
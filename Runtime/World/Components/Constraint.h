@@ -58,6 +58,7 @@ namespace Spartan
 		void OnTick(float delta_time) override;
 		void Serialize(FileStream* stream) override;
 		void Deserialize(FileStream* stream) override;
+		void OnWorldLoaded() override;
 		//============================================
 
 		ConstraintType GetConstraintType() { return m_constraintType; }
@@ -106,6 +107,7 @@ namespace Spartan
 		Math::Vector2 m_lowLimit;
 
 		std::weak_ptr<Entity> m_bodyOther;
+		uint32_t m_bodyOtherId = 0; // while loading, the other body may not be in the world yet
 		Math::Vector3 m_positionOther;
 		Math::Quaternion m_rotationOther;
 	
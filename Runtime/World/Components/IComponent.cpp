@@ -20,6 +20,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 //= INCLUDES ===========================
+#include <cstring>
 #include "IComponent.h"
 #include "Light.h"
 #include "Environment.h"
@@ -63,6 +64,72 @@ namespace Spartan
 		return m_entity->GetName();
 	}
 
+    void IComponent::SetAttributeValue(const uint32_t index, const void* value)
+    {
+        if (index >= static_cast<uint32_t>(m_attributes.size()) || !value)
+            return;
+
+        const auto& attribute   = m_attributes[index];
+        void* value_current     = GetAttributeValue(attribute);
+
+        if (attribute.is_pod)
+        {
+            if (memcmp(value_current, value, attribute.size) != 0)
+            {
+                memcpy(value_current, value, attribute.size);
+                MarkDirty();
+            }
+        }
+        else if (!attribute.equal(value_current, value))
+        {
+            attribute.assign(this, value);
+            MarkDirty();
+        }
+    }
+
+    void IComponent::CopyAttributes(const IComponent* source)
+    {
+        if (!source || source->GetType() != m_type)
+            return;
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_attributes.size()); i++)
+        {
+            SetAttributeValue(i, source->GetAttributeValue(m_attributes[i]));
+        }
+    }
+
+    uint64_t IComponent::DiffAttributes(const IComponent* other) const
+    {
+        if (!other || other->GetType() != m_type)
+            return ~uint64_t(0);
+
+        SPARTAN_ASSERT(m_attributes.size() <= 64);
+
+        uint64_t mask = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_attributes.size()); i++)
+        {
+            const auto& attribute   = m_attributes[i];
+            const void* a           = GetAttributeValue(attribute);
+            const void* b           = other->GetAttributeValue(attribute);
+            const bool equal        = attribute.is_trivial ? memcmp(a, b, attribute.size) == 0 : attribute.equal(a, b);
+
+            if (!equal)
+            {
+                mask |= uint64_t(1) << i;
+            }
+        }
+
+        return mask;
+    }
+
+    void IComponent::MarkDirty()
+    {
+        if (m_entity)
+        {
+            m_entity->MarkDirty();
+        }
+    }
+
 	template <typename T>
     inline constexpr ComponentType IComponent::TypeToEnum() { return ComponentType_Unknown; }
 
@@ -24,9 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =========================
 #include <memory>
 #include <string>
-#include <any>
 #include <vector>
-#include <functional>
+#include <type_traits>
 #include "../../Core/EngineDefs.h"
 #include "../../Core/Spartan_Object.h"
 //====================================
@@ -37,6 +36,7 @@ namespace Spartan
 	class Transform;
 	class Context;
 	class FileStream;
+	class IComponent;
 
 	enum ComponentType : uint32_t
 	{
@@ -54,10 +54,28 @@ namespace Spartan
 		ComponentType_Unknown
 	};
 
+	// Describes a member of a component, it's generated at compile time from a pointer to that member
 	struct Attribute
 	{
-		std::function<std::any()> getter;
-		std::function<void(std::any)> setter;
+		const char* name	= nullptr;
+		uint32_t offset		= 0;		// Byte offset of the member, relative to the component
+		uint32_t size		= 0;		// Byte size of the member
+		bool is_trivial		= false;	// The member is trivially copyable, so it's value can be stored as raw bytes
+		bool is_pod			= false;	// The member is trivially copyable and has no setter, so it can be copied with a memcpy
+		bool (*equal)(const void* a, const void* b)					= nullptr;	// Compares two values of the member
+		void (*assign)(IComponent* component, const void* value)	= nullptr;	// Assigns a value to the member (through the setter, if any)
+		std::shared_ptr<void> (*clone)(const void* value)			= nullptr;	// Copies a value of the member into a new allocation
+	};
+
+	// Splits a pointer to member into the class and the member types
+	template <typename T>
+	struct attribute_traits;
+
+	template <typename C, typename M>
+	struct attribute_traits<M C::*>
+	{
+		using component_type	= C;
+		using member_type		= M;
 	};
 
 	class SPARTAN_CLASS IComponent : public Spartan_Object
@@ -87,6 +105,13 @@ namespace Spartan
 		// Runs when the entity is being loaded
 		virtual void Deserialize(FileStream* stream) {}
 
+		// Runs once every entity of a loaded world is in it, so that references to other entities (by id) can be resolved
+		virtual void OnWorldLoaded() {}
+
+		// Whether Deserialize() touches nothing but the entity (and shared state which is only read), so
+		// that hierarchies which aren't part of the world yet can be loaded in parallel
+		virtual bool IsDeserializeThreadSafe() const { return false; }
+
 		//= TYPE ===================================
 		template <typename T>
 		static constexpr ComponentType TypeToEnum();
@@ -103,35 +128,62 @@ namespace Spartan
 		ComponentType GetType() const	    { return m_type; }
         void SetType(ComponentType type)    { m_type = type; }
 
+		//= ATTRIBUTES ============================================================================
 		const auto& GetAttributes() const { return m_attributes; }
-		void SetAttributes(const std::vector<Attribute>& attributes)
-		{ 
-			for (uint32_t i = 0; i < static_cast<uint32_t>(m_attributes.size()); i++)
-			{
-				m_attributes[i].setter(attributes[i].getter());
-			}
-		}
+
+		// Returns the address of an attribute's value within this component
+		const void* GetAttributeValue(const Attribute& attribute) const	{ return reinterpret_cast<const char*>(this) + attribute.offset; }
+		void* GetAttributeValue(const Attribute& attribute)				{ return reinterpret_cast<char*>(this) + attribute.offset; }
+
+		// Sets the value of an attribute, unchanged values are skipped
+		void SetAttributeValue(uint32_t index, const void* value);
+
+		// Copies all the attributes of a component of the same type, unchanged values are skipped
+		void CopyAttributes(const IComponent* source);
+
+		// Returns a mask with a bit set for every attribute that differs from a component of the same type
+		uint64_t DiffAttributes(const IComponent* other) const;
 		//=========================================================================================
 
+		// Flags the entity as changed since the world was last saved, setters of saved state call it
+		void MarkDirty();
+
 	protected:
-		#define REGISTER_ATTRIBUTE_GET_SET(getter, setter, type) RegisterAttribute(		\
-		[this]()						{ return getter(); },							\
-		[this](const std::any& valueIn) { setter(std::any_cast<type>(valueIn)); });		\
+		#define REGISTER_ATTRIBUTE_VALUE_SET(value, setter, type)	RegisterAttribute<&std::remove_pointer_t<decltype(this)>::value, type, &std::remove_pointer_t<decltype(this)>::setter>(#value)
+		#define REGISTER_ATTRIBUTE_VALUE_VALUE(value, type)			RegisterAttribute<&std::remove_pointer_t<decltype(this)>::value, type>(#value)
 
-		#define REGISTER_ATTRIBUTE_VALUE_SET(value, setter, type) RegisterAttribute(	\
-		[this]()						{ return value; },								\
-		[this](const std::any& valueIn) { setter(std::any_cast<type>(valueIn)); });		\
+		// Registers an attribute, everything about it is resolved at compile time from the pointer to member
+		template <auto Member, typename Type, auto Setter = nullptr>
+		void RegisterAttribute(const char* name)
+		{
+			using component_type	= typename attribute_traits<decltype(Member)>::component_type;
+			using member_type		= typename attribute_traits<decltype(Member)>::member_type;
+			static_assert(std::is_same<member_type, Type>::value, "The type of the attribute doesn't match the type of the member");
+			static_assert(std::is_base_of<IComponent, component_type>::value, "The attribute doesn't belong to a component");
 
-		#define REGISTER_ATTRIBUTE_VALUE_VALUE(value, type) RegisterAttribute(			\
-		[this]()						{ return value; },								\
-		[this](const std::any& valueIn) { value = std::any_cast<type>(valueIn); });		\
+			// The component is being constructed, so the address of the member is already known
+			const auto component = static_cast<component_type*>(this);
 
-		// Registers an attribute
-		void RegisterAttribute(std::function<std::any()>&& getter, std::function<void(std::any)>&& setter)
-		{ 
 			Attribute attribute;
-			attribute.getter = std::move(getter);
-			attribute.setter = std::move(setter);
+			attribute.name			= name;
+			attribute.offset		= static_cast<uint32_t>(reinterpret_cast<const char*>(&(component->*Member)) - reinterpret_cast<const char*>(static_cast<IComponent*>(component)));
+			attribute.size			= static_cast<uint32_t>(sizeof(member_type));
+			attribute.is_trivial	= std::is_trivially_copyable<member_type>::value;
+			attribute.is_pod		= attribute.is_trivial && std::is_same<decltype(Setter), std::nullptr_t>::value;
+			attribute.equal			= [](const void* a, const void* b) { return *static_cast<const member_type*>(a) == *static_cast<const member_type*>(b); };
+			attribute.clone			= [](const void* value) { return std::static_pointer_cast<void>(std::make_shared<member_type>(*static_cast<const member_type*>(value))); };
+			attribute.assign		= [](IComponent* component, const void* value)
+			{
+				if constexpr (std::is_same<decltype(Setter), std::nullptr_t>::value)
+				{
+					static_cast<component_type*>(component)->*Member = *static_cast<const member_type*>(value);
+				}
+				else
+				{
+					(static_cast<component_type*>(component)->*Setter)(*static_cast<const member_type*>(value));
+				}
+			};
+
 			m_attributes.emplace_back(attribute);
 		}
 
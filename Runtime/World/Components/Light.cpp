@@ -24,11 +24,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Transform.h"
 #include "Camera.h"
 #include "Renderable.h"
+#include "../WorldSnapshot.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
 #include "../../Core/Context.h"
 #include "../../RHI/RHI_Texture2D.h"
-#include "../../RHI/RHI_TextureCube.h"
 #include "../../RHI/RHI_ConstantBuffer.h"
 //=======================================
 
@@ -48,7 +48,7 @@ namespace Spartan
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_color, Vector4);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_bias, float);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_normal_bias, float);
-		REGISTER_ATTRIBUTE_GET_SET(GetLightType, SetLightType, LightType);
+		REGISTER_ATTRIBUTE_VALUE_SET(m_lightType, SetLightType, LightType);
 
 		m_renderer = m_context->GetSubsystem<Renderer>().get();
 	}
@@ -103,7 +103,7 @@ namespace Spartan
 		ComputeViewMatrix();
 
 		// Update projection matrix
-		for (uint32_t i = 0; i < m_shadow_map->GetArraySize(); i++)
+		for (uint32_t i = 0; i < GetShadowSliceCount(); i++)
 		{
 			ComputeProjectionMatrix(i);
 		}
@@ -139,31 +139,32 @@ namespace Spartan
 	{
 		m_lightType = type;
 		m_is_dirty	= true;
-
-        // Temp tweak because only directional light shadows work without issues so far
-        m_cast_shadows = GetLightType() == LightType_Directional;
+		MarkDirty();
 
 		CreateShadowMap(true);
 	}
 
 	void Light::SetCastShadows(bool castShadows)
 	{
-		if (m_cast_shadows = castShadows)
+		if (m_cast_shadows == castShadows)
 			return;
 
 		m_cast_shadows = castShadows;
+		MarkDirty();
 		CreateShadowMap(true);
 	}
 
 	void Light::SetRange(float range)
 	{
 		m_range = Clamp(range, 0.0f, INFINITY);
+		MarkDirty();
 	}
 
 	void Light::SetAngle(float angle)
 	{
 		m_angle_rad = Clamp(angle, 0.0f, 1.0f);
 		m_is_dirty = true;
+		MarkDirty();
 	}
 
 	Vector3 Light::GetDirection()
@@ -222,7 +223,7 @@ namespace Spartan
 
 	bool Light::ComputeProjectionMatrix(uint32_t index /*= 0*/)
 	{
-		if (index >= m_shadow_map->GetArraySize())
+		if (index >= GetShadowSliceCount())
         {
             LOG_ERROR_INVALID_PARAMETER();
             return false;
@@ -245,9 +246,7 @@ namespace Spartan
 		}
 		else
 		{
-			const auto width			= static_cast<float>(m_shadow_map->GetWidth());
-			const auto height			= static_cast<float>(m_shadow_map->GetHeight());		
-			const auto aspect_ratio		= width / height;
+			const auto aspect_ratio		= 1.0f; // atlas tiles are square
 			const float fov				= (m_lightType == LightType_Spot) ? m_angle_rad : 1.57079633f; // 1.57079633 = 90 deg
 			const float near_plane		= m_renderer->GetReverseZ() ? m_range : 0.1f;
 			const float far_plane		= m_renderer->GetReverseZ() ? 0.1f : m_range;
@@ -420,16 +419,20 @@ namespace Spartan
 		{
 			m_shadow_map = make_unique<RHI_Texture2D>(m_context, resolution, resolution, Format_D32_FLOAT, g_cascade_count);
 		}
-		else if (GetLightType() == LightType_Point)
-		{
-			m_shadow_map = make_unique<RHI_TextureCube>(m_context, resolution, resolution, Format_D32_FLOAT);			
-		}
-		else if (GetLightType() == LightType_Spot)
+		else
 		{
-			m_shadow_map = make_unique<RHI_Texture2D>(m_context, resolution, resolution, Format_D32_FLOAT, 1);
+			// Point and spot lights get tiles of the renderer's shadow atlas, sized by how much of the screen they cover
+			m_shadow_map.reset();
 		}
 	}
 
+	uint32_t Light::GetShadowSliceCount()
+	{
+		if (m_lightType == LightType_Directional)	return g_cascade_count;
+		if (m_lightType == LightType_Point)			return 6;
+		return 1;
+	}
+
     bool Light::IsInViewFrustrum(Renderable* renderable, uint32_t index)
     {
         const auto box      = renderable->GetAabb();
@@ -439,7 +442,7 @@ namespace Spartan
         return m_cascades[index].frustum.CheckCube(center, extents) != Outside;
     }
 
-    void Light::UpdateConstantBuffer(bool volumetric_lighting, bool screen_space_contact_shadows)
+    void Light::UpdateConstantBuffer(const SnapshotLight& light, const Matrix* view_projection, const Vector4* shadow_atlas_rects, bool shadows, bool volumetric_lighting, bool screen_space_contact_shadows)
     {
         // Has to match GBuffer.hlsl
         if (!m_cb_light_gpu)
@@ -451,22 +454,23 @@ namespace Spartan
         // Update buffer
         auto buffer = static_cast<CB_Light*>(m_cb_light_gpu->Map());
 
-        for (int i = 0; i < g_cascade_count; i++)
+        for (int i = 0; i < g_shadow_slice_count_max; i++)
         {
-            buffer->view_projection[i] = GetViewMatrix(i) * GetProjectionMatrix(i);
+            buffer->view_projection[i]      = view_projection[i];
+            buffer->shadow_atlas_rects[i]   = shadow_atlas_rects ? shadow_atlas_rects[i] : Vector4::Zero;
         }
-        buffer->color                           = m_color;
-        buffer->intensity                       = GetIntensity();
-        buffer->position                        = GetTransform()->GetPosition();
-        buffer->range                           = GetRange();
-        buffer->direction                       = GetDirection();
-        buffer->angle                           = GetAngle();
-        buffer->bias                            = m_renderer->GetReverseZ() ? GetBias() : -GetBias();
-        buffer->normal_bias                     = GetNormalBias();
-        buffer->shadow_enabled                  = GetCastShadows();
+        buffer->color                           = light.color;
+        buffer->intensity                       = light.intensity;
+        buffer->position                        = light.position;
+        buffer->range                           = light.range;
+        buffer->direction                       = light.direction;
+        buffer->angle                           = light.angle;
+        buffer->bias                            = m_renderer->GetReverseZ() ? light.bias : -light.bias;
+        buffer->normal_bias                     = light.normal_bias;
+        buffer->shadow_enabled                  = shadows;
         buffer->volumetric_lighting             = volumetric_lighting;
         buffer->screen_space_contact_shadows    = screen_space_contact_shadows;
 
         m_cb_light_gpu->Unmap();
     }
-}  
+}
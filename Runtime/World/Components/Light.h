@@ -38,6 +38,7 @@ namespace Spartan
 	class Camera;
 	class Renderable;
 	class Renderer;
+	struct SnapshotLight;
 
 	enum LightType
 	{
@@ -47,6 +48,7 @@ namespace Spartan
 	};
 
     static const int g_cascade_count = 4;
+    static const int g_shadow_slice_count_max = 6; // the faces of a point light's cube
     struct Cascade
     {
         Math::Vector3 min       = Math::Vector3::Zero;
@@ -72,11 +74,11 @@ namespace Spartan
 		auto GetLightType() { return m_lightType; }
 		void SetLightType(LightType type);
 
-		void SetColor(float r, float g, float b, float a)	{ m_color = Math::Vector4(r, g, b, a); }
-		void SetColor(const Math::Vector4& color)			{ m_color = color; }
+		void SetColor(float r, float g, float b, float a)	{ m_color = Math::Vector4(r, g, b, a); MarkDirty(); }
+		void SetColor(const Math::Vector4& color)			{ m_color = color; MarkDirty(); }
 		const auto& GetColor()								{ return m_color; }
 
-		void SetIntensity(float value)	{ m_intensity = value; }
+		void SetIntensity(float value)	{ m_intensity = value; MarkDirty(); }
 		auto GetIntensity()				{ return m_intensity; }
 
 		bool GetCastShadows() { return m_cast_shadows; }
@@ -88,10 +90,10 @@ namespace Spartan
 		void SetAngle(float angle);
 		auto GetAngle() { return m_angle_rad; }
 
-		void SetBias(float value)	{ m_bias = value; }
+		void SetBias(float value)	{ m_bias = value; MarkDirty(); }
 		float GetBias()				{ return m_bias; }
 
-		void SetNormalBias(float value) { m_normal_bias = value; }
+		void SetNormalBias(float value) { m_normal_bias = value; MarkDirty(); }
 		auto GetNormalBias()			{ return m_normal_bias; }
 
 		Math::Vector3 GetDirection();
@@ -100,13 +102,17 @@ namespace Spartan
 		const Math::Matrix& GetViewMatrix(uint32_t index = 0);
 		const Math::Matrix& GetProjectionMatrix(uint32_t index = 0);
 
+		const auto& GetCascades() const { return m_cascades; }
 		const auto& GetShadowMap() { return m_shadow_map; }
         void CreateShadowMap(bool force);
+        // A cascade each for directional lights, a cube face each for point lights, a single one for spot lights
+        uint32_t GetShadowSliceCount();
 
         bool IsInViewFrustrum(Renderable* renderable, uint32_t index);
 
-        // Constant buffer
-        void UpdateConstantBuffer(bool volumetric_lighting, bool screen_space_contact_shadows);
+        // Constant buffer, filled from the snapshot the renderer is drawing, the view projection each shadow slice was rendered with
+        // and, for point and spot lights, where the slices are in the shadow atlas (offset and scale, in texture coordinates)
+        void UpdateConstantBuffer(const SnapshotLight& light, const Math::Matrix* view_projection, const Math::Vector4* shadow_atlas_rects, bool shadows, bool volumetric_lighting, bool screen_space_contact_shadows);
         const auto& GetConstantBuffer() const { return m_cb_light_gpu; }
 
 	private:
@@ -130,14 +136,15 @@ namespace Spartan
 		Math::Matrix m_camera_last_view;
         std::vector<Cascade> m_cascades;
 		
-		// Shadow map
+		// Shadow map, only directional lights own one, the rest render into the renderer's shadow atlas
 		std::shared_ptr<RHI_Texture> m_shadow_map;	
 		Renderer* m_renderer;
 
         // Constant buffer
         struct CB_Light
         {
-            Math::Matrix view_projection[g_cascade_count];
+            Math::Matrix view_projection[g_shadow_slice_count_max];
+            Math::Vector4 shadow_atlas_rects[g_shadow_slice_count_max];
             Math::Vector3 color;
             float intensity;
             Math::Vector3 position;
@@ -22,6 +22,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ==================================
 #include "Renderable.h"
 #include "Transform.h"
+#include "../World.h"
+#include "../Entity.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Rendering/Model.h"
@@ -36,6 +38,13 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	// The first world format version which stores the occluder flag. It was added before worlds had a header,
+	// so every versioned file has it and only the old sequential files (version 0) don't.
+	static const uint32_t g_version_occluder = 1;
+
+	// The first world format version which stores the file path of the model next to it's name
+	static const uint32_t g_version_model_path = 2;
+
 	inline void build(const Geometry_Type type, Renderable* renderable)
 	{	
 		auto model = make_shared<Model>(renderable->GetContext());
@@ -96,11 +105,13 @@ namespace Spartan
 		m_materialDefault		= false;
 		m_castShadows			= true;
 		m_receiveShadows		= true;
+		m_is_occluder			= false;
 
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_materialDefault, bool);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_material, shared_ptr<Material>);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_castShadows, bool);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_receiveShadows, bool);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_is_occluder, bool);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryIndexOffset, uint32_t);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryIndexCount, uint32_t);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryVertexOffset, uint32_t);
@@ -108,7 +119,7 @@ namespace Spartan
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometryName, string);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_model, shared_ptr<Model>);
 		REGISTER_ATTRIBUTE_VALUE_VALUE(m_bounding_box, BoundingBox);
-		REGISTER_ATTRIBUTE_GET_SET(Geometry_Type, GeometrySet, Geometry_Type);
+		REGISTER_ATTRIBUTE_VALUE_VALUE(m_geometry_type, Geometry_Type);
 	}
 
 	//= ICOMPONENT ===============================================================
@@ -122,10 +133,12 @@ namespace Spartan
 		stream->Write(m_geometryVertexCount);
 		stream->Write(m_bounding_box);
 		stream->Write(m_model ? m_model->GetResourceName() : "");
+		stream->Write(m_model ? m_model->GetResourceFilePath() : "");
 
 		// Material
 		stream->Write(m_castShadows);
 		stream->Write(m_receiveShadows);
+		stream->Write(m_is_occluder);
 		stream->Write(m_materialDefault);
 		if (!m_materialDefault)
 		{
@@ -142,9 +155,21 @@ namespace Spartan
 		m_geometryVertexOffset	= stream->ReadAs<uint32_t>();
 		m_geometryVertexCount	= stream->ReadAs<uint32_t>();
 		stream->Read(&m_bounding_box);
+		m_is_dirty = true;
 		string model_name;
+		string model_path;
 		stream->Read(&model_name);
+		if (stream->GetFormatVersion() >= g_version_model_path)
+		{
+			stream->Read(&model_path);
+		}
+
+		// If the model is not loaded (e.g. it was evicted from the cache), load it
 		m_model = m_context->GetSubsystem<ResourceCache>()->GetByName<Model>(model_name);
+		if (!m_model && !model_path.empty())
+		{
+			m_model = m_context->GetSubsystem<ResourceCache>()->Load<Model>(model_path);
+		}
 
 		// If it was a default mesh, we have to reconstruct it
 		if (m_geometry_type != Geometry_Custom) 
@@ -155,6 +180,10 @@ namespace Spartan
 		// Material
 		stream->Read(&m_castShadows);
 		stream->Read(&m_receiveShadows);
+		if (stream->GetFormatVersion() >= g_version_occluder)
+		{
+			stream->Read(&m_is_occluder);
+		}
 		stream->Read(&m_materialDefault);
 		if (m_materialDefault)
 		{
@@ -179,11 +208,20 @@ namespace Spartan
 		m_geometryVertexCount	= vertex_count;
 		m_bounding_box			= bounding_box;
 		m_model					= model->GetSharedPtr();
+		m_is_dirty				= true;
+		MarkDirty();
+
+		// The bounding box changed, let the world refit it
+		if (World* world = GetEntity_PtrRaw()->GetWorld())
+		{
+			world->SpatialMarkMoved(GetEntity_PtrRaw());
+		}
 	}
 
 	void Renderable::GeometrySet(const Geometry_Type type)
 	{
 		m_geometry_type = type;
+		MarkDirty();
 
 		if (type != Geometry_Custom)
 		{
@@ -204,7 +242,7 @@ namespace Spartan
 
 	const BoundingBox& Renderable::GetAabb()
 	{
-        if (m_last_transform != GetTransform()->GetMatrix())
+        if (m_last_transform != GetTransform()->GetVersion())
         {
             m_is_dirty = true;
         }
@@ -212,12 +250,27 @@ namespace Spartan
 		if (m_is_dirty)
 		{
 			m_aabb = m_bounding_box.TransformToAabb(GetTransform()->GetMatrix());
-            m_last_transform = GetTransform()->GetMatrix();
+            m_last_transform = GetTransform()->GetVersion();
+            m_is_dirty = false;
 		}
 
 		return m_aabb;
 	}
 
+    bool Renderable::IsStatic(const uint64_t frame)
+    {
+        static const uint64_t static_frames = 60;
+
+        const uint32_t version = GetTransform()->GetVersion();
+        if (m_static_transform != version)
+        {
+            m_static_transform  = version;
+            m_static_frame      = frame;
+        }
+
+        return frame - m_static_frame >= static_frames;
+    }
+
     //==============================================================================
 
 	//= MATERIAL ===================================================================
@@ -230,6 +283,7 @@ namespace Spartan
 			return;
 		}
 		m_material = material;
+		MarkDirty();
 	}
 
 	shared_ptr<Material> Renderable::MaterialSet(const string& file_path)
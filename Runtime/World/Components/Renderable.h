@@ -58,6 +58,9 @@ namespace Spartan
 		//= ICOMPONENT ===============================
 		void Serialize(FileStream* stream) override;
 		void Deserialize(FileStream* stream) override;
+		// Default geometry and materials are built (shaders and all) when loaded. Otherwise it looks up its model and material
+		// by name (loading the model if it's missing), which relies on the resource cache being safe to use from any thread.
+		bool IsDeserializeThreadSafe() const override { return m_geometry_type == Geometry_Custom && !m_materialDefault; }
 		//============================================
 
 		//= GEOMETRY ==========================================================================================
@@ -80,6 +83,8 @@ namespace Spartan
 		const auto& GeometryName()	const { return m_geometryName; }
 		const auto& GeometryModel() const { return m_model; }
 		const Math::BoundingBox& GetAabb();
+		// Static once the transform stayed the same for a number of frames, the renderer caches the shadows of static casters
+		bool IsStatic(uint64_t frame);
 		//=====================================================================================================
 
 		//= MATERIAL ============================================================
@@ -96,10 +101,12 @@ namespace Spartan
 		//=======================================================================
 
 		//= PROPERTIES ============================================================================
-		void SetCastShadows(const bool cast_shadows)		{ m_castShadows = cast_shadows; }
+		void SetCastShadows(const bool cast_shadows)		{ m_castShadows = cast_shadows; MarkDirty(); }
 		auto GetCastShadows() const							{ return m_castShadows; }
-		void SetReceiveShadows(const bool receive_shadows)	{ m_receiveShadows = receive_shadows; }
+		void SetReceiveShadows(const bool receive_shadows)	{ m_receiveShadows = receive_shadows; MarkDirty(); }
 		auto GetReceiveShadows() const						{ return m_receiveShadows; }
+		void SetOccluder(const bool is_occluder)			{ m_is_occluder = is_occluder; MarkDirty(); }
+		auto IsOccluder() const								{ return m_is_occluder; }
 		//=========================================================================================
 
 	private:
@@ -113,10 +120,13 @@ namespace Spartan
 		Math::BoundingBox m_bounding_box;
 		Math::BoundingBox m_aabb;
         Math::BoundingBox m_oobb;
-        Math::Matrix m_last_transform   = Math::Matrix::Identity;
+        uint32_t m_last_transform       = 0; // the version of the transform that the aabb was computed with
+        uint32_t m_static_transform     = 0; // the version of the transform when it last changed
+        uint64_t m_static_frame         = 0; // the frame when the transform last changed
         bool m_is_dirty                 = true;
         bool m_castShadows              = true;
         bool m_receiveShadows           = true;
+        bool m_is_occluder              = false; // always rasterized into the occlusion buffer when on screen
 		bool m_materialDefault;
         std::shared_ptr<Material> m_material;
 	};
@@ -176,6 +176,7 @@ namespace Spartan
 		if (mass != m_mass)
 		{
 			m_mass = mass;
+			MarkDirty();
 			Body_AddToWorld();
 		}
 	}
@@ -186,6 +187,7 @@ namespace Spartan
 			return;
 
 		m_friction = friction;
+		MarkDirty();
 		m_rigidBody->setFriction(friction);
 	}
 
@@ -195,6 +197,7 @@ namespace Spartan
 			return;
 
 		m_frictionRolling = frictionRolling;
+		MarkDirty();
 		m_rigidBody->setRollingFriction(frictionRolling);
 	}
 
@@ -204,6 +207,7 @@ namespace Spartan
 			return;
 
 		m_restitution = restitution;
+		MarkDirty();
 		m_rigidBody->setRestitution(restitution);
 	}
 
@@ -213,6 +217,7 @@ namespace Spartan
 			return;
 
 		m_useGravity = gravity;
+		MarkDirty();
 		Body_AddToWorld();
 	}
 
@@ -222,6 +227,7 @@ namespace Spartan
 			return;
 
 		m_gravity = acceleration;
+		MarkDirty();
 		Body_AddToWorld();
 	}
 
@@ -231,6 +237,7 @@ namespace Spartan
 			return;
 
 		m_isKinematic = kinematic;
+		MarkDirty();
 		Body_AddToWorld();
 	}
 
@@ -329,6 +336,7 @@ namespace Spartan
 			return;
 
 		m_positionLock = lock;
+		MarkDirty();
 		Vector3 linearFactor = Vector3(!lock.x, !lock.y, !lock.z);
 		m_rigidBody->setLinearFactor(ToBtVector3(linearFactor));
 	}
@@ -351,6 +359,7 @@ namespace Spartan
 			return;
 
 		m_rotationLock = lock;
+		MarkDirty();
 		Vector3 angularFactor = Vector3(!lock.x, !lock.y, !lock.z);
 		m_rigidBody->setAngularFactor(ToBtVector3(angularFactor));
 	}
@@ -359,6 +368,7 @@ namespace Spartan
 	void RigidBody::SetCenterOfMass(const Vector3& centerOfMass)
 	{
 		m_centerOfMass = centerOfMass;
+		MarkDirty();
 		SetPosition(GetPosition());
 	}
 	//================================================================
@@ -87,6 +87,7 @@ namespace Spartan
 		// Instantiate the script
 		m_scriptInstance = make_shared<ScriptInstance>();
 		m_scriptInstance->Instantiate(filePath, GetEntity_PtrWeak(), GetContext()->GetSubsystem<Scripting>());
+		MarkDirty();
 
 		// Check if the script has been instantiated successfully.
 		if (!m_scriptInstance->IsInstantiated())
@@ -20,6 +20,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 //= INCLUDES ============================
+#include <algorithm>
 #include "Transform.h"
 #include "../World.h"
 #include "../Entity.h"
@@ -103,6 +104,13 @@ namespace Spartan
 		{
 			m_matrix = m_matrixLocal * GetParentTransformMatrix();
 		}
+		m_version++;
+
+		// Let the world refit the bounding box
+		if (World* world = m_entity->GetWorld())
+		{
+			world->SpatialMarkMoved(m_entity);
+		}
 		
 		// Update children
 		for (const auto& child : m_children)
@@ -127,6 +135,7 @@ namespace Spartan
 
 		m_positionLocal = position;
 		UpdateTransform();
+		MarkDirty();
 	}
 	//================================================================================================
 
@@ -146,6 +155,7 @@ namespace Spartan
 
 		m_rotationLocal = rotation;
 		UpdateTransform();
+		MarkDirty();
 	}
 	//================================================================================================
 
@@ -172,6 +182,7 @@ namespace Spartan
 		m_scaleLocal.z = (m_scaleLocal.z == 0.0f) ? M_EPSILON : m_scaleLocal.z;
 
 		UpdateTransform();
+		MarkDirty();
 	}
 	//================================================================================================
 
@@ -291,6 +302,11 @@ namespace Spartan
 		}
 
 		UpdateTransform();
+
+		// The hierarchies this left and joined have to be saved again
+		MarkDirty();
+		m_parent->MarkDirty();
+		if (parent_old) parent_old->MarkDirty();
 	}
 
 	void Transform::AddChild(Transform* child)
@@ -304,6 +320,34 @@ namespace Spartan
 		child->SetParent(this);
 	}
 
+	// Forgets about a child without searching the entire hierarchy (unlike AcquireChildren)
+	void Transform::RemoveChild(Transform* child)
+	{
+		if (!child)
+			return;
+
+		m_children.erase(remove(m_children.begin(), m_children.end(), child), m_children.end());
+		if (child->m_parent == this)
+		{
+			child->m_parent = nullptr;
+		}
+		MarkDirty();
+	}
+
+	// Links an orphan child without searching the entire hierarchy (used when building new hierarchies in bulk)
+	void Transform::AppendChild(Transform* child)
+	{
+		if (!child || child == this || child->HasParent())
+			return;
+
+		child->m_parent = this;
+		m_children.emplace_back(child);
+
+		// The hierarchy this joined has to be saved again
+		MarkDirty();
+		child->MarkDirty();
+	}
+
 	// Returns a child with the given index
 	Transform* Transform::GetChildByIndex(const uint32_t index)
 	{
@@ -390,7 +434,7 @@ namespace Spartan
 		}
 	}
 
-	void Transform::UpdateConstantBuffer(const shared_ptr<RHI_Device>& rhi_device, const Matrix& view_projection)
+	void Transform::UpdateConstantBuffer(const shared_ptr<RHI_Device>& rhi_device, const Matrix& model, const Matrix& view_projection)
 	{
 		// Has to match GBuffer.hlsl
 		if (!m_cb_gbuffer_gpu)
@@ -399,11 +443,11 @@ namespace Spartan
 			m_cb_gbuffer_gpu->Create<CB_Gbuffer>();
 		}
 
-		const auto mvp_current = m_matrix * view_projection;
+		const auto mvp_current = model * view_projection;
 	
 		// Determine if the buffer needs to update
 		auto update	= false;
-		update						= m_cb_gbuffer_cpu.model		!= m_matrix	? true : update;
+		update						= m_cb_gbuffer_cpu.model		!= model	? true : update;
 		const auto new_input		= m_cb_gbuffer_cpu.mvp_current	!= mvp_current;
 		const auto non_zero_delta	= m_cb_gbuffer_cpu.mvp_current	!= m_cb_gbuffer_cpu.mvp_previous;
 		update = new_input || non_zero_delta ? true : update;
@@ -413,7 +457,7 @@ namespace Spartan
 		// Update buffer
 		auto buffer = static_cast<CB_Gbuffer*>(m_cb_gbuffer_gpu->Map());
 
-		buffer->model			= m_cb_gbuffer_cpu.model		= m_matrix;
+		buffer->model			= m_cb_gbuffer_cpu.model		= model;
 		buffer->mvp_current		= m_cb_gbuffer_cpu.mvp_current	= mvp_current;
 		buffer->mvp_previous	= m_cb_gbuffer_cpu.mvp_previous	= m_wvp_previous;
 
@@ -422,7 +466,7 @@ namespace Spartan
 		m_wvp_previous = mvp_current;
 	}
 
-	void Transform::UpdateConstantBufferLight(const shared_ptr<RHI_Device>& rhi_device, const Matrix& view_projection, const uint32_t cascade_index)
+	void Transform::UpdateConstantBufferLight(const shared_ptr<RHI_Device>& rhi_device, const Matrix& model, const Matrix& view_projection, const uint32_t cascade_index)
 	{
 		// Add cascade if needed
 		if (cascade_index >= static_cast<uint32_t>(m_light_cascades.size()))
@@ -443,7 +487,7 @@ namespace Spartan
 		auto& cb_light = m_light_cascades[cascade_index];
 
 		// Determine if the buffer needs to update
-		auto mvp = m_matrix * view_projection;
+		auto mvp = model * view_projection;
 		if (cb_light.data == mvp)
 			return;
 
@@ -485,6 +529,8 @@ namespace Spartan
 
 		// Update the transform without the parent now
 		UpdateTransform();
+		MarkDirty();
+		temp_ref->MarkDirty();
 
 		// make the parent search for children,
 		// that's indirect way of making the parent "forget"
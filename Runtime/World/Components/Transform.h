@@ -45,6 +45,7 @@ namespace Spartan
 		void OnInitialize() override;
 		void Serialize(FileStream* stream) override;
 		void Deserialize(FileStream* stream) override;
+		bool IsDeserializeThreadSafe() const override { return true; }
 		//============================================
 
 		void UpdateTransform();
@@ -92,6 +93,8 @@ namespace Spartan
 		bool HasChildren() const			{ return GetChildrenCount() > 0 ? true : false; }
 		uint32_t GetChildrenCount() const	{ return static_cast<uint32_t>(m_children.size()); }
 		void AddChild(Transform* child);
+		void RemoveChild(Transform* child);
+		void AppendChild(Transform* child);
 		Transform* GetRoot()			{ return HasParent() ? GetParent()->GetRoot() : this; }
 		Transform* GetParent() const	{ return m_parent; }
 		Transform* GetChildByIndex(uint32_t index);
@@ -103,14 +106,17 @@ namespace Spartan
 		void GetDescendants(std::vector<Transform*>* descendants);
 		//======================================================================================
 
-		void LookAt(const Math::Vector3& v) { m_lookAt = v; }
+		void LookAt(const Math::Vector3& v) { m_lookAt = v; MarkDirty(); }
 		auto& GetMatrix()		{ return m_matrix; }
 		auto& GetLocalMatrix()	{ return m_matrixLocal; }
 
+		// Increases every time the world matrix is recomputed, so dependants can cheaply tell if it changed
+		uint32_t GetVersion() const { return m_version; }
+
 		//= CONSTANT BUFFERS ======================================================================================================================
-		void UpdateConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const Math::Matrix& view_projection);
+		void UpdateConstantBuffer(const std::shared_ptr<RHI_Device>& rhi_device, const Math::Matrix& model, const Math::Matrix& view_projection);
 		const auto& GetConstantBuffer() const { return m_cb_gbuffer_gpu; }
-		void UpdateConstantBufferLight(const std::shared_ptr<RHI_Device>& rhi_device, const Math::Matrix& view_projection, uint32_t cascade_index);
+		void UpdateConstantBufferLight(const std::shared_ptr<RHI_Device>& rhi_device, const Math::Matrix& model, const Math::Matrix& view_projection, uint32_t cascade_index);
         const std::shared_ptr<RHI_ConstantBuffer>& GetConstantBufferLight(const uint32_t cascade_index);
 		//=========================================================================================================================================
 
@@ -125,6 +131,7 @@ namespace Spartan
 		Math::Matrix m_matrix;
 		Math::Matrix m_matrixLocal;
 		Math::Vector3 m_lookAt;
+		uint32_t m_version = 0;
 
 		Transform* m_parent; // the parent of this transform
 		std::vector<Transform*> m_children; // the children of this transform
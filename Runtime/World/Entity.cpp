@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =================================
 #include "Entity.h"
 #include "World.h"
+#include "Prefab.h"
 #include "../IO/FileStream.h"
 #include "../Core/Context.h"
 #include "../World/Components/Camera.h"
@@ -70,51 +71,8 @@ namespace Spartan
 
 	void Entity::Clone()
 	{
-		auto scene = m_context->GetSubsystem<World>();
-		vector<Entity*> clones;
-
-		// Creation of new entity and copying of a few properties
-		auto clone_entity = [&scene, &clones](Entity* entity)
-		{
-			// Clone the name and the ID
-			auto clone = scene->EntityCreate().get();
-			clone->SetId(GenerateId());
-			clone->SetName(entity->GetName());
-			clone->SetActive(entity->IsActive());
-			clone->SetHierarchyVisibility(entity->IsVisibleInHierarchy());
-
-			// Clone all the components
-			for (const auto& component : entity->GetAllComponents())
-			{
-				const auto& original_comp	= component;
-				auto clone_comp				= clone->AddComponent(component->GetType());
-				clone_comp->SetAttributes(original_comp->GetAttributes());
-			}
-
-			clones.emplace_back(clone);
-
-			return clone;
-		};
-
-		// Cloning of an entity and it's descendants (this is a recursive lambda)
-		function<Entity*(Entity*)> clone_entity_and_descendants = [&clone_entity_and_descendants, &clone_entity](Entity* original)
-		{
-			// clone self
-			const auto clone_self = clone_entity(original);
-
-			// clone children make them call this lambda
-			for (const auto& child_transform : original->GetTransform_PtrRaw()->GetChildren())
-			{
-				const auto clone_child = clone_entity_and_descendants(child_transform->GetEntity_PtrRaw());
-				clone_child->GetTransform_PtrRaw()->SetParent(clone_self->GetTransform_PtrRaw());
-			}
-
-			// return self
-			return clone_self;
-		};
-
-		// Clone the entire hierarchy
-		clone_entity_and_descendants(this);
+		// Capture this entity and it's descendants once, then instantiate them as a new hierarchy
+		m_context->GetSubsystem<World>()->EntityInstantiate(Prefab(this));
 	}
 
 	void Entity::Start()
@@ -147,6 +105,25 @@ namespace Spartan
 		}
 	}
 
+	bool Entity::Tick(float delta_time, uint32_t update_interval, uint64_t frame)
+	{
+		if (!m_is_active)
+			return false;
+
+		m_update_interval		= update_interval;
+		m_update_delta_time		+= delta_time;
+
+		// Offset by the id, so that entities of the same tier are spread evenly across frames
+		if (update_interval > 1 && ((frame + GetId()) % update_interval) != 0)
+			return false;
+
+		// Tick with the time that passed since the last tick
+		Tick(m_update_delta_time);
+		m_update_delta_time = 0.0f;
+
+		return true;
+	}
+
 	void Entity::Serialize(FileStream* stream)
 	{
         // BASIC DATA
@@ -271,6 +248,58 @@ namespace Spartan
 		FIRE_EVENT(Event_World_Resolve_Pending);
 	}
 
+	void Entity::Deserialize(FileStream* stream, Transform* parent, vector<shared_ptr<Entity>>* entities)
+	{
+        // BASIC DATA
+        {
+            stream->Read(&m_is_active);
+            stream->Read(&m_hierarchy_visibility);
+            stream->Read(&m_id);
+            stream->Read(&m_name);
+        }
+
+        // COMPONENTS
+        {
+            const auto component_count = stream->ReadAs<uint32_t>();
+            for (uint32_t i = 0; i < component_count; i++)
+            {
+                const auto type = stream->ReadAs<uint32_t>();
+                const auto id   = stream->ReadAs<uint32_t>();
+                AddComponent(static_cast<ComponentType>(type), id);
+            }
+
+            // The parent is complete, so link to it directly (instead of searching the world for it)
+            // before deserializing, this way the components see their final world transform.
+            if (parent)
+            {
+                parent->AppendChild(m_transform);
+            }
+
+            for (const auto& component : m_components)
+            {
+                component->Deserialize(stream);
+            }
+        }
+
+        // CHILDREN
+        {
+            const auto children_count   = stream->ReadAs<uint32_t>();
+            const auto children_first   = entities->size();
+            for (uint32_t i = 0; i < children_count; i++)
+            {
+                auto& child = entities->emplace_back(make_shared<Entity>(m_context));
+                child->SetId(stream->ReadAs<uint32_t>());
+            }
+
+            for (uint32_t i = 0; i < children_count; i++)
+            {
+                // Children append their own descendants, so hold on to the child rather than the vector element
+                const auto child = (*entities)[children_first + i];
+                child->Deserialize(stream, m_transform, entities);
+            }
+        }
+	}
+
     shared_ptr<IComponent> Entity::AddComponent(const ComponentType type, uint32_t id /*= 0*/)
     {
         // This is the only hardcoded part regarding components. It's 
@@ -303,6 +332,7 @@ namespace Spartan
 			auto component = *it;
 			if (id == component->GetId())
 			{
+				if (component.get() == m_renderable) { m_renderable = nullptr; }
 				component->OnRemove();
 				component.reset();
 				it = m_components.erase(it);
@@ -313,7 +343,35 @@ namespace Spartan
 			}
 		}
 
-		// Make the scene resolve
-		FIRE_EVENT(Event_World_Resolve_Pending);
+        // Rebuild the mask from the remaining components (some types, like scripts, can exist more than once)
+        const uint32_t component_mask_old = m_component_mask;
+        m_component_mask = 0;
+        for (const auto& component : m_components)
+        {
+            m_component_mask |= GetComponentMask(component->GetType());
+        }
+        OnComponentsChanged(component_mask_old);
 	}
+
+    void Entity::OnComponentsChanged(const uint32_t component_mask_old)
+    {
+        // Entities which are not part of a world yet (e.g. while being instantiated in bulk) notify
+        // nobody, the world takes care of that once when they get added to it.
+        if (!m_world)
+            return;
+
+        m_world->QueryUpdate(this, component_mask_old, m_component_mask);
+        MarkDirty();
+
+        // Make the world resolve
+        FIRE_EVENT(Event_World_Resolve_Pending);
+    }
+
+    void Entity::MarkDirty()
+    {
+        if (m_world)
+        {
+            m_world->ChunkMarkDirty(m_save_chunk);
+        }
+    }
 }
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <vector>
+#include <limits>
 #include "../Core/EventSystem.h"
 #include "Components/IComponent.h"
 //================================
@@ -30,6 +31,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Spartan
 {
 	class Context;
+	class World;
 	class Transform;
 	class Renderable;
 	
@@ -43,18 +45,23 @@ namespace Spartan
 		void Start();
 		void Stop();
 		void Tick(float delta_time);
+		bool Tick(float delta_time, uint32_t update_interval, uint64_t frame);
 		void Serialize(FileStream* stream);
 		void Deserialize(FileStream* stream, Transform* parent);
 
+		// Deserializes an entity which isn't part of a world, it's descendants are created alongside it and
+		// appended to entities. Nothing else is touched, so separate hierarchies can be deserialized in parallel.
+		void Deserialize(FileStream* stream, Transform* parent, std::vector<std::shared_ptr<Entity>>* entities);
+
 		//= PROPERTIES ===================================================================================================
 		const std::string& GetName() const								{ return m_name; }
-		void SetName(const std::string& name)							{ m_name = name; }
+		void SetName(const std::string& name)							{ m_name = name; MarkDirty(); }
 
 		bool IsActive() const											{ return m_is_active; }
-		void SetActive(const bool active)								{ m_is_active = active; }
+		void SetActive(const bool active)								{ m_is_active = active; m_update_delta_time = 0.0f; MarkDirty(); }
 
 		bool IsVisibleInHierarchy() const								{ return m_hierarchy_visibility; }
-		void SetHierarchyVisibility(const bool hierarchy_visibility)	{ m_hierarchy_visibility = hierarchy_visibility; }
+		void SetHierarchyVisibility(const bool hierarchy_visibility)	{ m_hierarchy_visibility = hierarchy_visibility; MarkDirty(); }
 		//================================================================================================================
 
 		// Adds a component of type T
@@ -71,6 +78,7 @@ namespace Spartan
             std::shared_ptr<T> component = std::make_shared<T>(m_context, this, id);
 
             // Save new component
+            const uint32_t component_mask_old = m_component_mask;
             m_components.emplace_back(std::static_pointer_cast<IComponent>(component));
             m_component_mask |= GetComponentMask(type);
 
@@ -82,8 +90,8 @@ namespace Spartan
             component->SetType(type);
             component->OnInitialize();
 
-			// Make the scene resolve
-			FIRE_EVENT(Event_World_Resolve_Pending);
+            // Keep world queries up to date and make the world resolve
+            OnComponentsChanged(component_mask_old);
 
             return component;
 		}
@@ -141,7 +149,8 @@ namespace Spartan
 		template <class T>
 		void RemoveComponent()
 		{
-			const ComponentType type = IComponent::TypeToEnum<T>();
+			const ComponentType type            = IComponent::TypeToEnum<T>();
+            const uint32_t component_mask_old   = m_component_mask;
 
 			for (auto it = m_components.begin(); it != m_components.end();)
 			{
@@ -152,6 +161,7 @@ namespace Spartan
 					component.reset();
 					it = m_components.erase(it);
                     m_component_mask &= ~GetComponentMask(type);
+                    if (type == ComponentType_Renderable) { m_renderable = nullptr; }
 				}
 				else
 				{
@@ -159,8 +169,8 @@ namespace Spartan
 				}
 			}
 
-			// Make the scene resolve
-			FIRE_EVENT(Event_World_Resolve_Pending);
+            // Keep world queries up to date and make the world resolve
+            OnComponentsChanged(component_mask_old);
 		}
 
 		void RemoveComponentById(uint32_t id);
@@ -171,8 +181,25 @@ namespace Spartan
 		Renderable* GetRenderable_PtrRaw() const	{ return m_renderable; }
 		std::shared_ptr<Entity> GetPtrShared()		{ return shared_from_this(); }
 
+        // The components this entity has, as a bit mask of component types
+        uint32_t GetComponentMask() const { return m_component_mask; }
+
+        // Set by the world when the entity is added to it (or removed from it)
+        World* GetWorld() const     { return m_world; }
+        void SetWorld(World* world) { m_world = world; }
+
+        // How many frames pass between two ticks of this entity, it's assigned by the world's update LOD
+        uint32_t GetUpdateInterval() const { return m_update_interval; }
+
+        // Flags the entity as changed since the world was last saved, so that incremental saves rewrite the
+        // chunk of the world file it was saved in. Components call it when their saved state changes.
+        void MarkDirty();
+        uint32_t GetSaveChunk() const               { return m_save_chunk; }
+        void SetSaveChunk(const uint32_t chunk)     { m_save_chunk = chunk; }
+
 	private:
         uint32_t GetComponentMask(ComponentType type) { return 1 << static_cast<uint32_t>(type); }
+        void OnComponentsChanged(uint32_t component_mask_old);
 
 		std::string m_name			= "Entity";
 		bool m_is_active			= true;
@@ -180,6 +207,14 @@ namespace Spartan
 		Transform* m_transform		= nullptr;
 		Renderable* m_renderable	= nullptr;
         Context* m_context          = nullptr;
+        World* m_world              = nullptr;
+
+        // Update LOD
+        uint32_t m_update_interval      = 1;
+        float m_update_delta_time       = 0.0f; // accumulated while ticks are skipped
+
+        // The chunk of the world file this entity was last saved in (or loaded from)
+        uint32_t m_save_chunk = std::numeric_limits<uint32_t>::max();
 		
         // Components
         std::vector<std::shared_ptr<IComponent>> m_components;
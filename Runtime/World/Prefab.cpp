@@ -0,0 +1,128 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "Prefab.h"
+#include "Entity.h"
+#include "Components/Transform.h"
+//=================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+	void Prefab::Capture(Entity* root)
+	{
+		m_nodes.clear();
+
+		if (!root)
+			return;
+
+		CaptureNode(root, -1);
+	}
+
+	void Prefab::Apply(const uint32_t node_index, Entity* entity) const
+	{
+		if (!entity || node_index >= GetNodeCount())
+			return;
+
+		const auto& node = m_nodes[node_index];
+
+		entity->SetName(node.name);
+		entity->SetActive(node.is_active);
+		entity->SetHierarchyVisibility(node.hierarchy_visibility);
+
+		for (const auto& component : node.components)
+		{
+			// The transform always exists, so this will return it instead of adding a second one
+			auto component_new = entity->AddComponent(component.type);
+			if (!component_new)
+				continue;
+
+			// Trivially copyable attributes come straight out of the blob, the rest out of their own copies
+			const auto& attributes	= component_new->GetAttributes();
+			size_t data_offset		= 0;
+			uint32_t value_index	= 0;
+			for (uint32_t i = 0; i < static_cast<uint32_t>(attributes.size()); i++)
+			{
+				const auto& attribute = attributes[i];
+				if (attribute.is_trivial)
+				{
+					if (data_offset + attribute.size > component.data.size())
+						break;
+
+					component_new->SetAttributeValue(i, &component.data[data_offset]);
+					data_offset += attribute.size;
+				}
+				else
+				{
+					if (value_index >= static_cast<uint32_t>(component.values.size()))
+						break;
+
+					component_new->SetAttributeValue(i, component.values[value_index++].get());
+				}
+			}
+		}
+	}
+
+	void Prefab::CaptureNode(Entity* entity, const int32_t parent_index)
+	{
+		const auto node_index = static_cast<int32_t>(m_nodes.size());
+
+		// Basic data
+		{
+			auto& node					= m_nodes.emplace_back();
+			node.name					= entity->GetName();
+			node.is_active				= entity->IsActive();
+			node.hierarchy_visibility	= entity->IsVisibleInHierarchy();
+			node.parent_index			= parent_index;
+		}
+
+		// Components
+		for (const auto& component : entity->GetAllComponents())
+		{
+			Component captured;
+			captured.type = component->GetType();
+			for (const auto& attribute : component->GetAttributes())
+			{
+				const void* value = component->GetAttributeValue(attribute);
+				if (attribute.is_trivial)
+				{
+					const auto bytes = static_cast<const std::byte*>(value);
+					captured.data.insert(captured.data.end(), bytes, bytes + attribute.size);
+				}
+				else
+				{
+					captured.values.emplace_back(attribute.clone(value));
+				}
+			}
+			m_nodes[node_index].components.emplace_back(move(captured));
+		}
+
+		// Children (depth first, so that parents always precede their children)
+		for (const auto& child : entity->GetTransform_PtrRaw()->GetChildren())
+		{
+			CaptureNode(child->GetEntity_PtrRaw(), node_index);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+#include "../Core/EngineDefs.h"
+#include "Components/IComponent.h"
+//=================================
+
+namespace Spartan
+{
+	class Entity;
+
+	// A compact, world independent snapshot of an entity hierarchy which can be instantiated many times
+	class SPARTAN_CLASS Prefab
+	{
+	public:
+		struct Component
+		{
+			ComponentType type = ComponentType_Unknown;
+			std::vector<std::byte> data;				// Trivially copyable attributes, packed in registration order
+			std::vector<std::shared_ptr<void>> values;	// Any other attributes, in registration order
+		};
+
+		struct Node
+		{
+			std::string name;
+			bool is_active				= true;
+			bool hierarchy_visibility	= true;
+			int32_t parent_index		= -1; // index into the nodes, parents always precede their children
+			std::vector<Component> components;
+		};
+
+		Prefab() = default;
+		Prefab(Entity* root) { Capture(root); }
+		~Prefab() = default;
+
+		// Captures an entity and all of it's descendants
+		void Capture(Entity* root);
+
+		// Copies the captured state of a node into an entity
+		void Apply(uint32_t node_index, Entity* entity) const;
+
+		const auto& GetNodes() const	{ return m_nodes; }
+		auto GetNodeCount() const		{ return static_cast<uint32_t>(m_nodes.size()); }
+		bool IsEmpty() const			{ return m_nodes.empty(); }
+
+	private:
+		void CaptureNode(Entity* entity, int32_t parent_index);
+
+		std::vector<Node> m_nodes;
+	};
+}
@@ -20,11 +20,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 //= INCLUDES ==========================
+#include <algorithm>
 #include "World.h"
 #include "Entity.h"
+#include "Prefab.h"
+#include "WorldSnapshot.h"
+#include "WorldStreaming.h"
 #include "Components/Transform.h"
 #include "Components/Camera.h"
 #include "Components/Light.h"
+#include "Components/Renderable.h"
 #include "Components/Script.h"
 #include "Components/Environment.h"
 #include "Components/AudioListener.h"
@@ -35,7 +40,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../IO/FileStream.h"
 #include "../Profiling/Profiler.h"
 #include "../Rendering/Renderer.h"
+#include "../Rendering/Material.h"
 #include "../Input/Input.h"
+#include "../Math/AabbTree.h"
+#include "../Threading/Threading.h"
 //=====================================
 
 //= NAMESPACES ================
@@ -45,12 +53,134 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	// World files start with a header, followed by chunks of root hierarchies, the chunk table and a footer
+	// which points to the table. Chunks are self contained, so they can be located and decoded independently.
+	static const uint32_t g_world_file_magic			= 0x444C5753; // "SWLD"
+	static const uint32_t g_world_file_version			= 2; // 2: renderables store the file path of their model
+	static const uint32_t g_world_chunk_entity_count	= 512; // Roots are grouped until a chunk has at least this many entities
+
+	struct WorldChunk
+	{
+		uint64_t offset			= 0;
+		uint64_t size			= 0;
+		uint32_t root_count		= 0;
+		uint32_t entity_count	= 0;
+		bool parallel			= true; // Whether all of it's components can be deserialized outside of the world, in parallel
+		bool dirty				= false; // Some of it's entities changed since it was written (not saved)
+	};
+
+	static void ChunkCount(Entity* entity, uint32_t* entity_count, bool* parallel)
+	{
+		(*entity_count)++;
+
+		for (const auto& component : entity->GetAllComponents())
+		{
+			*parallel = *parallel && component->IsDeserializeThreadSafe();
+		}
+
+		for (const auto& child : entity->GetTransform_PtrRaw()->GetChildren())
+		{
+			if (child->GetEntity_PtrRaw())
+			{
+				ChunkCount(child->GetEntity_PtrRaw(), entity_count, parallel);
+			}
+		}
+	}
+
+	static void ChunkAssign(Entity* entity, const uint32_t chunk)
+	{
+		entity->SetSaveChunk(chunk);
+
+		for (const auto& child : entity->GetTransform_PtrRaw()->GetChildren())
+		{
+			if (child->GetEntity_PtrRaw())
+			{
+				ChunkAssign(child->GetEntity_PtrRaw(), chunk);
+			}
+		}
+	}
+
+	// Appends chunks for the roots, consecutive roots are grouped as long as they can all (or none of them) be loaded in parallel
+	static void ChunkAppend(FileStream* file, const vector<shared_ptr<Entity>>& roots, vector<WorldChunk>* chunks)
+	{
+		const auto chunk_first = chunks->size();
+
+		for (const auto& root : roots)
+		{
+			uint32_t entity_count	= 0;
+			bool parallel			= true;
+			ChunkCount(root.get(), &entity_count, &parallel);
+
+			if (chunks->size() == chunk_first || chunks->back().entity_count >= g_world_chunk_entity_count || chunks->back().parallel != parallel)
+			{
+				if (chunks->size() != chunk_first)
+				{
+					chunks->back().size = file->GetPosition() - chunks->back().offset;
+				}
+
+				auto& chunk		= chunks->emplace_back();
+				chunk.offset	= file->GetPosition();
+				chunk.parallel	= parallel;
+			}
+
+			ChunkAssign(root.get(), static_cast<uint32_t>(chunks->size() - 1));
+			root->Serialize(file);
+			chunks->back().root_count++;
+			chunks->back().entity_count += entity_count;
+			ProgressReport::Get().IncrementJobsDone(g_progress_world);
+		}
+
+		if (chunks->size() != chunk_first)
+		{
+			chunks->back().size = file->GetPosition() - chunks->back().offset;
+		}
+	}
+
+	// Writes the chunk table (chunks which lost all of their roots are left out) and the footer which points to it
+	static void ChunkTableWrite(FileStream* file, const vector<WorldChunk>& chunks)
+	{
+		const auto table_offset = file->GetPosition();
+
+		const auto count = count_if(chunks.begin(), chunks.end(), [](const WorldChunk& chunk) { return chunk.root_count != 0; });
+		file->Write(static_cast<uint32_t>(count));
+		for (const auto& chunk : chunks)
+		{
+			if (chunk.root_count == 0)
+				continue;
+
+			file->Write(chunk.offset);
+			file->Write(chunk.size);
+			file->Write(chunk.root_count);
+			file->Write(chunk.entity_count);
+			file->Write(chunk.parallel);
+		}
+
+		file->Write(table_offset);
+	}
+
+	static void ChunkDecode(Context* context, FileStream* stream, const WorldChunk& chunk, vector<shared_ptr<Entity>>* entities)
+	{
+		stream->Seek(chunk.offset);
+		entities->reserve(chunk.entity_count);
+
+		for (uint32_t i = 0; i < chunk.root_count; i++)
+		{
+			const auto root = make_shared<Entity>(context);
+			entities->emplace_back(root);
+			root->Deserialize(stream, nullptr, entities);
+		}
+	}
+
 	World::World(Context* context) : ISubsystem(context)
 	{
 		// Subscribe to events
 		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Pending, [this](Variant) { m_is_dirty = true; });
-		SUBSCRIBE_TO_EVENT(Event_World_Stop,	        [this](Variant)	{ m_state = Idle; });
-		SUBSCRIBE_TO_EVENT(Event_World_Start,	        [this](Variant)	{ m_state = Ticking; });
+		SUBSCRIBE_TO_EVENT(Event_World_Stop,	        [this](Variant)	{ if (m_state == Ticking) m_state = Idle; });
+		SUBSCRIBE_TO_EVENT(Event_World_Start,	        [this](Variant)	{ if (m_state == Idle) m_state = Ticking; });
+
+		m_snapshots[0] = make_shared<WorldSnapshot>();
+		m_snapshots[1] = make_shared<WorldSnapshot>();
+		m_spatial_tree = make_unique<AabbTree>();
 	}
 
 	World::~World()
@@ -62,6 +192,7 @@ namespace Spartan
 	{
 		m_input		= m_context->GetSubsystem<Input>().get();
 		m_profiler	= m_context->GetSubsystem<Profiler>().get();
+		m_streaming	= make_unique<WorldStreaming>(m_context, this);
 
 		CreateCamera();
 		CreateEnvironment();
@@ -74,10 +205,40 @@ namespace Spartan
 	{	
 		if (m_state == Request_Loading)
 		{
-			m_state = Loading;
+			{
+				lock_guard<mutex> lock(m_state_mutex);
+				m_state = Loading;
+			}
+			m_state_condition.notify_all();
 			return;
 		}
 
+		// Saves requested by other threads are captured here, between two ticks (and not while a world is loading).
+		// While the I/O thread is still writing the previous save of the file, the capture is left for a later tick.
+		m_tick_thread = this_thread::get_id();
+		if (m_save_requested && m_state != Loading)
+		{
+			string save_path;
+			bool save_incremental;
+			{
+				lock_guard<mutex> lock(m_state_mutex);
+				save_path			= m_save_path;
+				save_incremental	= m_save_incremental;
+			}
+
+			if (!FileStream::IsWritePending(save_path))
+			{
+				const auto result = SaveCapture(save_path, save_incremental);
+
+				{
+					lock_guard<mutex> lock(m_state_mutex);
+					m_save_result		= result;
+					m_save_requested	= false;
+				}
+				m_state_condition.notify_all();
+			}
+		}
+
 		if (m_state != Ticking)
 			return;
 
@@ -108,10 +269,44 @@ namespace Spartan
 				}
 			}
 
+			// Find the camera that the update LOD and the streaming are relative to
+			Camera* camera = nullptr;
+			for (Entity* entity : Query<Camera>())
+			{
+				if (entity->IsActive())
+				{
+					camera = entity->GetComponent<Camera>().get();
+					break;
+				}
+			}
+			const Vector3 camera_position = camera ? camera->GetTransform()->GetPosition() : Vector3::Zero;
+
 			// Tick
+			uint32_t ticked		= 0;
+			uint32_t skipped	= 0;
+			const uint64_t frame = m_update_lod_frame++;
 			for (const auto& entity : m_entities)
 			{
-				entity->Tick(delta_time);
+				if (!entity->IsActive())
+					continue;
+
+				const uint32_t interval = (m_update_lod_enabled && camera) ? GetUpdateInterval(entity.get(), camera_position, camera) : 1;
+				entity->Tick(delta_time, interval, frame) ? ticked++ : skipped++;
+			}
+
+			if (m_profiler)
+			{
+				m_profiler->m_world_entities_ticked		= ticked;
+				m_profiler->m_world_entities_skipped	= skipped;
+			}
+
+			// Keep the spatial tree in sync with the renderables that moved
+			SpatialRefit();
+
+			// Stream cells in and out around the camera
+			if (camera)
+			{
+				m_streaming->Tick(camera_position);
 			}
 		}
 
@@ -123,6 +318,9 @@ namespace Spartan
 			FIRE_EVENT_DATA(Event_World_Resolve_Complete, m_entities);
             m_is_dirty = false;
 		}
+
+		// Hand the simulated state over to the renderer
+		SnapshotExtract();
 	}
 
 	void World::Unload()
@@ -130,69 +328,241 @@ namespace Spartan
         // Notify any systems that the entities are about to be cleared
 		FIRE_EVENT(Event_World_Unload);
 
+        if (m_streaming)
+        {
+            m_streaming->Clear();
+        }
+
+        QueryClear();
+        m_spatial_tree->Clear();
+        m_spatial_proxies.clear();
+        m_spatial_moved.clear();
+        for (const auto& entity : m_entities)
+        {
+            entity->SetWorld(nullptr);
+        }
         m_entities.clear();
         m_entities.shrink_to_fit();
+        m_chunks.clear();
+        m_chunks_file_path.clear();
+        m_chunks_file_size = 0;
+
+		// Publish empty snapshots so the renderer lets go of the old world
+		{
+			lock_guard<mutex> lock(m_snapshot_mutex);
+			m_snapshots[0] = make_shared<WorldSnapshot>();
+			m_snapshots[1] = make_shared<WorldSnapshot>();
+		}
 
 		m_is_dirty = true;
 	}
 
-	bool World::SaveToFile(const string& filePathIn)
+	bool World::SaveToFile(const string& filePathIn, const bool incremental /*= false*/)
 	{
-		// Start progress report and timer
-		ProgressReport::Get().Reset(g_progress_world);
-		ProgressReport::Get().SetIsLoading(g_progress_world, true);
-		ProgressReport::Get().SetStatus(g_progress_world, "Saving world...");
-		Stopwatch timer;
-	
 		// Add scene file extension to the filepath if it's missing
 		auto file_path = filePathIn;
 		if (FileSystem::GetExtensionFromFilePath(file_path) != EXTENSION_WORLD)
 		{
 			file_path += EXTENSION_WORLD;
 		}
+
+		// Thread safety: The entities can only be read between two ticks. On the ticking thread (or before the
+		// world ever ticked) that's now, any other thread hands the capture over to the next tick and waits for it.
+		if (m_tick_thread.load() == thread::id())
+			return SaveCapture(file_path, incremental);
+
+		if (m_tick_thread.load() == this_thread::get_id())
+		{
+			// Capturing while the previous save of the file is still being written would stall the tick until it
+			// lands. Instead the capture is handed to the tick which finds the file free, a save of the same file
+			// that is already waiting there absorbs this one (as a full save, if either of them is).
+			{
+				lock_guard<mutex> lock(m_state_mutex);
+				if (FileStream::IsWritePending(file_path) && (!m_save_requested || m_save_path == file_path))
+				{
+					m_save_incremental	= m_save_requested ? (m_save_incremental && incremental) : incremental;
+					m_save_path			= file_path;
+					m_save_requested	= true;
+					return true;
+				}
+			}
+
+			return SaveCapture(file_path, incremental);
+		}
+
+		lock_guard<mutex> lock_save(m_save_mutex);
+		unique_lock<mutex> lock(m_state_mutex);
+		m_state_condition.wait(lock, [this] { return !m_save_requested; }); // one deferred by the ticking thread
+		m_save_path			= file_path;
+		m_save_incremental	= incremental;
+		m_save_requested	= true;
+		m_state_condition.wait(lock, [this] { return !m_save_requested; });
+
+		return m_save_result;
+	}
+
+	bool World::SaveCapture(const string& file_path, bool incremental)
+	{
+		// Start progress report and timer
+		ProgressReport::Get().Reset(g_progress_world);
+		ProgressReport::Get().SetIsLoading(g_progress_world, true);
+		ProgressReport::Get().SetStatus(g_progress_world, "Saving world...");
+		Stopwatch timer;
+
 		m_name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
 
-		// Notify subsystems that need to save data
-		FIRE_EVENT(Event_World_Save);
+		// Appending only works on the file the chunks came from and as long as at least half of it is still referenced.
+		// Partitioned worlds are always rewritten, their roots move between the world and the cell files.
+		uint64_t chunks_size = 0;
+		for (const auto& chunk : m_chunks)
+		{
+			chunks_size += chunk.size;
+		}
+		incremental = incremental && file_path == m_chunks_file_path && !m_streaming->IsEnabled() && chunks_size >= m_chunks_file_size / 2;
 
 		// Create a prefab file
-		auto file = make_unique<FileStream>(file_path, FileStream_Write);
+		auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Async | (incremental ? FileStream_Update : 0));
 		if (!file->IsOpen())
 		{
 			LOG_ERROR_GENERIC_FAILURE();
+			ProgressReport::Get().SetIsLoading(g_progress_world, false);
 			return false;
 		}
 
-		// Only save root entities as they will also save their descendants
-		auto root_actors = EntityGetRoots();
-		const auto root_entity_count = static_cast<uint32_t>(root_actors.size());
-
-		ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
+		// Opening waited for earlier writes to the file, so a different size means that something else wrote it.
+		// In that case it's rewritten from the start, which an update stream does as well (it truncates what's left).
+		incremental = incremental && FileSystem::GetFileSize(file_path) == m_chunks_file_size;
 
-		// Save root entity count
-		file->Write(root_entity_count);
+		// Notify subsystems that need to save data, they capture what they need now and write it in the background
+		FIRE_EVENT_DATA(Event_World_Save, incremental);
 
-		// Save root entity IDs
-		for (const auto& root : root_actors)
+		// The entities are serialized into the stream's staging memory, which is the snapshot. Nothing waits
+		// for the disk, full staging chunks are handed to the I/O thread while the rest is still being captured.
+		if (incremental)
 		{
-			file->Write(root->GetId());
+			SaveChunksIncremental(file.get());
 		}
+		else
+		{
+			// Only save root entities as they will also save their descendants
+			auto root_actors = EntityGetRoots();
+
+			// If the world is partitioned, streamable roots go into cell files and the rest stays here
+			root_actors = m_streaming->Save(file_path, g_world_file_version, root_actors);
+
+			// One job per root, plus the write itself
+			ProgressReport::Get().SetJobCount(g_progress_world, static_cast<int>(root_actors.size()) + 1);
 
-		// Save root entities
-		for (const auto& root : root_actors)
+			// Header
+			file->Write(g_world_file_magic);
+			file->Write(g_world_file_version);
+
+			m_chunks.clear();
+			ChunkAppend(file.get(), root_actors, &m_chunks);
+			ChunkTableWrite(file.get(), m_chunks);
+		}
+
+		m_chunks_file_path = file_path;
+		m_chunks_file_size = file->GetPosition();
+		file->Close();
+
+		LOG_INFO("Capturing took " + to_string(static_cast<int>(timer.GetElapsedTimeMs())) + " ms");
+
+		// The world keeps ticking while the I/O thread writes the file, finish the report once it's on disk
+		auto completion = file->GetCompletion();
+		m_context->GetSubsystem<Threading>()->AddTask([completion, timer, file_path]() mutable
 		{
-			root->Serialize(file.get());
+			if (completion.get())
+			{
+				LOG_INFO("Saving took " + to_string(static_cast<int>(timer.GetElapsedTimeMs())) + " ms");
+			}
+			else
+			{
+				LOGF_ERROR("Failed to write \"%s\"", file_path.c_str());
+			}
+
 			ProgressReport::Get().IncrementJobsDone(g_progress_world);
+			ProgressReport::Get().SetIsLoading(g_progress_world, false);
+
+			// Notify subsystems waiting for us to finish
+			FIRE_EVENT(Event_World_Saved);
+		});
+
+		return true;
+	}
+
+	void World::SaveChunksIncremental(FileStream* file)
+	{
+		// Keep what's in the file, the new chunks and the new table go after it
+		for (uint64_t remaining = m_chunks_file_size; remaining != 0;)
+		{
+			const auto skip = static_cast<uint32_t>(Min<uint64_t>(remaining, numeric_limits<uint32_t>::max()));
+			file->Skip(skip);
+			remaining -= skip;
 		}
 
-		// Finish with progress report and timer
-		ProgressReport::Get().SetIsLoading(g_progress_world, false);
-		LOG_INFO("Saving took " + to_string(static_cast<int>(timer.GetElapsedTimeMs())) + " ms");
+		// Dirty chunks are written again with their current roots, roots which were never saved go into new chunks
+		vector<vector<shared_ptr<Entity>>> chunk_roots(m_chunks.size());
+		vector<shared_ptr<Entity>> roots_new;
+		for (const auto& root : EntityGetRoots())
+		{
+			const auto chunk = root->GetSaveChunk();
+			if (chunk >= m_chunks.size())
+			{
+				roots_new.emplace_back(root);
+			}
+			else if (m_chunks[chunk].dirty)
+			{
+				chunk_roots[chunk].emplace_back(root);
+			}
+		}
 
-		// Notify subsystems waiting for us to finish
-		FIRE_EVENT(Event_World_Saved);
+		int job_count = static_cast<int>(roots_new.size()) + 1;
+		for (const auto& roots : chunk_roots)
+		{
+			job_count += static_cast<int>(roots.size());
+		}
+		ProgressReport::Get().SetJobCount(g_progress_world, job_count);
 
-		return true;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(m_chunks.size()); i++)
+		{
+			auto& chunk = m_chunks[i];
+			if (!chunk.dirty)
+				continue;
+
+			// The chunk keeps it's index (entities refer to it), it only moves in the file
+			chunk = WorldChunk();
+			chunk.offset = file->GetPosition();
+			for (const auto& root : chunk_roots[i])
+			{
+				ChunkCount(root.get(), &chunk.entity_count, &chunk.parallel);
+			}
+
+			for (const auto& root : chunk_roots[i])
+			{
+				ChunkAssign(root.get(), i);
+				root->Serialize(file);
+				chunk.root_count++;
+				ProgressReport::Get().IncrementJobsDone(g_progress_world);
+			}
+
+			chunk.size = file->GetPosition() - chunk.offset;
+		}
+
+		ChunkAppend(file, roots_new, &m_chunks);
+		ChunkTableWrite(file, m_chunks);
+	}
+
+	void World::ChunkMarkDirty(const uint32_t chunk)
+	{
+		if (chunk < m_chunks.size())
+		{
+			m_chunks[chunk].dirty = true;
+		}
+		else if (WorldStreaming::IsCellChunk(chunk))
+		{
+			m_streaming->MarkCellDirty(chunk);
+		}
 	}
 
 	bool World::LoadFromFile(const string& file_path)
@@ -203,8 +573,36 @@ namespace Spartan
 			return false;
 		}
 
-		// Thread safety: Wait for scene and the renderer to stop the entities (could do double buffering in the future)
-		while (m_state != Loading || m_context->GetSubsystem<Renderer>()->IsRendering()) { m_state = Request_Loading; this_thread::sleep_for(chrono::milliseconds(16)); }
+		// Validate the file before the simulation is stopped and the current world is unloaded,
+		// that way a file which can't be loaded leaves everything as it was.
+		auto file = make_unique<FileStream>(file_path, FileStream_Read | FileStream_Mapped);
+		if (!file->IsOpen())
+			return false;
+
+		const auto is_chunked = file->ReadAs<uint32_t>() == g_world_file_magic;
+		if (is_chunked)
+		{
+			const auto version = file->ReadAs<uint32_t>();
+			if (version > g_world_file_version)
+			{
+				LOGF_ERROR("\"%s\" was saved by a newer version (%d) of the world format", file_path.c_str(), version);
+				return false;
+			}
+			file->SetFormatVersion(version);
+		}
+		else
+		{
+			// Worlds saved before the chunked format are a single sequential stream
+			file->Seek(0);
+		}
+
+		// Thread safety: Wait for the simulation to stop touching the entities. The renderer only reads the
+		// published snapshot (which keeps whatever it references alive), so it can carry on drawing meanwhile.
+		{
+			unique_lock<mutex> lock(m_state_mutex);
+			m_state = Request_Loading;
+			m_state_condition.wait(lock, [this] { return m_state == Loading; });
+		}
 
 		// Start progress report and timing
 		ProgressReport::Get().Reset(g_progress_world);
@@ -215,35 +613,49 @@ namespace Spartan
 		// Unload current entities
 		Unload();
 
-		// Read all the resource file paths
-		auto file = make_unique<FileStream>(file_path, FileStream_Read);
-		if (!file->IsOpen())
-			return false;
-
 		m_name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
 
 		// Notify subsystems that need to load data
 		FIRE_EVENT(Event_World_Load);
 
-		// Load root entity count
-		auto root_entity_count = file->ReadAs<uint32_t>();
+		if (is_chunked)
+		{
+			LoadChunks(file.get(), file_path);
+		}
+		else
+		{
+			// Load root entity count
+			auto root_entity_count = file->ReadAs<uint32_t>();
 
-		ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
+			ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
 
-		// Load root entity IDs
-		for (uint32_t i = 0; i < root_entity_count; i++)
-		{
-			auto& entity = EntityCreate();
-			entity->SetId(file->ReadAs<uint32_t>());
+			// Load root entity IDs
+			for (uint32_t i = 0; i < root_entity_count; i++)
+			{
+				auto& entity = EntityCreate();
+				entity->SetId(file->ReadAs<uint32_t>());
+			}
+
+			// Serialize root entities
+			for (uint32_t i = 0; i < root_entity_count; i++)
+			{
+				m_entities[i]->Deserialize(file.get(), nullptr);
+				ProgressReport::Get().IncrementJobsDone(g_progress_world);
+			}
 		}
 
-		// Serialize root entities
-		for (uint32_t i = 0; i < root_entity_count; i++)
+		// Entities join the world a chunk at a time, so what components refer to can be loaded after them
+		for (const auto& entity : m_entities)
 		{
-			m_entities[i]->Deserialize(file.get(), nullptr);
-			ProgressReport::Get().IncrementJobsDone(g_progress_world);
+			for (const auto& component : entity->GetAllComponents())
+			{
+				component->OnWorldLoaded();
+			}
 		}
 
+		// If the world is partitioned, the rest is streamed in as the camera approaches it
+		m_streaming->Load(file_path, file->GetFormatVersion());
+
 		m_is_dirty	= true;
 		m_state		= Ticking;
 		ProgressReport::Get().SetIsLoading(g_progress_world, false);	
@@ -253,10 +665,94 @@ namespace Spartan
 		return true;
 	}
 
+	void World::LoadChunks(FileStream* file, const string& file_path)
+	{
+		// The footer points to the chunk table
+		file->Seek(file->GetSize() - sizeof(uint64_t));
+		file->Seek(file->ReadAs<uint64_t>());
+
+		vector<WorldChunk> chunks(file->ReadAs<uint32_t>());
+		uint32_t root_count		= 0;
+		uint32_t entity_count	= 0;
+		for (auto& chunk : chunks)
+		{
+			file->Read(&chunk.offset);
+			file->Read(&chunk.size);
+			file->Read(&chunk.root_count);
+			file->Read(&chunk.entity_count);
+			file->Read(&chunk.parallel);
+			root_count		+= chunk.root_count;
+			entity_count	+= chunk.entity_count;
+		}
+
+		ProgressReport::Get().SetJobCount(g_progress_world, root_count);
+		m_entities.reserve(m_entities.size() + entity_count);
+
+		const auto add = [this](const uint32_t index, const WorldChunk& chunk, const vector<shared_ptr<Entity>>& entities)
+		{
+			for (const auto& entity : entities)
+			{
+				entity->SetSaveChunk(index);
+				entity->SetWorld(this);
+				QueryAdd(entity.get());
+				m_entities.emplace_back(entity);
+			}
+
+			for (uint32_t i = 0; i < chunk.root_count; i++)
+			{
+				ProgressReport::Get().IncrementJobsDone(g_progress_world);
+			}
+		};
+
+		// Decode the self contained chunks in parallel, the entities are outside of the world meanwhile so
+		// nothing else is touched. Every task maps the file as well, that way it gets a cursor of it's own.
+		vector<vector<shared_ptr<Entity>>> chunk_entities(chunks.size());
+		m_context->GetSubsystem<Threading>()->AddTaskLoop([this, file, &chunks, &chunk_entities, &file_path](uint32_t start, uint32_t end)
+		{
+			FileStream stream(file_path, FileStream_Read | FileStream_Mapped);
+			stream.SetFormatVersion(file->GetFormatVersion());
+			for (uint32_t i = start; i < end; i++)
+			{
+				if (chunks[i].parallel)
+				{
+					ChunkDecode(m_context, &stream, chunks[i], &chunk_entities[i]);
+				}
+			}
+		}, static_cast<uint32_t>(chunks.size()));
+
+		// The rest touches shared state (e.g. physics), so it's decoded here, a chunk at a time. References to
+		// other entities (e.g. constraints) are resolved once everything is in, see OnWorldLoaded().
+		for (uint32_t i = 0; i < static_cast<uint32_t>(chunks.size()); i++)
+		{
+			if (!chunks[i].parallel)
+			{
+				ChunkDecode(m_context, file, chunks[i], &chunk_entities[i]);
+				add(i, chunks[i], chunk_entities[i]);
+			}
+		}
+
+		// Parents were linked while decoding, so all that's left is to add the rest
+		for (uint32_t i = 0; i < static_cast<uint32_t>(chunks.size()); i++)
+		{
+			if (chunks[i].parallel)
+			{
+				add(i, chunks[i], chunk_entities[i]);
+			}
+		}
+
+		// Incremental saves append to this file
+		m_chunks			= move(chunks);
+		m_chunks_file_path	= file_path;
+		m_chunks_file_size	= file->GetSize();
+	}
+
     shared_ptr<Spartan::Entity>& World::EntityCreate(bool is_active /*= true*/)
     {
         auto& entity = m_entities.emplace_back(make_shared<Entity>(m_context));
         entity->SetActive(is_active);
+        entity->SetWorld(this);
+        QueryAdd(entity.get());
+        m_is_dirty = true;
         return entity;
     }
 
@@ -267,9 +763,70 @@ namespace Spartan
 		if (!entity)
 			return empty;
 
+        entity->SetWorld(this);
+        QueryAdd(entity.get());
+        m_is_dirty = true;
 		return m_entities.emplace_back(entity);
 	}
 
+	// Creates a number of instances of a prefab, all of them are added to the world at once
+	vector<shared_ptr<Entity>> World::EntityInstantiate(const Prefab& prefab, const uint32_t count /*= 1*/, Transform* parent /*= nullptr*/)
+	{
+		vector<shared_ptr<Entity>> roots;
+		if (prefab.IsEmpty() || count == 0)
+			return roots;
+
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		const auto& nodes		= prefab.GetNodes();
+		const auto node_count	= prefab.GetNodeCount();
+
+		roots.reserve(count);
+		m_entities.reserve(m_entities.size() + static_cast<size_t>(node_count) * count);
+
+		vector<Transform*> instance_transforms(node_count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			for (uint32_t node_index = 0; node_index < node_count; node_index++)
+			{
+				// The entity is not part of the world yet, so building it notifies nobody
+				auto entity = make_shared<Entity>(m_context);
+				prefab.Apply(node_index, entity.get());
+
+				// Parents always precede their children, so they already exist
+				auto transform = entity->GetTransform_PtrRaw();
+				const auto parent_index = nodes[node_index].parent_index;
+				if (parent_index >= 0)
+				{
+					instance_transforms[parent_index]->AppendChild(transform);
+				}
+				else
+				{
+					if (parent)
+					{
+						parent->AppendChild(transform);
+					}
+					roots.emplace_back(entity);
+				}
+				instance_transforms[node_index] = transform;
+
+				entity->SetWorld(this);
+				QueryAdd(entity.get());
+				m_entities.emplace_back(entity);
+			}
+
+			// Resolve the world matrices of the whole instance
+			instance_transforms.front()->UpdateTransform();
+		}
+
+		// A single notification for all the instances
+		m_is_dirty = true;
+
+		TIME_BLOCK_END(m_profiler);
+
+		return roots;
+	}
+
 	bool World::EntityExists(const shared_ptr<Entity>& entity)
 	{
 		if (!entity)
@@ -284,35 +841,68 @@ namespace Spartan
 		if (!entity)
 			return;
 
-		// Remove any descendants
-		auto children = entity->GetTransform_PtrRaw()->GetChildren();
-		for (const auto& child : children)
-		{
-			EntityRemove(child->GetEntity_PtrShared());
-		}
+		EntityRemove(vector<shared_ptr<Entity>>{ entity });
+	}
 
-		// Keep a reference to it's parent (in case it has one)
-		auto parent = entity->GetTransform_PtrRaw()->GetParent();
+	// Removes a batch of entities and all of their children, in a single pass over the world
+	void World::EntityRemove(const vector<shared_ptr<Entity>>& entities)
+	{
+		TIME_BLOCK_START_CPU(m_profiler);
 
-		// Remove this entity
-		for (auto it = m_entities.begin(); it < m_entities.end();)
+		// Mark the entities and their descendants by detaching them from the world
+		vector<Transform*> descendants;
+		uint32_t removed_count = 0;
+		for (const auto& entity : entities)
 		{
-			const auto temp = *it;
-			if (temp->GetId() == entity->GetId())
+			// Skip entities which don't belong to the world or have already been marked (e.g. as a descendant)
+			if (!entity || entity->GetWorld() != this)
+				continue;
+
+			// Detach it from it's parent, so that neither of them points to the other anymore (this marks the parent dirty)
+			auto transform = entity->GetTransform_PtrRaw();
+			if (auto parent = transform->GetParent())
+			{
+				parent->RemoveChild(transform);
+			}
+
+			// The chunk it was saved in has to be saved again without it
+			entity->MarkDirty();
+
+			descendants.clear();
+			transform->GetDescendants(&descendants);
+			for (const auto& descendant : descendants)
 			{
-				it = m_entities.erase(it);
-				break;
+				descendant->GetEntity_PtrRaw()->SetWorld(nullptr);
 			}
-			++it;
+			entity->SetWorld(nullptr);
+			removed_count += static_cast<uint32_t>(descendants.size()) + 1;
 		}
 
-		// If there was a parent, update it
-		if (parent)
+		if (removed_count != 0)
 		{
-			parent->AcquireChildren();
+			// Remove the detached renderables from the spatial tree
+			for (Entity* entity : Query<Renderable>())
+			{
+				if (entity->GetWorld() != this)
+				{
+					SpatialRemove(entity);
+				}
+			}
+
+			// Compact the query views
+			for (auto& query : m_queries)
+			{
+				auto& view = query.second;
+				view.erase(remove_if(view.begin(), view.end(), [this](Entity* entity) { return entity->GetWorld() != this; }), view.end());
+			}
+
+			// Compact the entities
+			m_entities.erase(remove_if(m_entities.begin(), m_entities.end(), [this](const shared_ptr<Entity>& entity) { return entity->GetWorld() != this; }), m_entities.end());
+
+			m_is_dirty = true;
 		}
 
-        m_is_dirty = true;
+		TIME_BLOCK_END(m_profiler);
 	}
 
 	vector<shared_ptr<Entity>> World::EntityGetRoots()
@@ -353,6 +943,394 @@ namespace Spartan
 		return empty;
 	}
 
+	const vector<Entity*>& World::Query(const uint32_t component_mask)
+	{
+		// Return the cached view if it exists
+		auto it = m_queries.find(component_mask);
+		if (it != m_queries.end())
+			return it->second;
+
+		// Otherwise build it once, from then on it's maintained incrementally
+		auto& view = m_queries[component_mask];
+		for (const auto& entity : m_entities)
+		{
+			if ((entity->GetComponentMask() & component_mask) == component_mask)
+			{
+				view.emplace_back(entity.get());
+			}
+		}
+
+		return view;
+	}
+
+	void World::QueryUpdate(Entity* entity, const uint32_t component_mask_old, const uint32_t component_mask_new)
+	{
+		if (!entity || component_mask_old == component_mask_new)
+			return;
+
+		// Renderables are also tracked by the spatial tree
+		const auto mask_renderable = GetComponentMask(ComponentType_Renderable);
+		if ((component_mask_old & mask_renderable) != (component_mask_new & mask_renderable))
+		{
+			if (component_mask_new & mask_renderable)
+			{
+				SpatialInsert(entity);
+			}
+			else
+			{
+				SpatialRemove(entity);
+			}
+		}
+
+		for (auto& query : m_queries)
+		{
+			const auto mask			= query.first;
+			const auto matched_old	= (component_mask_old & mask) == mask;
+			const auto matched_new	= (component_mask_new & mask) == mask;
+
+			if (matched_old == matched_new)
+				continue;
+
+			auto& view = query.second;
+			if (matched_new)
+			{
+				view.emplace_back(entity);
+			}
+			else
+			{
+				// Order doesn't matter, swap with the last element and pop it
+				auto it = find(view.begin(), view.end(), entity);
+				if (it != view.end())
+				{
+					*it = view.back();
+					view.pop_back();
+				}
+			}
+		}
+	}
+
+	void World::QueryAdd(Entity* entity)
+	{
+		QueryUpdate(entity, 0, entity->GetComponentMask());
+	}
+
+	void World::QueryClear()
+	{
+		// Keep the views around as they might be referenced, just empty them
+		for (auto& query : m_queries)
+		{
+			query.second.clear();
+		}
+	}
+
+	void World::SpatialQuery(const Frustum& frustum, vector<Entity*>& entities) const
+	{
+		m_spatial_tree->Query(frustum, [&entities](void* user_data) { entities.emplace_back(static_cast<Entity*>(user_data)); return true; });
+	}
+
+	void World::SpatialQuery(const BoundingBox& box, vector<Entity*>& entities) const
+	{
+		m_spatial_tree->Query(box, [&entities](void* user_data) { entities.emplace_back(static_cast<Entity*>(user_data)); return true; });
+	}
+
+	void World::SpatialQuery(const Vector3& center, const float radius, vector<Entity*>& entities) const
+	{
+		m_spatial_tree->Query(center, radius, [&entities](void* user_data) { entities.emplace_back(static_cast<Entity*>(user_data)); return true; });
+	}
+
+	void World::SpatialInsert(Entity* entity)
+	{
+		Renderable* renderable = entity->GetRenderable_PtrRaw();
+		if (!renderable || m_spatial_proxies.find(entity) != m_spatial_proxies.end())
+			return;
+
+		m_spatial_proxies[entity] = m_spatial_tree->Insert(renderable->GetAabb(), entity);
+	}
+
+	void World::SpatialRemove(Entity* entity)
+	{
+		auto it = m_spatial_proxies.find(entity);
+		if (it == m_spatial_proxies.end())
+			return;
+
+		m_spatial_tree->Remove(it->second);
+		m_spatial_proxies.erase(it);
+	}
+
+	void World::SpatialRefit()
+	{
+		// Only the entities that moved since the last refit are visited. Leaves only move in the tree once
+		// they escape their enlarged box, so this is mostly a containment test.
+		for (Entity* entity : m_spatial_moved)
+		{
+			// Removed entities no longer have a proxy, look it up before touching the entity
+			const auto it = m_spatial_proxies.find(entity);
+			if (it == m_spatial_proxies.end())
+				continue;
+
+			if (Renderable* renderable = entity->GetRenderable_PtrRaw())
+			{
+				m_spatial_tree->Move(it->second, renderable->GetAabb());
+			}
+		}
+		m_spatial_moved.clear();
+	}
+
+	float World::GetUpdateLodDistance(const uint32_t tier) const
+	{
+		if (tier == 0 || tier > m_update_lod_distances.size())
+			return 0.0f;
+
+		return m_update_lod_distances[tier - 1];
+	}
+
+	void World::SetUpdateLodDistance(const uint32_t tier, const float distance)
+	{
+		if (tier == 0 || tier > m_update_lod_distances.size())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		m_update_lod_distances[tier - 1] = Max(distance, 0.0f);
+
+		// Keep the tiers in ascending order
+		for (uint32_t i = tier; i < m_update_lod_distances.size(); i++)
+		{
+			m_update_lod_distances[i] = Max(m_update_lod_distances[i], m_update_lod_distances[i - 1]);
+		}
+		for (uint32_t i = tier - 1; i > 0; i--)
+		{
+			m_update_lod_distances[i - 1] = Min(m_update_lod_distances[i - 1], m_update_lod_distances[i]);
+		}
+	}
+
+	uint32_t World::GetUpdateInterval(Entity* entity, const Vector3& camera_position, const Camera* camera) const
+	{
+		// Components which the rest of the engine depends on have to tick every frame
+		static const uint32_t full_rate_mask =
+			GetComponentMask(ComponentType_AudioListener)	|
+			GetComponentMask(ComponentType_Camera)			|
+			GetComponentMask(ComponentType_Light)			|
+			GetComponentMask(ComponentType_RigidBody)		|
+			GetComponentMask(ComponentType_Constraint);
+
+		if (entity->GetComponentMask() & full_rate_mask)
+			return 1;
+
+		const float distance_squared = Vector3::DistanceSquared(camera_position, entity->GetTransform_PtrRaw()->GetPosition());
+
+		uint32_t tier = 0;
+		while (tier < m_update_lod_distances.size() && distance_squared >= m_update_lod_distances[tier] * m_update_lod_distances[tier])
+		{
+			tier++;
+		}
+
+		// Renderables which are outside of the view drop a tier
+		if (tier < m_update_lod_distances.size())
+		{
+			if (Renderable* renderable = entity->GetRenderable_PtrRaw())
+			{
+				const BoundingBox& aabb = renderable->GetAabb();
+				if (camera->GetFrustum().CheckCube(aabb.GetCenter(), aabb.GetExtents()) == Outside)
+				{
+					tier++;
+				}
+			}
+		}
+
+		return 1 << tier;
+	}
+
+	shared_ptr<const WorldSnapshot> World::GetSnapshot()
+	{
+		lock_guard<mutex> lock(m_snapshot_mutex);
+		return m_snapshots[m_snapshot_front];
+	}
+
+	void World::SnapshotExtract()
+	{
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		// Write into the back buffer, unless a reader is still holding on to it from an older frame
+		auto& snapshot = m_snapshots[m_snapshot_front ^ 1];
+		if (snapshot.use_count() > 1)
+		{
+			snapshot = make_shared<WorldSnapshot>();
+		}
+		snapshot->Clear();
+		snapshot->frame = ++m_snapshot_frame;
+
+		// Camera (the last active one wins)
+		for (Entity* entity : Query<Camera>())
+		{
+			if (!entity->IsActive())
+				continue;
+
+			const auto camera		= entity->GetComponent<Camera>();
+			const auto transform	= entity->GetTransform_PtrRaw();
+			auto& item				= snapshot->camera;
+
+			item.view				= camera->GetViewMatrix();
+			item.view_base			= camera->GetBaseViewMatrix();
+			item.projection			= camera->GetProjectionMatrix();
+			item.position			= transform->GetPosition();
+			item.forward			= transform->GetForward();
+			item.clear_color		= camera->GetClearColor();
+			item.near_plane			= camera->GetNearPlane();
+			item.far_plane			= camera->GetFarPlane();
+			item.frustum			= camera->GetFrustum();
+			item.entity				= entity->GetPtrShared();
+			item.camera_component	= camera;
+			snapshot->has_camera	= true;
+		}
+
+		// Materials are copied once, no matter how many renderables use them (and they never move, the renderables point to them)
+		const auto& renderable_entities = Query<Renderable>();
+		snapshot->materials.reserve(renderable_entities.size());
+		unordered_map<const Material*, const SnapshotMaterial*> materials;
+		const auto snapshot_material = [&snapshot, &materials](const shared_ptr<Material>& material) -> const SnapshotMaterial*
+		{
+			if (!material)
+				return nullptr;
+
+			auto& item = materials[material.get()];
+			if (item)
+				return item;
+
+			auto& copy					= snapshot->materials.emplace_back();
+			copy.id						= material->GetId();
+			copy.shader					= material->GetShader();
+			copy.cull_mode				= material->GetCullMode();
+			copy.shading_mode			= material->GetShadingMode();
+			copy.color_albedo			= material->GetColorAlbedo();
+			copy.tiling					= material->GetTiling();
+			copy.offset					= material->GetOffset();
+			copy.multiplier_roughness	= material->GetMultiplier(TextureType_Roughness);
+			copy.multiplier_metallic	= material->GetMultiplier(TextureType_Metallic);
+			copy.multiplier_normal		= material->GetMultiplier(TextureType_Normal);
+			copy.multiplier_height		= material->GetMultiplier(TextureType_Height);
+			for (uint32_t type = TextureType_Albedo; type <= TextureType_Mask; type++)
+			{
+				if (material->HasTexture(static_cast<TextureType>(type)))
+				{
+					copy.textures[type - TextureType_Albedo] = material->GetTexture(static_cast<TextureType>(type));
+				}
+			}
+			copy.material_component		= material;
+
+			item = &copy;
+			return item;
+		};
+
+		// Renderables
+		for (Entity* entity : renderable_entities)
+		{
+			if (!entity->IsActive())
+				continue;
+
+			auto renderable				= entity->GetRenderable_PtrRaw();
+			const auto& material		= renderable->GetMaterial();
+			const auto is_transparent	= material ? material->GetColorAlbedo().w < 1.0f : false;
+			auto& item					= (is_transparent ? snapshot->renderables_transparent : snapshot->renderables_opaque).emplace_back();
+
+			item.entity_id				= entity->GetId();
+			item.transform				= entity->GetTransform_PtrRaw()->GetMatrix();
+			item.aabb					= renderable->GetAabb();
+			item.material				= snapshot_material(material);
+			item.model					= renderable->GeometryModel();
+			item.index_offset			= renderable->GeometryIndexOffset();
+			item.index_count			= renderable->GeometryIndexCount();
+			item.vertex_offset			= renderable->GeometryVertexOffset();
+			item.vertex_count			= renderable->GeometryVertexCount();
+			item.cast_shadows			= renderable->GetCastShadows();
+			item.is_occluder			= renderable->IsOccluder();
+			item.is_static				= renderable->IsStatic(snapshot->frame);
+			item.transform_version		= entity->GetTransform_PtrRaw()->GetVersion();
+			item.transform_component	= entity->GetComponent<Transform>();
+		}
+
+		// Sort by depth (front to back), then by material
+		if (snapshot->has_camera)
+		{
+			const auto camera_position = snapshot->camera.position;
+			auto sort_renderables = [&camera_position](vector<SnapshotRenderable>& renderables)
+			{
+				sort(renderables.begin(), renderables.end(), [&camera_position](const SnapshotRenderable& a, const SnapshotRenderable& b)
+				{
+					const auto depth_a = (a.aabb.GetCenter() - camera_position).LengthSquared();
+					const auto depth_b = (b.aabb.GetCenter() - camera_position).LengthSquared();
+					if (depth_a != depth_b)
+						return depth_a < depth_b;
+
+					const auto material_a = a.material ? a.material->id : 0;
+					const auto material_b = b.material ? b.material->id : 0;
+					return material_a < material_b;
+				});
+			};
+
+			sort_renderables(snapshot->renderables_opaque);
+			sort_renderables(snapshot->renderables_transparent);
+		}
+
+		// Bounds, for batch culling
+		for (const auto& renderable : snapshot->renderables_opaque)
+		{
+			snapshot->bounds_opaque.Add(renderable.aabb);
+		}
+		for (const auto& renderable : snapshot->renderables_transparent)
+		{
+			snapshot->bounds_transparent.Add(renderable.aabb);
+		}
+
+		// Lights
+		for (Entity* entity : Query<Light>())
+		{
+			if (!entity->IsActive())
+				continue;
+
+			const auto light	= entity->GetComponent<Light>();
+			auto& item			= snapshot->lights.emplace_back();
+
+			item.entity_id		= entity->GetId();
+			item.type			= light->GetLightType();
+			item.color			= light->GetColor();
+			item.position		= entity->GetTransform_PtrRaw()->GetPosition();
+			item.direction		= light->GetDirection();
+			item.intensity		= light->GetIntensity();
+			item.range			= light->GetRange();
+			item.angle			= light->GetAngle();
+			item.bias			= light->GetBias();
+			item.normal_bias	= light->GetNormalBias();
+			item.cast_shadows	= light->GetCastShadows();
+			item.shadow_map		= light->GetShadowMap();
+			item.shadow_slice_count = light->GetShadowSliceCount();
+
+			for (uint32_t i = 0; i < static_cast<uint32_t>(item.view.size()); i++)
+			{
+				item.view[i]		= light->GetViewMatrix(i);
+				item.projection[i]	= light->GetProjectionMatrix(i);
+			}
+
+			const auto& cascades = light->GetCascades();
+			item.frustum_count = Math::Min(static_cast<uint32_t>(cascades.size()), static_cast<uint32_t>(g_cascade_count));
+			for (uint32_t i = 0; i < item.frustum_count; i++)
+			{
+				item.frustums[i] = cascades[i].frustum;
+			}
+
+			item.light_component = light;
+		}
+
+		// Swap
+		{
+			lock_guard<mutex> lock(m_snapshot_mutex);
+			m_snapshot_front ^= 1;
+		}
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
 	shared_ptr<Entity>& World::CreateEnvironment()
 	{
 		auto& environment = EntityCreate();
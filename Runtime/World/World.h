@@ -21,20 +21,40 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==================
+//= INCLUDES ==========================
 #include <vector>
 #include <memory>
 #include <string>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
 #include "../Core/EngineDefs.h"
 #include "../Core/ISubsystem.h"
-//=============================
+#include "Components/IComponent.h"
+//=====================================
 
 namespace Spartan
 {
 	class Entity;
+	class Prefab;
+	class Transform;
 	class Light;
 	class Input;
 	class Profiler;
+	class Camera;
+	class WorldStreaming;
+	struct WorldSnapshot;
+	struct WorldChunk;
+	namespace Math
+	{
+		class Vector3;
+		class Frustum;
+		class BoundingBox;
+		class AabbTree;
+	}
 
 	enum Scene_State
 	{
@@ -56,15 +76,27 @@ namespace Spartan
 		//===================================
 		
 		void Unload();
-		bool SaveToFile(const std::string& filePath);
+
+		// Captures the world between two ticks and returns, the file (and the resources) are written in the
+		// background. The progress is reported through ProgressReport and Event_World_Saved fires once it's done.
+		// Incremental saves only append the chunks which contain changed entities (and a new chunk table) to the
+		// file which was last saved or loaded, it's rewritten from scratch once most of it is stale.
+		// While an earlier save of the same file is still being written, the capture is deferred to a later tick.
+		bool SaveToFile(const std::string& filePath, bool incremental = false);
+
+		// Invoked by entities when their saved state changes
+		void ChunkMarkDirty(uint32_t chunk);
 		bool LoadFromFile(const std::string& file_path);
 		const auto& GetName() { return m_name; }
+		auto GetStreaming() const { return m_streaming.get(); }
 
 		//= Entities ===================================================================
 		std::shared_ptr<Entity>& EntityCreate(bool is_active = true);
 		std::shared_ptr<Entity>& EntityAdd(const std::shared_ptr<Entity>& entity);
 		bool EntityExists(const std::shared_ptr<Entity>& entity);
-		void EntityRemove(const std::shared_ptr<Entity>& entity);	
+		void EntityRemove(const std::shared_ptr<Entity>& entity);
+		void EntityRemove(const std::vector<std::shared_ptr<Entity>>& entities);
+		std::vector<std::shared_ptr<Entity>> EntityInstantiate(const Prefab& prefab, uint32_t count = 1, Transform* parent = nullptr);
 		std::vector<std::shared_ptr<Entity>> EntityGetRoots();
 		const std::shared_ptr<Entity>& EntityGetByName(const std::string& name);
 		const std::shared_ptr<Entity>& EntityGetById(uint32_t id);
@@ -72,6 +104,44 @@ namespace Spartan
 		auto EntityGetCount()		{ return static_cast<uint32_t>(m_entities.size()); }
 		//==============================================================================
 
+		//= Queries ===========================================================================
+		// Returns a live view of the entities which have all of the given components.
+		// The view is kept up to date as components get added or removed, so it can be cached.
+		template <class... T>
+		const std::vector<Entity*>& Query() { return Query((GetComponentMask(IComponent::TypeToEnum<T>()) | ...)); }
+		const std::vector<Entity*>& Query(uint32_t component_mask);
+
+		// Invoked by entities when their components change
+		void QueryUpdate(Entity* entity, uint32_t component_mask_old, uint32_t component_mask_new);
+		//=====================================================================================
+
+		//= Spatial queries ===========================================================================
+		// The renderables are kept in a bounding volume tree, the ones that moved are refit every tick.
+		// These return the entities whose bounding box passes the test (rays go through Ray::Trace).
+		void SpatialQuery(const Math::Frustum& frustum, std::vector<Entity*>& entities) const;
+		void SpatialQuery(const Math::BoundingBox& box, std::vector<Entity*>& entities) const;
+		void SpatialQuery(const Math::Vector3& center, float radius, std::vector<Entity*>& entities) const;
+		const Math::AabbTree* GetSpatialTree() const { return m_spatial_tree.get(); }
+
+		// Invoked when the bounding box of an entity might have changed (it moved or it's geometry changed),
+		// only the entities marked this way are refit.
+		void SpatialMarkMoved(Entity* entity) { m_spatial_moved.emplace_back(entity); }
+		//=============================================================================================
+
+		//= Update LOD ==================================================================================
+		// Entities that are far away (or outside of the view) tick every 2nd, 4th or 8th frame, with the accumulated delta time.
+		// Entities which drive the engine (cameras, lights, listeners, physics) always tick every frame.
+		bool IsUpdateLodEnabled() const						{ return m_update_lod_enabled; }
+		void SetUpdateLodEnabled(const bool enabled)		{ m_update_lod_enabled = enabled; }
+		float GetUpdateLodDistance(const uint32_t tier) const;
+		void SetUpdateLodDistance(const uint32_t tier, const float distance);
+		//=============================================================================================
+
+		//= Snapshot ==================================================================================
+		// Returns the most recently published render snapshot, it remains valid for as long as it's held
+		std::shared_ptr<const WorldSnapshot> GetSnapshot();
+		//=============================================================================================
+
 	private:
 		//= COMMON ENTITY CREATION ========================
 		std::shared_ptr<Entity>& CreateEnvironment();
@@ -79,13 +149,71 @@ namespace Spartan
 		std::shared_ptr<Entity>& CreateDirectionalLight();
 		//================================================
 
+		//= QUERIES ===================================
+		void QueryAdd(Entity* entity);
+		void QueryClear();
+		static uint32_t GetComponentMask(ComponentType type) { return 1 << static_cast<uint32_t>(type); }
+		//=============================================
+
+		//= SPATIAL TREE =============================
+		void SpatialInsert(Entity* entity);
+		void SpatialRemove(Entity* entity);
+		void SpatialRefit();
+		//============================================
+
+		// Returns how many frames should pass between two ticks of an entity
+		uint32_t GetUpdateInterval(Entity* entity, const Math::Vector3& camera_position, const Camera* camera) const;
+
+		// Copies the render relevant state into the back snapshot and swaps it to the front
+		void SnapshotExtract();
+
+		// Serializes the entities into a staged file stream, must run on the ticking thread
+		bool SaveCapture(const std::string& file_path, bool incremental);
+		void SaveChunksIncremental(FileStream* file);
+
+		// Loads the chunks of a world file, self contained ones in parallel
+		void LoadChunks(FileStream* file, const std::string& file_path);
+
         std::string m_name;
         bool m_wasInEditorMode  = false;
         bool m_is_dirty         = true;
-        Scene_State m_state     = Ticking;	
+        std::atomic<Scene_State> m_state = Ticking;
         Input* m_input          = nullptr;
         Profiler* m_profiler    = nullptr;
 
         std::vector<std::shared_ptr<Entity>> m_entities;
+        std::unordered_map<uint32_t, std::vector<Entity*>> m_queries;
+        std::unique_ptr<WorldStreaming> m_streaming;
+        std::unique_ptr<Math::AabbTree> m_spatial_tree;
+        std::unordered_map<Entity*, int32_t> m_spatial_proxies;
+        std::vector<Entity*> m_spatial_moved;
+
+        // Update LOD
+        bool m_update_lod_enabled = true;
+        std::array<float, 3> m_update_lod_distances = { 40.0f, 100.0f, 250.0f }; // where tiers 1, 2 and 3 start
+        uint64_t m_update_lod_frame = 0;
+
+        // Snapshot
+        std::array<std::shared_ptr<WorldSnapshot>, 2> m_snapshots;
+        uint32_t m_snapshot_front   = 0;
+        uint64_t m_snapshot_frame   = 0;
+        std::mutex m_snapshot_mutex;
+
+        // Loading hand-off
+        std::mutex m_state_mutex;
+        std::condition_variable m_state_condition;
+
+        // Saving hand-off
+        std::atomic<std::thread::id> m_tick_thread;
+        std::atomic<bool> m_save_requested = false;
+        std::string m_save_path;
+        bool m_save_incremental = false;
+        bool m_save_result = false;
+        std::mutex m_save_mutex;
+
+        // The chunks of the world file which was last saved (or loaded), an entity's save chunk indexes into them
+        std::vector<WorldChunk> m_chunks;
+        std::string m_chunks_file_path;
+        uint64_t m_chunks_file_size = 0;
 	};
 }
@@ -0,0 +1,187 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <array>
+#include <memory>
+#include <vector>
+#include "Components/Light.h"
+#include "../Rendering/Material.h"
+#include "../Math/Matrix.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+#include "../Math/Vector4.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Frustum.h"
+//==============================
+
+namespace Spartan
+{
+	class Entity;
+	class Camera;
+	class Transform;
+	class Model;
+	class ShaderVariation;
+
+	// The render relevant state of a material, as it was at the end of a world tick (it can be edited meanwhile)
+	struct SnapshotMaterial
+	{
+		uint32_t id                     = 0;
+		std::shared_ptr<ShaderVariation> shader;
+		RHI_Cull_Mode cull_mode         = Cull_Back;
+		ShadingMode shading_mode        = Shading_PBR;
+		Math::Vector4 color_albedo      = Math::Vector4::One;
+		Math::Vector2 tiling            = Math::Vector2::One;
+		Math::Vector2 offset            = Math::Vector2::Zero;
+		float multiplier_roughness      = 0.0f;
+		float multiplier_metallic       = 0.0f;
+		float multiplier_normal         = 0.0f;
+		float multiplier_height         = 0.0f;
+		std::array<std::shared_ptr<RHI_Texture>, 8> textures; // TextureType_Albedo to TextureType_Mask, the order of the GBuffer shader
+
+		// Only used for the gpu buffer it owns, never for its state
+		std::shared_ptr<Material> material_component;
+	};
+
+	// The render relevant state of a renderable, as it was at the end of a world tick
+	struct SnapshotRenderable
+	{
+		uint32_t entity_id         = 0;
+		Math::Matrix transform     = Math::Matrix::Identity;
+		Math::BoundingBox aabb;
+		const SnapshotMaterial* material = nullptr; // points into the snapshot's materials
+		std::shared_ptr<Model> model;
+		uint32_t index_offset      = 0;
+		uint32_t index_count       = 0;
+		uint32_t vertex_offset     = 0;
+		uint32_t vertex_count      = 0;
+		uint32_t transform_version = 0;
+		bool cast_shadows          = false;
+		bool is_occluder           = false;
+		bool is_static             = false; // hasn't moved for a while
+
+		// Only used for the per object gpu buffers it owns, never for its state
+		std::shared_ptr<Transform> transform_component;
+	};
+
+	// The bounds of a list of renderables, as structure of arrays, so they can be culled in batches (see Frustum::CheckCubes)
+	struct SnapshotBounds
+	{
+		void Clear()
+		{
+			center_x.clear(); center_y.clear(); center_z.clear();
+			extent_x.clear(); extent_y.clear(); extent_z.clear();
+		}
+
+		void Add(const Math::BoundingBox& box)
+		{
+			const auto center	= box.GetCenter();
+			const auto extent	= box.GetExtents();
+			center_x.emplace_back(center.x); center_y.emplace_back(center.y); center_z.emplace_back(center.z);
+			extent_x.emplace_back(extent.x); extent_y.emplace_back(extent.y); extent_z.emplace_back(extent.z);
+		}
+
+		void Cull(const Math::Frustum& frustum, const uint32_t start, const uint32_t end, uint32_t* visibility) const
+		{
+			frustum.CheckCubes(&center_x[start], &center_y[start], &center_z[start], &extent_x[start], &extent_y[start], &extent_z[start], end - start, visibility + start / 32);
+		}
+
+		uint32_t Size() const { return static_cast<uint32_t>(center_x.size()); }
+
+		std::vector<float> center_x, center_y, center_z;
+		std::vector<float> extent_x, extent_y, extent_z;
+	};
+
+	// The render relevant state of a light, as it was at the end of a world tick
+	struct SnapshotLight
+	{
+		uint32_t entity_id          = 0;
+		LightType type              = LightType_Directional;
+		Math::Vector4 color         = Math::Vector4::One;
+		Math::Vector3 position      = Math::Vector3::Zero;
+		Math::Vector3 direction     = Math::Vector3::Zero;
+		float intensity             = 0.0f;
+		float range                 = 0.0f;
+		float angle                 = 0.0f;
+		float bias                  = 0.0f;
+		float normal_bias           = 0.0f;
+		bool cast_shadows           = false;
+		std::array<Math::Matrix, 6> view;
+		std::array<Math::Matrix, 6> projection;
+		std::array<Math::Frustum, g_cascade_count> frustums;
+		uint32_t frustum_count      = 0;
+		uint32_t shadow_slice_count = 0; // cascades or cube faces, only directional lights bring their own shadow map
+		std::shared_ptr<RHI_Texture> shadow_map;
+
+		// Only used for the gpu buffer it owns, never for its state
+		std::shared_ptr<Light> light_component;
+	};
+
+	// The render relevant state of the active camera, as it was at the end of a world tick
+	struct SnapshotCamera
+	{
+		Math::Matrix view           = Math::Matrix::Identity;
+		Math::Matrix view_base      = Math::Matrix::Identity;
+		Math::Matrix projection     = Math::Matrix::Identity;
+		Math::Vector3 position      = Math::Vector3::Zero;
+		Math::Vector3 forward       = Math::Vector3::Forward;
+		Math::Vector4 clear_color   = Math::Vector4::Zero;
+		float near_plane            = 0.0f;
+		float far_plane             = 0.0f;
+		Math::Frustum frustum;
+
+		// Keeps the camera (and its transform) alive for the editor tools which still talk to it directly
+		std::shared_ptr<Entity> entity;
+		std::shared_ptr<Camera> camera_component;
+	};
+
+	// An immutable copy of everything the renderer needs. It's extracted by the world at the end of
+	// every tick and published by swapping buffers, so the renderer never reads components that the
+	// simulation (or a world load) is mutating.
+	struct WorldSnapshot
+	{
+		void Clear()
+		{
+			renderables_opaque.clear();
+			renderables_transparent.clear();
+			materials.clear();
+			bounds_opaque.Clear();
+			bounds_transparent.Clear();
+			lights.clear();
+			camera      = SnapshotCamera();
+			has_camera  = false;
+		}
+
+		bool IsEmpty() const { return renderables_opaque.empty() && renderables_transparent.empty() && lights.empty() && !has_camera; }
+
+		uint64_t frame = 0;
+		std::vector<SnapshotRenderable> renderables_opaque;     // sorted front to back, then by material
+		std::vector<SnapshotRenderable> renderables_transparent;
+		std::vector<SnapshotMaterial> materials;                // one per material in use, reserved up front so they don't move
+		SnapshotBounds bounds_opaque;                           // same order as renderables_opaque
+		SnapshotBounds bounds_transparent;                      // same order as renderables_transparent
+		std::vector<SnapshotLight> lights;
+		SnapshotCamera camera;
+		bool has_camera = false;
+	};
+}
@@ -0,0 +1,570 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include <algorithm>
+#include "WorldStreaming.h"
+#include "World.h"
+#include "Entity.h"
+#include "Components/Transform.h"
+#include "Components/Camera.h"
+#include "Components/Light.h"
+#include "Components/Environment.h"
+#include "Components/AudioListener.h"
+#include "../Core/Context.h"
+#include "../Core/Stopwatch.h"
+#include "../IO/FileStream.h"
+#include "../FileSystem/FileSystem.h"
+#include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+//=====================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+	// The first world format version whose cell table stores the format version of every cell
+	static const uint32_t g_version_cell_version = 2;
+
+	WorldStreaming::WorldStreaming(Context* context, World* world)
+	{
+		m_context	= context;
+		m_world		= world;
+		m_profiler	= context->GetSubsystem<Profiler>().get();
+	}
+
+	WorldStreaming::~WorldStreaming()
+	{
+		Clear();
+	}
+
+	void WorldStreaming::Tick(const Vector3& camera_position)
+	{
+		if (!IsEnabled() || m_cells.empty())
+			return;
+
+		// A save is in progress, try again next frame
+		unique_lock<mutex> lock(m_mutex, try_to_lock);
+		if (!lock.owns_lock())
+			return;
+
+		TIME_BLOCK_START_CPU(m_profiler);
+
+		const auto unload_distance = m_load_distance * m_unload_hysteresis;
+
+		// Unload what's out of range and gather what should come in
+		vector<pair<float, shared_ptr<WorldCell>>> candidates;
+		vector<pair<float, WorldCell*>> pending;
+		uint32_t loads_in_flight = 0;
+		for (const auto& cell : m_cells)
+		{
+			const auto distance	= GetDistance(*cell, camera_position);
+			const auto state	= cell->state.load();
+
+			if (state == WorldCell_Loading)
+			{
+				loads_in_flight++;
+				continue;
+			}
+
+			if (distance > unload_distance)
+			{
+				// Edits would be lost, so a dirty cell waits for the world to be saved (and finishes activating, so that it can be)
+				if (cell->dirty)
+				{
+					if (state == WorldCell_Loaded || state == WorldCell_Activating)
+					{
+						pending.emplace_back(distance, cell.get());
+					}
+				}
+				else if (state != WorldCell_Unloaded)
+				{
+					Deactivate(*cell);
+				}
+			}
+			else if (distance <= m_load_distance && state == WorldCell_Unloaded)
+			{
+				candidates.emplace_back(distance, cell);
+			}
+			else if (state == WorldCell_Loaded || state == WorldCell_Activating)
+			{
+				pending.emplace_back(distance, cell.get());
+			}
+		}
+
+		// Start loading the nearest cells, making room in the memory budget by evicting cells which are further away
+		sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		auto memory_usage = GetMemoryUsage();
+		for (const auto& candidate : candidates)
+		{
+			if (loads_in_flight >= m_max_loads_in_flight)
+				break;
+
+			const auto& cell = candidate.second;
+			while (memory_usage + cell->size > m_memory_budget)
+			{
+				WorldCell* farthest		= nullptr;
+				float farthest_distance	= candidate.first;
+				for (const auto& other : m_cells)
+				{
+					const auto state = other->state.load();
+					if (state == WorldCell_Unloaded || state == WorldCell_Loading || other->dirty)
+						continue;
+
+					const auto distance = GetDistance(*other, camera_position);
+					if (distance > farthest_distance)
+					{
+						farthest			= other.get();
+						farthest_distance	= distance;
+					}
+				}
+
+				if (!farthest)
+					break;
+
+				memory_usage -= farthest->size;
+				Deactivate(*farthest);
+			}
+
+			// Nothing further away left to evict
+			if (memory_usage + cell->size > m_memory_budget)
+				break;
+
+			LoadAsync(cell);
+			memory_usage += cell->size;
+			loads_in_flight++;
+		}
+
+		// Activate loaded cells, nearest first, without exceeding the frame budget
+		sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		Stopwatch timer;
+		for (const auto& cell : pending)
+		{
+			const auto budget_ms = m_activation_budget_ms - timer.GetElapsedTimeMs();
+			if (budget_ms <= 0.0f)
+				break;
+
+			// Evictions above might have unloaded it
+			if (cell.second->state == WorldCell_Loaded || cell.second->state == WorldCell_Activating)
+			{
+				Activate(*cell.second, budget_ms);
+			}
+		}
+
+		// Stats
+		m_profiler->m_world_cells_resident			= 0;
+		m_profiler->m_world_cells_pending			= 0;
+		m_profiler->m_world_streaming_memory		= GetMemoryUsage();
+		m_profiler->m_world_streaming_activation_ms	= timer.GetElapsedTimeMs();
+		for (const auto& cell : m_cells)
+		{
+			const auto state = cell->state.load();
+			m_profiler->m_world_cells_resident	+= state == WorldCell_Resident ? 1 : 0;
+			m_profiler->m_world_cells_pending	+= (state == WorldCell_Loading || state == WorldCell_Loaded || state == WorldCell_Activating) ? 1 : 0;
+		}
+
+		TIME_BLOCK_END(m_profiler);
+	}
+
+	vector<shared_ptr<Entity>> WorldStreaming::Save(const string& world_file_path, const uint32_t world_file_version, const vector<shared_ptr<Entity>>& roots)
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		vector<shared_ptr<Entity>> roots_resident;
+		const auto directory = FileSystem::GetFilePathWithoutExtension(world_file_path) + "_cells/";
+
+		// Not partitioned, make sure no stale cells get picked up when this world is loaded again
+		if (!IsEnabled())
+		{
+			if (FileSystem::DirectoryExists(directory))
+			{
+				FileSystem::DeleteDirectory(directory);
+			}
+			return roots;
+		}
+
+		if (!FileSystem::DirectoryExists(directory))
+		{
+			FileSystem::CreateDirectory_(directory);
+		}
+
+		// Map live roots to the cell they were streamed in from
+		unordered_map<Entity*, WorldCell*> origins;
+		for (const auto& cell : m_cells)
+		{
+			for (const auto& root : cell->roots)
+			{
+				if (auto entity = root.lock())
+				{
+					origins[entity.get()] = cell.get();
+				}
+			}
+		}
+
+		// Bucket the roots
+		unordered_map<WorldCell*, vector<shared_ptr<Entity>>> buckets;
+		for (const auto& root : roots)
+		{
+			auto it_origin		= origins.find(root.get());
+			WorldCell* origin	= it_origin != origins.end() ? it_origin->second : nullptr;
+
+			// Roots of cells which are partially streamed in, are saved by keeping the cell file as it is
+			if (origin && origin->state != WorldCell_Resident)
+				continue;
+
+			if (!IsStreamable(root.get()))
+			{
+				roots_resident.emplace_back(root);
+				continue;
+			}
+
+			// Find the cell the root is in now
+			const auto position	= root->GetTransform_PtrRaw()->GetPosition();
+			const auto x		= static_cast<int32_t>(Floor(position.x / m_cell_size));
+			const auto z		= static_cast<int32_t>(Floor(position.z / m_cell_size));
+			auto cell			= GetCell(x, z);
+			if (!cell)
+			{
+				cell			= make_shared<WorldCell>();
+				cell->x			= x;
+				cell->z			= z;
+				cell->index		= static_cast<uint32_t>(m_cells.size());
+				cell->state		= WorldCell_Resident;
+				m_cells.emplace_back(cell);
+			}
+
+			// A cell which isn't resident can't be rewritten, so keep the root where it came from (or with the world)
+			if (cell->state != WorldCell_Resident)
+			{
+				if (origin)
+				{
+					buckets[origin].emplace_back(root);
+				}
+				else
+				{
+					roots_resident.emplace_back(root);
+				}
+				continue;
+			}
+
+			buckets[cell.get()].emplace_back(root);
+		}
+
+		// Write the cells
+		for (const auto& cell : m_cells)
+		{
+			const auto file_path = GetCellPath(world_file_path, cell->x, cell->z);
+
+			if (cell->state == WorldCell_Resident)
+			{
+				const auto& bucket = buckets[cell.get()];
+
+				// Written by the I/O thread, like the world file
+				auto file = make_unique<FileStream>(file_path, FileStream_Write | FileStream_Async);
+				if (!file->IsOpen())
+				{
+					LOG_ERROR_GENERIC_FAILURE();
+					continue;
+				}
+
+				file->Write(static_cast<uint32_t>(bucket.size()));
+				for (const auto& root : bucket)
+				{
+					file->Write(root->GetId());
+				}
+				for (const auto& root : bucket)
+				{
+					root->Serialize(file.get());
+					AssignChunk(root.get(), g_cell_chunk_first + cell->index);
+				}
+				cell->size = file->GetPosition();
+				file->Close();
+				cell->dirty = false;
+
+				cell->root_count	= static_cast<uint32_t>(bucket.size());
+				cell->file_version	= world_file_version;
+				cell->roots.assign(bucket.begin(), bucket.end());
+			}
+			else if (cell->file_path != file_path)
+			{
+				// Saving under a different name, bring along the cells which are untouched
+				FileSystem::CopyFileFromTo(cell->file_path, file_path);
+				cell->size = FileSystem::GetFileSize(file_path);
+			}
+
+			cell->file_path = file_path;
+		}
+
+		// Write the table
+		auto file = make_unique<FileStream>(GetTablePath(world_file_path), FileStream_Write | FileStream_Async);
+		if (!file->IsOpen())
+		{
+			LOG_ERROR_GENERIC_FAILURE();
+			return roots_resident;
+		}
+
+		file->Write(m_cell_size);
+		file->Write(static_cast<uint32_t>(m_cells.size()));
+		for (const auto& cell : m_cells)
+		{
+			file->Write(cell->x);
+			file->Write(cell->z);
+			file->Write(cell->root_count);
+			file->Write(cell->size);
+			file->Write(cell->file_version);
+		}
+
+		return roots_resident;
+	}
+
+	bool WorldStreaming::Load(const string& world_file_path, const uint32_t world_file_version)
+	{
+		Clear();
+
+		const auto file_path = GetTablePath(world_file_path);
+		if (!FileSystem::FileExists(file_path))
+			return false;
+
+		auto file = make_unique<FileStream>(file_path, FileStream_Read);
+		if (!file->IsOpen())
+			return false;
+
+		lock_guard<mutex> lock(m_mutex);
+
+		file->Read(&m_cell_size);
+		const auto cell_count = file->ReadAs<uint32_t>();
+		m_cells.reserve(cell_count);
+		for (uint32_t i = 0; i < cell_count; i++)
+		{
+			auto cell = make_shared<WorldCell>();
+			file->Read(&cell->x);
+			file->Read(&cell->z);
+			file->Read(&cell->root_count);
+			file->Read(&cell->size);
+			cell->file_path		= GetCellPath(world_file_path, cell->x, cell->z);
+			cell->file_version	= world_file_version >= g_version_cell_version ? file->ReadAs<uint32_t>() : world_file_version;
+			cell->index			= i;
+			m_cells.emplace_back(cell);
+		}
+
+		return true;
+	}
+
+	void WorldStreaming::Clear()
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		// Loads in flight hold on to their cell, so it's fine to let go of them here
+		m_cells.clear();
+		m_cell_size = 0.0f;
+	}
+
+	void WorldStreaming::SetCellSize(const float size)
+	{
+		// The cell coordinates of everything on disk depend on it
+		if (!m_cells.empty())
+		{
+			LOG_WARNING("The cell size can't change once the world has been partitioned");
+			return;
+		}
+
+		m_cell_size = Max(size, 0.0f);
+	}
+
+	bool WorldStreaming::IsStreamable(Entity* root)
+	{
+		if (!root || !root->GetTransform_PtrRaw())
+			return false;
+
+		vector<Transform*> hierarchy = { root->GetTransform_PtrRaw() };
+		root->GetTransform_PtrRaw()->GetDescendants(&hierarchy);
+
+		for (const auto& transform : hierarchy)
+		{
+			auto entity = transform->GetEntity_PtrRaw();
+
+			if (entity->HasComponent<Camera>() || entity->HasComponent<Environment>() || entity->HasComponent<AudioListener>())
+				return false;
+
+			if (entity->HasComponent<Light>() && entity->GetComponent<Light>()->GetLightType() == LightType_Directional)
+				return false;
+		}
+
+		return true;
+	}
+
+	float WorldStreaming::GetDistance(const WorldCell& cell, const Vector3& position) const
+	{
+		// Distance to the cell's square on the XZ plane, zero when inside
+		const auto min_x	= cell.x * m_cell_size;
+		const auto min_z	= cell.z * m_cell_size;
+		const auto dx		= Max(Max(min_x - position.x, 0.0f), position.x - (min_x + m_cell_size));
+		const auto dz		= Max(Max(min_z - position.z, 0.0f), position.z - (min_z + m_cell_size));
+
+		return Sqrt(dx * dx + dz * dz);
+	}
+
+	shared_ptr<WorldCell> WorldStreaming::GetCell(const int32_t x, const int32_t z) const
+	{
+		for (const auto& cell : m_cells)
+		{
+			if (cell->x == x && cell->z == z)
+				return cell;
+		}
+
+		return nullptr;
+	}
+
+	void WorldStreaming::LoadAsync(const shared_ptr<WorldCell>& cell)
+	{
+		cell->state = WorldCell_Loading;
+
+		// Only the disk access happens on the worker, entities are created during activation
+		m_context->GetSubsystem<Threading>()->AddTask([cell]()
+		{
+			cell->stream	= make_unique<FileStream>(cell->file_path, FileStream_Read | FileStream_Preload);
+			cell->stream->SetFormatVersion(cell->file_version);
+			cell->state		= WorldCell_Loaded;
+		});
+	}
+
+	void WorldStreaming::Activate(WorldCell& cell, const float budget_ms)
+	{
+		Stopwatch timer;
+
+		if (cell.state == WorldCell_Loaded)
+		{
+			if (!cell.stream->IsOpen())
+			{
+				LOGF_ERROR("Failed to stream in cell %d, %d", cell.x, cell.z);
+				cell.stream.reset();
+				cell.state = WorldCell_Resident;
+				return;
+			}
+
+			// Root entity IDs
+			const auto root_count = cell.stream->ReadAs<uint32_t>();
+			cell.root_ids.resize(root_count);
+			for (auto& id : cell.root_ids)
+			{
+				cell.stream->Read(&id);
+			}
+
+			cell.state = WorldCell_Activating;
+		}
+
+		// Deserialize one root at a time until we run out of time
+		while (cell.roots_activated < static_cast<uint32_t>(cell.root_ids.size()))
+		{
+			auto& entity = m_world->EntityCreate();
+			entity->SetId(cell.root_ids[cell.roots_activated]);
+			entity->Deserialize(cell.stream.get(), nullptr);
+			AssignChunk(entity.get(), g_cell_chunk_first + cell.index);
+			cell.roots.emplace_back(entity);
+			cell.roots_activated++;
+
+			if (timer.GetElapsedTimeMs() >= budget_ms)
+				break;
+		}
+
+		if (cell.roots_activated == static_cast<uint32_t>(cell.root_ids.size()))
+		{
+			cell.stream.reset();
+			cell.state = WorldCell_Resident;
+			m_profiler->m_world_cells_streamed_in++;
+		}
+	}
+
+	void WorldStreaming::Deactivate(WorldCell& cell)
+	{
+		// Remove whatever of the cell is still in the world, in one go
+		vector<shared_ptr<Entity>> entities;
+		for (const auto& root : cell.roots)
+		{
+			if (auto entity = root.lock())
+			{
+				if (entity->GetWorld() == m_world)
+				{
+					entities.emplace_back(entity);
+				}
+			}
+		}
+		m_world->EntityRemove(entities);
+		cell.dirty = false; // removing them marked it
+
+		if (cell.state == WorldCell_Resident)
+		{
+			m_profiler->m_world_cells_streamed_out++;
+		}
+
+		cell.stream.reset();
+		cell.root_ids.clear();
+		cell.roots.clear();
+		cell.roots_activated	= 0;
+		cell.state				= WorldCell_Unloaded;
+	}
+
+	void WorldStreaming::MarkCellDirty(const uint32_t save_chunk)
+	{
+		const auto index = save_chunk - g_cell_chunk_first;
+		if (index < m_cells.size())
+		{
+			m_cells[index]->dirty = true;
+		}
+	}
+
+	void WorldStreaming::AssignChunk(Entity* entity, const uint32_t save_chunk)
+	{
+		entity->SetSaveChunk(save_chunk);
+
+		for (const auto& child : entity->GetTransform_PtrRaw()->GetChildren())
+		{
+			if (child->GetEntity_PtrRaw())
+			{
+				AssignChunk(child->GetEntity_PtrRaw(), save_chunk);
+			}
+		}
+	}
+
+	uint64_t WorldStreaming::GetMemoryUsage() const
+	{
+		uint64_t usage = 0;
+		for (const auto& cell : m_cells)
+		{
+			usage += cell->state != WorldCell_Unloaded ? cell->size : 0;
+		}
+
+		return usage;
+	}
+
+	string WorldStreaming::GetTablePath(const string& world_file_path)
+	{
+		return FileSystem::GetFilePathWithoutExtension(world_file_path) + "_cells/cells" + EXTENSION_WORLD_CELLS;
+	}
+
+	string WorldStreaming::GetCellPath(const string& world_file_path, const int32_t x, const int32_t z)
+	{
+		return FileSystem::GetFilePathWithoutExtension(world_file_path) + "_cells/" + to_string(x) + "_" + to_string(z) + EXTENSION_WORLD_CELL;
+	}
+}
@@ -0,0 +1,139 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "../Core/EngineDefs.h"
+#include "../Math/Vector3.h"
+//=================================
+
+namespace Spartan
+{
+	class Context;
+	class World;
+	class Entity;
+	class FileStream;
+	class Profiler;
+
+	enum WorldCell_State
+	{
+		WorldCell_Unloaded,
+		WorldCell_Loading,		// a worker is reading the cell file into memory
+		WorldCell_Loaded,		// in memory, waiting to be activated
+		WorldCell_Activating,	// entities are being created, a few per frame
+		WorldCell_Resident		// all entities are in the world
+	};
+
+	struct WorldCell
+	{
+		int32_t x					= 0;
+		int32_t z					= 0;
+		uint32_t root_count			= 0;
+		uint64_t size				= 0; // bytes on disk, what the memory budget is measured against
+		uint32_t file_version		= 0; // of the world format, untouched cells keep theirs when the world is saved
+		uint32_t index				= 0; // in the cell list, the cell's entities carry it in their save chunk
+		std::atomic<bool> dirty		= false; // its entities were edited since it was saved, so it stays resident until it's saved again
+		std::string file_path;
+		std::atomic<WorldCell_State> state = WorldCell_Unloaded;
+
+		// Activation
+		std::unique_ptr<FileStream> stream;
+		std::vector<uint32_t> root_ids;
+		uint32_t roots_activated	= 0;
+		std::vector<std::weak_ptr<Entity>> roots;
+	};
+
+	// Splits a world's entities into square cells on the XZ plane, each saved as a separate file.
+	// Cells around the camera are read in the background and then activated in small time slices,
+	// cells that fall out of range (or don't fit the memory budget) are unloaded.
+	class SPARTAN_CLASS WorldStreaming
+	{
+		static const uint32_t g_cell_chunk_first	= 0x80000000;
+		static const uint32_t g_cell_chunk_none		= 0xFFFFFFFF; // what entities which were never saved have
+
+	public:
+		WorldStreaming(Context* context, World* world);
+		~WorldStreaming();
+
+		void Tick(const Math::Vector3& camera_position);
+
+		// Writes the streamable roots into cell files, plus a table describing them. Cells which are not
+		// resident are kept as they are on disk. Returns the roots which have to be saved with the world.
+		std::vector<std::shared_ptr<Entity>> Save(const std::string& world_file_path, uint32_t world_file_version, const std::vector<std::shared_ptr<Entity>>& roots);
+
+		// Reads the cell table of a world, cells are then streamed in as the camera approaches them.
+		// The cells were written along with the world, so they are read as the same version of the format.
+		bool Load(const std::string& world_file_path, uint32_t world_file_version);
+
+		// Forgets about all the cells (their entities are expected to be removed by the world)
+		void Clear();
+
+		// The entities of a cell have a save chunk of their own (beyond the world's chunks), edits to them mark the cell dirty
+		static bool IsCellChunk(const uint32_t save_chunk) { return save_chunk >= g_cell_chunk_first && save_chunk != g_cell_chunk_none; }
+		void MarkCellDirty(uint32_t save_chunk);
+
+		// Returns true if the entity hierarchy can be streamed (cameras, environments, directional lights etc. stay resident)
+		static bool IsStreamable(Entity* root);
+
+		//= PROPERTIES =========================================================================
+		bool IsEnabled() const							{ return m_cell_size > 0.0f; }
+		void SetCellSize(float size);
+		auto GetCellSize() const						{ return m_cell_size; }
+		void SetLoadDistance(const float distance)		{ m_load_distance = Math::Max(distance, 0.0f); }
+		auto GetLoadDistance() const					{ return m_load_distance; }
+		void SetMemoryBudget(const uint64_t bytes)		{ m_memory_budget = bytes; }
+		auto GetMemoryBudget() const					{ return m_memory_budget; }
+		void SetActivationBudgetMs(const float ms)		{ m_activation_budget_ms = Math::Max(ms, 0.1f); }
+		auto GetActivationBudgetMs() const				{ return m_activation_budget_ms; }
+		const auto& GetCells() const					{ return m_cells; }
+		//======================================================================================
+
+	private:
+		float GetDistance(const WorldCell& cell, const Math::Vector3& position) const;
+		std::shared_ptr<WorldCell> GetCell(int32_t x, int32_t z) const;
+		void LoadAsync(const std::shared_ptr<WorldCell>& cell);
+		void Activate(WorldCell& cell, float budget_ms);
+		void Deactivate(WorldCell& cell);
+		static void AssignChunk(Entity* entity, uint32_t save_chunk);
+		uint64_t GetMemoryUsage() const;
+		static std::string GetTablePath(const std::string& world_file_path);
+		static std::string GetCellPath(const std::string& world_file_path, int32_t x, int32_t z);
+
+		float m_cell_size				= 0.0f;					// 0 means streaming is disabled
+		float m_load_distance			= 150.0f;
+		float m_unload_hysteresis		= 1.25f;				// cells unload a bit further than they load, so they don't flicker at the edge
+		uint64_t m_memory_budget		= 256 * 1024 * 1024;
+		float m_activation_budget_ms	= 2.0f;
+		uint32_t m_max_loads_in_flight	= 2;
+		std::vector<std::shared_ptr<WorldCell>> m_cells;
+		std::mutex m_mutex; // saving happens on another thread
+
+		Context* m_context		= nullptr;
+		World* m_world			= nullptr;
+		Profiler* m_profiler	= nullptr;
+	};
+}
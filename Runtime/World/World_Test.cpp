@@ -0,0 +1,130 @@
+/*
+Copyright(c) 2016-2019 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Save/load round trip checks for the world file.
+// It's not part of the engine build, compile it with the SPARTAN_WORLD_TEST define into an executable which
+// links against the runtime, then run it from a writable directory. It returns non-zero if a check fails.
+#if defined(SPARTAN_WORLD_TEST)
+
+//= INCLUDES ============================
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include "../Core/Engine.h"
+#include "../Core/Context.h"
+#include "../IO/FileStream.h"
+#include "../FileSystem/FileSystem.h"
+#include "World.h"
+#include "Entity.h"
+#include "Prefab.h"
+#include "Components/Transform.h"
+//=======================================
+
+//= NAMESPACES ========
+using namespace std;
+using namespace Spartan;
+//=====================
+
+namespace
+{
+	bool Report(const char* name, const bool passed)
+	{
+		printf("%-40s %s\n", name, passed ? "ok" : "FAILED");
+		return passed;
+	}
+
+	// Loading hands over to the ticking thread, so the load runs on a thread of it's own while this one ticks
+	bool Load(World* world, const string& file_path)
+	{
+		atomic<bool> done	= false;
+		bool result			= false;
+		thread loader([&]()
+		{
+			result	= world->LoadFromFile(file_path);
+			done	= true;
+		});
+
+		while (!done)
+		{
+			world->Tick(0.0f);
+			this_thread::yield();
+		}
+		loader.join();
+
+		return result;
+	}
+
+	bool HasChild(World* world, const string& parent_name, const string& child_name)
+	{
+		const auto& parent = world->EntityGetByName(parent_name);
+		if (!parent)
+			return false;
+
+		for (const Transform* child : parent->GetTransform_PtrRaw()->GetChildren())
+		{
+			if (child->GetEntity_PtrRaw()->GetName() == child_name)
+				return true;
+		}
+
+		return false;
+	}
+
+	// An instance created under a parent which was already saved, has to survive an incremental save
+	bool InstantiateUnderParent(Context* context, World* world, const string& file_path)
+	{
+		// The first tick makes this the ticking thread, the saves below are captured right away
+		auto parent = world->EntityCreate();
+		parent->SetName("world_test_parent");
+		world->Tick(0.0f);
+		if (!world->SaveToFile(file_path))
+			return false;
+		FileStream::WaitForWrites();
+
+		auto source = make_shared<Entity>(context);
+		source->SetName("world_test_child");
+		world->EntityInstantiate(Prefab(source.get()), 1, parent->GetTransform_PtrRaw());
+		if (!world->SaveToFile(file_path, true))
+			return false;
+		FileStream::WaitForWrites();
+		parent = nullptr;
+
+		return Load(world, file_path) && HasChild(world, "world_test_parent", "world_test_child");
+	}
+}
+
+int main()
+{
+	const WindowData window_data;
+	Engine engine(window_data);
+	Context* context	= engine.GetContext();
+	World* world		= context->GetSubsystem<World>().get();
+	const string file_path = "world_test" + string(EXTENSION_WORLD);
+
+	bool passed = true;
+	passed &= Report("Instantiate under a saved parent", InstantiateUnderParent(context, world, file_path));
+
+	FileStream::WaitForWrites();
+	FileSystem::DeleteFile_(file_path);
+
+	return passed ? 0 : 1;
+}
+
+#endif